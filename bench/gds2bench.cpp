@@ -0,0 +1,302 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+/*
+    GDS2 writer microbenchmark.
+
+    Writes a padring with 200k SREFs, spread over the
+    four edges, and reports the number of SREFs per second.
+    It also compares encoding the SREF elements directly
+    with copying pre-encoded templates, without file I/O,
+    and the time and size of the same padring in OASIS.
+    It reads the GDS2 file back with GDS2Reader. Finally,
+    it compares compressing the SREFs inline with GzipWriter
+    against writing the plain file and running gzip on it.
+
+    usage: gds2bench [output file] [repetitions] [OASIS output file]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../src/gds2/gds2writer.h"
+#include "../src/gds2/gds2templates.h"
+#include "../src/gds2/gds2reader.h"
+#include "../src/oasis/oasiswriter.h"
+#include "../src/gzipwriter.h"
+
+static long getFileSize(const std::string &filename)
+{
+    struct stat st;
+    return (stat(filename.c_str(), &st) == 0) ? st.st_size : -1;
+}
+
+int main(int argc, char *argv[])
+{
+    std::string filename = (argc > 1) ? argv[1] : "gds2bench.gds";
+    uint32_t repetitions = (argc > 2) ? atoi(argv[2]) : 5;
+    std::string oasisFilename = (argc > 3) ? argv[3] : "gds2bench.oas";
+
+    const uint32_t instances = 200000;
+    const char *locations[4] = {"N","S","E","W"};
+
+    PRLEFReader::LEFCellInfo_t pad;
+    pad.m_sx = 60.0;
+    pad.m_sy = 240.0;
+
+    // build the placement records: every edge has 50k
+    // instances, a pad followed by seven fillers.
+    std::vector<LayoutItem> items(instances, LayoutItem(LayoutItem::TYPE_CELL));
+    for(uint32_t i=0; i<instances; i++)
+    {
+        uint32_t edge = i / (instances / 4);
+        uint32_t pos  = i % (instances / 4);
+        bool isPad = (pos % 8) == 0;
+
+        LayoutItem &item = items[i];
+        item.m_ltype    = isPad ? LayoutItem::TYPE_CELL : LayoutItem::TYPE_FILLER;
+        item.m_lefinfo  = &pad;
+        item.m_cellname = isPad ? "IOPAD_IN" : "FILLER05";
+        item.m_instance = "U" + std::to_string(i);
+        item.m_location = locations[edge];
+        item.m_flipped  = isPad && ((pos / 8) % 2) == 1;
+        item.m_size     = 6.0;
+        item.m_x = (edge < 2) ? 240.0 + pos * 6.0 : 0.0;
+        item.m_y = (edge < 2) ? 0.0 : 240.0 + pos * 6.0;
+    }
+
+    double best = 0.0;
+    for(uint32_t rep=0; rep<repetitions; rep++)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        GDS2Writer *writer = GDS2Writer::open(filename, "bench");
+        if (writer == nullptr)
+        {
+            printf("Cannot open %s for writing\n", filename.c_str());
+            return 1;
+        }
+
+        writer->setUseAREF(false);
+        for(auto const &item : items)
+        {
+            writer->writeCell(&item);
+        }
+        delete writer;
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double rate = instances / elapsed.count();
+        printf("run %d: %f s, %.0f SREFs/s\n", rep, elapsed.count(), rate);
+        if (rate > best)
+        {
+            best = rate;
+        }
+    }
+
+    printf("best: %.0f SREFs/s\n", best);
+
+    // read the SREFs back: records only, and decoded
+    std::unique_ptr<GDS2Reader> reader(GDS2Reader::open(filename));
+    if (!reader)
+    {
+        printf("Cannot read %s\n", filename.c_str());
+        return 1;
+    }
+
+    double bestRecords = 0.0;
+    double bestDecoded = 0.0;
+    for(uint32_t rep=0; rep<repetitions; rep++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        GDS2Reader::Record r;
+        reader->rewind();
+        while(reader->next(r)) {}
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        bestRecords = std::max(bestRecords, reader->getSize() / elapsed.count() / 1e6);
+
+        start = std::chrono::steady_clock::now();
+        std::vector<GDS2Reader::Structure> structures;
+        if (!reader->readStructures(structures) || (structures.size() != 1) || 
+            (structures[0].m_references.size() != instances))
+        {
+            printf("Cannot decode %s\n", filename.c_str());
+            return 1;
+        }
+        elapsed = std::chrono::steady_clock::now() - start;
+        bestDecoded = std::max(bestDecoded, reader->getSize() / elapsed.count() / 1e6);
+    }
+    reader.reset();
+
+    printf("read records: %.0f MB/s\n", bestRecords);
+    printf("read SREFs  : %.0f MB/s\n", bestDecoded);
+
+    // the same padring with AREFs for the filler runs
+    {
+        GDS2Writer *writer = GDS2Writer::open(filename, "bench");
+        if (writer == nullptr)
+        {
+            printf("Cannot open %s for writing\n", filename.c_str());
+            return 1;
+        }
+
+        for(auto const &item : items)
+        {
+            writer->writeCell(&item);
+        }
+        delete writer;
+    }
+
+    // the same padring in OASIS
+    double bestOASIS = 0.0;
+    for(uint32_t rep=0; rep<repetitions; rep++)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        OASISWriter *writer = OASISWriter::open(oasisFilename, "bench");
+        if (writer == nullptr)
+        {
+            printf("Cannot open %s for writing\n", oasisFilename.c_str());
+            return 1;
+        }
+
+        for(auto const &item : items)
+        {
+            writer->writeCell(&item);
+        }
+        writer->close();
+        delete writer;
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        bestOASIS = std::max(bestOASIS, instances / elapsed.count());
+    }
+
+    printf("OASIS best: %.0f placements/s\n", bestOASIS);
+    printf("size GDS2 with AREFs: %ld bytes\n", getFileSize(filename));
+    printf("size OASIS          : %ld bytes\n", getFileSize(oasisFilename));
+
+    // encode into memory, directly and from templates
+    size_t bytes = 0;
+    for(auto const &item : items)
+    {
+        bytes += GDS2Writer::getCellSize(&item);
+    }
+    std::vector<uint8_t> direct(bytes);
+    std::vector<uint8_t> templated(bytes);
+
+    double bestDirect = 0.0;
+    double bestTemplated = 0.0;
+    for(uint32_t rep=0; rep<repetitions; rep++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        uint8_t *p = &direct[0];
+        for(auto const &item : items)
+        {
+            p = GDS2Writer::encodeCell(p, &item);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        bestDirect = std::max(bestDirect, instances / elapsed.count());
+
+        start = std::chrono::steady_clock::now();
+        GDS2Templates templates;
+        p = &templated[0];
+        for(auto const &item : items)
+        {
+            p = templates.encodeCell(p, &item);
+        }
+        elapsed = std::chrono::steady_clock::now() - start;
+        bestTemplated = std::max(bestTemplated, instances / elapsed.count());
+    }
+
+    printf("encode direct   : %.0f SREFs/s\n", bestDirect);
+    printf("encode templates: %.0f SREFs/s\n", bestTemplated);
+    if (direct != templated)
+    {
+        printf("Error: encoded SREFs differ!\n");
+        return 1;
+    }
+
+    // compress the SREFs inline, in parallel and on one
+    // thread, and as a plain file followed by gzip.
+    std::string gzipFilename = filename + ".gz";
+    double bestInline = 1e9;
+    double bestSerial = 1e9;
+    double bestExternal = 1e9;
+    for(uint32_t rep=0; rep<repetitions; rep++)
+    {
+        for(uint32_t threads : {0u, 1u})
+        {
+            auto start = std::chrono::steady_clock::now();
+            FILE *fout = fopen(gzipFilename.c_str(), "wb");
+            if (fout == nullptr)
+            {
+                printf("Cannot open %s for writing\n", gzipFilename.c_str());
+                return 1;
+            }
+            GzipWriter gzip([fout](const uint8_t *data, size_t len)
+                {
+                    return fwrite(data, 1, len, fout) == len;
+                }, threads);
+            gzip.write(&direct[0], direct.size());
+            bool ok = gzip.finish();
+            fclose(fout);
+            if (!ok)
+            {
+                printf("Cannot compress %s\n", gzipFilename.c_str());
+                return 1;
+            }
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            double &bestTime = (threads == 0) ? bestInline : bestSerial;
+            bestTime = std::min(bestTime, elapsed.count());
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        FILE *fout = fopen(filename.c_str(), "wb");
+        if (fout == nullptr)
+        {
+            printf("Cannot open %s for writing\n", filename.c_str());
+            return 1;
+        }
+        fwrite(&direct[0], 1, direct.size(), fout);
+        fclose(fout);
+        std::string cmd = "gzip -6 -c " + filename + " > " + filename + ".ext.gz";
+        if (system(cmd.c_str()) != 0)
+        {
+            printf("Cannot run gzip\n");
+            return 1;
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        bestExternal = std::min(bestExternal, elapsed.count());
+    }
+
+    double megabytes = direct.size() / 1.0e6;
+    printf("gzip inline parallel: %f s, %.0f MB/s\n", bestInline, megabytes / bestInline);
+    printf("gzip inline 1 thread: %f s, %.0f MB/s\n", bestSerial, megabytes / bestSerial);
+    printf("write + gzip        : %f s, %.0f MB/s\n", bestExternal, megabytes / bestExternal);
+    printf("size plain          : %zu bytes\n", direct.size());
+    printf("size inline gzip    : %ld bytes\n", getFileSize(gzipFilename));
+    printf("size gzip           : %ld bytes\n", getFileSize(filename + ".ext.gz"));
+    remove((filename + ".ext.gz").c_str());
+    return 0;
+}
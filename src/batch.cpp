@@ -0,0 +1,156 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <set>
+#include "threadpool.h"
+#include "batch.h"
+
+bool Batch::readManifest(std::istream &is)
+{
+    std::set<std::string> outputs;
+    std::string line;
+    uint32_t lineNum = 0;
+    while(std::getline(is, line))
+    {
+        lineNum++;
+
+        // strip comments
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+        {
+            line.erase(hash);
+        }
+
+        std::istringstream ss(line);
+        Job job;
+        if (!(ss >> job.m_name))
+        {
+            continue;   // empty line
+        }
+
+        if (!(ss >> job.m_configFilename))
+        {
+            doLog(LOG_ERROR, "Manifest line %d : expected a name and a configuration file\n", lineNum);
+            return false;
+        }
+
+        job.m_status    = "pending";
+        job.m_totalTime = 0.0;
+
+        if (!job.m_job.parseOptions(ss, "Manifest line " + std::to_string(lineNum)))
+        {
+            return false;
+        }
+
+        // two jobs writing the same file at the
+        // same time would corrupt it.
+        for(auto const &filename : job.m_job.getOutputFilenames())
+        {
+            if (!outputs.insert(filename).second)
+            {
+                doLog(LOG_ERROR, "Manifest line %d : output file %s is written by more than one job\n", lineNum, filename.c_str());
+                return false;
+            }
+        }
+
+        m_jobs.push_back(job);
+    }
+
+    return true;
+}
+
+void Batch::execute(Job &job)
+{
+    auto start = std::chrono::steady_clock::now();
+    setThreadLogBuffer(&job.m_log);
+    std::ifstream configStream(job.m_configFilename, std::ifstream::in);
+    if (configStream.is_open())
+    {
+        job.m_status = job.m_job.process(m_lefreader, configStream, m_databaseUnits);
+    }
+    else
+    {
+        doLog(LOG_ERROR, "Cannot open configuration file %s\n", job.m_configFilename.c_str());
+        job.m_status = "config_error";
+    }
+    setThreadLogBuffer(nullptr);
+    job.m_totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // write the messages of the job as one block,
+    // tagged with the name of the job.
+    std::lock_guard<std::mutex> lock(m_logMutex);
+    for(auto const &msg : job.m_log)
+    {
+        doLog(msg.first, "%s: %s", job.m_name.c_str(), msg.second.c_str());
+    }
+}
+
+void Batch::run(uint32_t threads)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        ThreadPool pool(threads);
+        m_threadCount = pool.getThreadCount();
+        for(auto &job : m_jobs)
+        {
+            pool.submit([this, &job]() { execute(job); });
+        }
+        pool.wait();
+    }
+
+    m_elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t Batch::getFailedCount() const
+{
+    size_t failed = 0;
+    for(auto const &job : m_jobs)
+    {
+        if (job.m_status != "ok")
+        {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+void Batch::report() const
+{
+    double jobTime = 0.0;
+    doLog(LOG_INFO, "%-20s %-12s %10s %10s %10s %10s\n", "job", "status", "parse", "layout", "write", "total");
+    for(auto const &job : m_jobs)
+    {
+        jobTime += job.m_totalTime;
+        doLog(LOG_INFO, "%-20s %-12s %10.3f %10.3f %10.3f %10.3f\n", job.m_name.c_str(), job.m_status.c_str(), 
+            job.m_job.m_parseTime, job.m_job.m_layoutTime, job.m_job.m_writeTime, job.m_totalTime);
+    }
+
+    doLog(LOG_INFO, "Ran %d jobs in %f seconds using %d threads (%f seconds of job time)\n", 
+        m_jobs.size(), m_elapsed, m_threadCount, jobTime);
+
+    size_t failed = getFailedCount();
+    if (failed > 0)
+    {
+        doLog(LOG_ERROR, "%d of %d jobs failed\n", failed, m_jobs.size());
+    }
+}
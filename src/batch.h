@@ -0,0 +1,108 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef batch_h
+#define batch_h
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <mutex>
+
+#include "prlefreader.h"
+#include "padringjob.h"
+#include "logging.h"
+
+/** Lays out many padrings that share one cell library.
+    The LEF files are read once; every job parses its own
+    configuration into its own padring database and writes
+    its own output files. The jobs run in parallel on a
+    thread pool and the LEF database is only read.
+
+    Manifest format, one job per line:
+
+    # name  config          options
+    chip_a  chip_a.config   -o chip_a.gds --def chip_a.def
+    chip_b  chip_b.config   --fit --svg chip_b.svg.gz
+
+    The options are the output and layout options of
+    the command line: -o/--output, --svg, --def, --oasis,
+    --html, --png, --png-size, --report, --fit, --filler,
+    --no-aref, --gds-hierarchy and --verify.
+
+    The messages of each job are collected and written
+    as a block when the job finishes, followed by a
+    summary of the status and run time of every job.
+*/
+class Batch
+{
+public:
+    Batch(const PRLEFReader &lefreader)
+        : m_lefreader(lefreader), m_databaseUnits(0.0),
+          m_elapsed(0.0), m_threadCount(0) {}
+
+    /** read the jobs. returns false on a syntax error. */
+    bool readManifest(std::istream &is);
+
+    /** run all the jobs using the given number of
+        threads. 0 means one thread per hardware thread. */
+    void run(uint32_t threads);
+
+    /** write the status and run time of each job to the log */
+    void report() const;
+
+    void setDatabaseUnits(double databaseUnits)
+    {
+        m_databaseUnits = databaseUnits;
+    }
+
+    /** return the number of jobs that failed */
+    size_t getFailedCount() const;
+
+    /** return the number of jobs */
+    size_t getJobCount() const
+    {
+        return m_jobs.size();
+    }
+
+protected:
+    struct Job
+    {
+        std::string m_name;
+        std::string m_configFilename;
+        PadringJob  m_job;
+
+        std::string m_status;           ///< see PadringJob::process.
+        logbuffer_t m_log;              ///< messages produced by the job.
+        double      m_totalTime;        ///< seconds from start to finish.
+    };
+
+    /** run a single job on the calling thread */
+    void execute(Job &job);
+
+    const PRLEFReader   &m_lefreader;
+    double              m_databaseUnits;
+    double              m_elapsed;      ///< wall clock time of the whole batch.
+    size_t              m_threadCount;
+    std::mutex          m_logMutex;     ///< keeps the messages of a job together.
+
+    std::vector<Job>    m_jobs;
+};
+
+#endif
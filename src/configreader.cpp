@@ -249,6 +249,10 @@ bool ConfigReader::parse(std::istream &configstream)
                 {
                     if (!parseDesignName()) return false;
                 }                
+                else if (tokstr == "GROUP")
+                {
+                    if (!parseGroup()) return false;
+                }
                 else
                 {
                     std::stringstream ss;
@@ -605,3 +609,42 @@ bool ConfigReader::parseDesignName()
     onDesignName(designName);
     return true;
 }
+
+bool ConfigReader::parseGroup()
+{
+    // GROUP: groupname instance instance ...
+    std::string tokstr;
+    std::string groupName;
+    std::vector<std::string> instances;
+
+    // group name
+    ConfigReader::token_t tok = tokenize(groupName);
+    if (tok != TOK_IDENT)
+    {
+        error("Expected a group name\n");
+        return false;
+    }
+
+    // instance names up to the semicol
+    tok = tokenize(tokstr);
+    while(tok == TOK_IDENT)
+    {
+        instances.push_back(tokstr);
+        tok = tokenize(tokstr);
+    }
+
+    if (tok != TOK_SEMICOL)
+    {
+        error("Expected an instance name or ;\n");
+        return false;
+    }
+
+    if (instances.size() < 2)
+    {
+        error("Expected at least two instances in a group\n");
+        return false;
+    }
+
+    onGroup(groupName, instances);
+    return true;
+}
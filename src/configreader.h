@@ -48,6 +48,7 @@
     PAD IO6 N BBC16F
     PAD IO7 N BBC16F 
     PAD IO8 N BBC16F
+    GROUP BUS IO5 IO6 IO7 IO8
 
 */
 
@@ -129,6 +130,13 @@ public:
         std::cout << "Offset " << offset << "\n";
     }
 
+    /** callback for a group of pads that should be placed
+        next to each other by the pad order optimizer */
+    virtual void onGroup(const std::string &groupName, const std::vector<std::string> &instances)
+    {
+        std::cout << "Group " << groupName << " with " << instances.size() << " pads\n";
+    }
+
     /** callback for design name */
     virtual void onDesignName(const std::string &designName)
     {
@@ -158,6 +166,7 @@ protected:
     bool parseOffset();
     bool parseFiller();
     bool parseDesignName();
+    bool parseGroup();
 
     token_t      tokenize(std::string &tokstr);
     char         m_tokchar;
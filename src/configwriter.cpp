@@ -0,0 +1,100 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <iomanip>
+#include <limits>
+#include "configwriter.h"
+
+void ConfigWriter::writeCorner(std::ostream &os, const LayoutItem *corner)
+{
+    if (corner == nullptr)
+    {
+        return;
+    }
+
+    os << "CORNER " << corner->m_instance << " " << corner->m_location << " " << corner->m_cellname << " ;\n";
+}
+
+void ConfigWriter::writeEdge(std::ostream &os, Layout &edge)
+{
+    if (edge.begin() == edge.end())
+    {
+        return;
+    }
+
+    os << "\n";
+    for(auto item : edge)
+    {
+        if (item->m_ltype == LayoutItem::TYPE_CELL)
+        {
+            os << "PAD " << item->m_instance << " " << item->m_location << " ";
+            if (item->m_flipped)
+            {
+                os << "FLIP ";
+            }
+            os << item->m_cellname << " ;\n";
+        }
+        else if (item->m_ltype == LayoutItem::TYPE_FIXEDSPACE)
+        {
+            os << "SPACE " << item->m_size << " ;\n";
+        }
+    }
+}
+
+void ConfigWriter::write(std::ostream &os, PadringDB &padring)
+{
+    os << std::setprecision(std::numeric_limits<double>::digits10);
+
+    os << "DESIGN " << padring.m_designName << " ;\n";
+    if ((padring.m_dieWidth > 0.0) && (padring.m_dieHeight > 0.0))
+    {
+        os << "AREA " << padring.m_dieWidth << " " << padring.m_dieHeight << " ;\n";
+    }
+    os << "GRID " << padring.m_grid << " ;\n";
+    if (!padring.m_fillerPrefix.empty())
+    {
+        os << "FILLER " << padring.m_fillerPrefix << " ;\n";
+    }
+
+    os << "\n";
+    writeCorner(os, padring.m_north.getFirstCorner());
+    writeCorner(os, padring.m_north.getLastCorner());
+    writeCorner(os, padring.m_south.getFirstCorner());
+    writeCorner(os, padring.m_south.getLastCorner());
+
+    writeEdge(os, padring.m_north);
+    writeEdge(os, padring.m_south);
+    writeEdge(os, padring.m_east);
+    writeEdge(os, padring.m_west);
+
+    if (!padring.m_groups.empty())
+    {
+        os << "\n";
+    }
+
+    for(auto const &group : padring.m_groups)
+    {
+        os << "GROUP " << group.first;
+        for(auto const &instance : group.second)
+        {
+            os << " " << instance;
+        }
+        os << " ;\n";
+    }
+}
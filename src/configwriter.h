@@ -0,0 +1,42 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef configwriter_h
+#define configwriter_h
+
+#include <iostream>
+#include "padringdb.h"
+
+/** writes a padring database back into the 
+    configuration file format read by ConfigReader.
+    comments and the original formatting are not
+    preserved.
+*/
+class ConfigWriter
+{
+public:
+    /** write the configuration to a stream */
+    static void write(std::ostream &os, PadringDB &padring);
+
+protected:
+    static void writeCorner(std::ostream &os, const LayoutItem *corner);
+    static void writeEdge(std::ostream &os, Layout &edge);
+};
+
+#endif
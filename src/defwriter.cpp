@@ -17,53 +17,50 @@
     
 */
 
-#include <sstream>
-#include <fstream>
-#include <iomanip>
-#include <complex>
-#include <math.h>
+#include <charconv>
+#include <cmath>
 #include <assert.h>
 #include "logging.h"
 #include "defwriter.h"
 
 DEFWriter::DEFWriter(std::ostream &os, uint32_t width, uint32_t height)
     : m_def(os),
+      m_out(&os),
+      m_headerWritten(false),
       m_width(width),
       m_height(height),
       m_cellCount(0),
+      m_componentCount(0),
       m_databaseUnits(0.0)
 {
-    // make sure the stringstream doesn't use
-    // exponential notation with doubles!
-    m_ss << std::setprecision(std::numeric_limits<double>::digits10);
 }
 
-DEFWriter::~DEFWriter()
+bool DEFWriter::close()
 {
-    m_def.flush();    
-    writeToFile();
-}
-
-void DEFWriter::writeToFile()
-{
-    assert(!m_designName.empty());
-
-    m_def << "DESIGN " << m_designName << " ;\n";
-    m_def << "UNITS DISTANCE MICRONS " << m_databaseUnits << " ; \n";
-    m_def << "COMPONENTS " << m_cellCount << " ;\n";
+    if (!m_headerWritten)
+    {
+        writeHeader();
+    }
 
-    m_def << m_ss.str();
+    bool ok = true;
+    if (m_cellCount != m_componentCount)
+    {
+        doLog(LOG_ERROR, "DEF file has %d components but %d were declared\n", m_cellCount, m_componentCount);
+        ok = false;
+    }
 
-    m_def << "END COMPONENTS\n";
-    m_def << "END DESIGN\n";
+    m_out.put("END COMPONENTS\nEND DESIGN\n");
+    m_out.flush();
+    m_def.flush();
+    return ok && m_def.good();
 }
 
-
-void DEFWriter::toDEFCoordinates(double &x, double &y)
+void DEFWriter::writeHeader()
 {
-    //return std::complex<double>(p.real(), m_height - p.imag());
-    //FIXME: use database units defined in LEF file!
+    assert(!m_designName.empty());
+    m_headerWritten = true;
 
+    //FIXME: use database units defined in LEF file!
     if (m_databaseUnits < 1e-12)
     {
         doLog(LOG_WARN, "DEF database units not set! does your imported LEF file specify it?\n");
@@ -71,8 +68,21 @@ void DEFWriter::toDEFCoordinates(double &x, double &y)
         m_databaseUnits = 100.0;
     }
 
-    x *= m_databaseUnits;
-    y *= m_databaseUnits;
+    char units[32];
+    auto result = std::to_chars(units, units + sizeof(units), m_databaseUnits);
+
+    m_out.put("DESIGN ");
+    m_out.put(m_designName);
+    m_out.put(" ;\nUNITS DISTANCE MICRONS ");
+    m_out.put(units, result.ptr - units);
+    m_out.put(" ; \nCOMPONENTS ");
+    m_out.putInt(m_componentCount);
+    m_out.put(" ;\n");
+}
+
+int64_t DEFWriter::toDEFCoordinate(double v) const
+{
+    return std::llround(v * m_databaseUnits);
 }
 
 void DEFWriter::writeCell(const LayoutItem *item)
@@ -82,103 +92,74 @@ void DEFWriter::writeCell(const LayoutItem *item)
         return;
     }
 
-    double rot = 0.0;
+    if (!m_headerWritten)
+    {
+        writeHeader();
+    }
+
     double x = item->m_x;
     double y = item->m_y;
+    const char *orientation;
 
     m_cellCount++;
     
+    m_out.put("  - ");
     if (item->m_ltype == LayoutItem::TYPE_FILLER)
     {
-        m_ss << "  - FILLER_" << m_cellCount << " " << item->m_cellname << "\n";
+        m_out.put("FILLER_");
+        m_out.putInt(m_cellCount);
     }
     else
     {
-        m_ss << "  - " << item->m_instance << " " << item->m_cellname << "\n";
+        m_out.put(item->m_instance);
     }
+    m_out.put(" ");
+    m_out.put(item->m_cellname);
+    m_out.put("\n");
+
     // do corners
     if (item->m_location == "NW")
     {
         y -= item->m_lefinfo->m_sx;
-        toDEFCoordinates(x,y);
-        m_ss << "    + PLACED ( " << x << " " << y << " ) ";
-        m_ss << "E ;\n";
+        orientation = "E ;\n";
     }
     else if (item->m_location == "SE")
     {
         // South East orientation, rotation = 90 degrees
-        //x += item->m_lefinfo->m_sy;
-        toDEFCoordinates(x,y);
-        m_ss << "    + PLACED ( " << x << " " << y << " ) ";
-        m_ss << "W ;\n";
+        orientation = "W ;\n";
     }
     else if (item->m_location == "NE")
     {
         y -= item->m_lefinfo->m_sy;
-        toDEFCoordinates(x,y);
-        m_ss << "    + PLACED ( " << x << " " << y << " ) ";
-        m_ss << "S ;\n";
+        orientation = "S ;\n";
     }
     else if (item->m_location == "SW")
     {
-        toDEFCoordinates(x,y);
-        m_ss << "    + PLACED ( " << x << " " << y << " ) ";
-        m_ss << "N ;\n";
+        orientation = "N ;\n";
     }
     else if (item->m_location == "E")
     {
         x -= item->m_lefinfo->m_sy;
-        toDEFCoordinates(x,y);
-        m_ss << "    + PLACED ( " << x << " " << y << " ) ";
-
-        if (!item->m_flipped) 
-        {
-            m_ss << " W" << " ;\n";
-        }
-        else
-        {
-            m_ss << " FE" << " ;\n";
-        }
+        orientation = item->m_flipped ? " FE ;\n" : " W ;\n";
     }
     else if (item->m_location == "N")
     {
         y -= item->m_lefinfo->m_sy;
-        toDEFCoordinates(x,y);
-        m_ss << "    + PLACED ( " << x << " " << y << " ) ";
-        if (!item->m_flipped) 
-        {
-            m_ss << " S" << " ;\n";
-        }
-        else
-        {
-            m_ss << " FS" << " ;\n";
-        }
+        orientation = item->m_flipped ? " FS ;\n" : " S ;\n";
     }   
     else if (item->m_location == "S")
     {
-        //y -= item->m_lefinfo->m_sy;
-        toDEFCoordinates(x,y);
-        m_ss << "    + PLACED ( " << x << " " << y << " ) ";
-        if (!item->m_flipped)
-        {
-            m_ss << " N" << " ;\n";
-        }
-        else
-        {
-            m_ss << " FN" << " ;\n";
-        }
+        orientation = item->m_flipped ? " FN ;\n" : " N ;\n";
     }        
     else
     {
-        toDEFCoordinates(x,y);
-        m_ss << "    + PLACED ( " << x << " " << y << " ) ";
-        if (!item->m_flipped) 
-        {
-            m_ss << " E" << " ;\n";
-        }
-        else
-        {
-            m_ss << " W" << " ;\n";
-        }
+        orientation = item->m_flipped ? " W ;\n" : " E ;\n";
     }
+
+    m_out.put("    + PLACED ( ");
+    m_out.putInt(toDEFCoordinate(x));
+    m_out.put(" ");
+    m_out.putInt(toDEFCoordinate(y));
+    m_out.put(" ) ");
+    m_out.put(orientation);
 }
@@ -22,20 +22,34 @@
 
 #include <stdio.h>
 #include <stdint.h>
-#include <complex>
 #include <string>
-#include <sstream>
+#include <vector>
+#include <ostream>
 
 #include "layout.h"
+#include "outputsink.h"
+#include "textwriter.h"
 
-/** a very minimal SVG writer */
-class DEFWriter
+/** a very minimal DEF writer.
+
+    The number of components must be set before the
+    first cell is written, so the DEF file can be
+    streamed out directly, e.g. into a pipe. The
+    records are assembled in a block buffer by a
+    TextWriter and the coordinates are written as
+    integer database units.
+*/
+class DEFWriter : public OutputSink
 {
 public:
     DEFWriter(std::ostream &os, uint32_t width, uint32_t height);
-    virtual ~DEFWriter();
 
-    void writeCell(const LayoutItem *item);
+    void writeCell(const LayoutItem *item) override;
+
+    /** writes the footer. returns false on an I/O error
+        or when the number of components written differs
+        from the declared number. */
+    bool close() override;
 
     void setDatabaseUnits(double databaseUnits)
     {
@@ -47,25 +61,34 @@ public:
         m_designName = designName;
     }
 
+    /** set the number of components that will be written */
+    void setComponentCount(uint32_t count)
+    {
+        m_componentCount = count;
+    }
+
 protected:
 
-    /** convert to DEF database units / coordinates.
+    /** convert to DEF database units / coordinates. */
+    int64_t toDEFCoordinate(double v) const;
+
+    /** write the DESIGN, UNITS and COMPONENTS lines.
         this function will issue a warning when
         m_databaseUnits has not been set and set it
-        to 1000.
+        to 100.
     */
-    void toDEFCoordinates(double &x, double &y);
-
-    void writeToFile();
+    void writeHeader();
 
-    std::stringstream   m_ss;
     std::string         m_designName;
     std::ostream        &m_def;
+    TextWriter          m_out;
+    bool                m_headerWritten;
     
     uint32_t m_width;
     uint32_t m_height;
     uint32_t m_cellCount;
+    uint32_t m_componentCount;
     double   m_databaseUnits;
 };
 
-#endif
\ No newline at end of file
+#endif
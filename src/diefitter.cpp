@@ -0,0 +1,199 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include "logging.h"
+#include "diefitter.h"
+
+bool DieFitter::canFillEdge(Layout &edge)
+{
+    for(auto item : edge)
+    {
+        if ((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
+        {
+            if (!m_fillers.canFill(item->m_size))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool DieFitter::isFeasible(Layout &edge1, Layout &edge2, double dieSize)
+{
+    edge1.setDieSize(dieSize);
+    edge2.setDieSize(dieSize);
+
+    if (!edge1.doLayout() || !edge2.doLayout())
+    {
+        return false;
+    }
+
+    return canFillEdge(edge1) && canFillEdge(edge2);
+}
+
+bool DieFitter::isFeasible(Layout &edge, double dieSize)
+{
+    edge.setDieSize(dieSize);
+    return edge.doLayout() && canFillEdge(edge);
+}
+
+int64_t DieFitter::getPeriod(Layout &edge, double grid)
+{
+    uint32_t flexSpaces = 0;
+    for(auto item : edge)
+    {
+        if (item->m_ltype == LayoutItem::TYPE_FLEXSPACE)
+        {
+            flexSpaces++;
+        }
+    }
+
+    // without FLEXSPACE items, the spaces do 
+    // not depend on the die size.
+    if (flexSpaces == 0)
+    {
+        return 1;
+    }
+
+    // a space that is at least as large as the largest 
+    // filler starts with that filler, so growing a space 
+    // by its width does not change whether it can be filled.
+    // growing the die by that width for every FLEXSPACE grows
+    // each FLEXSPACE by that width, as long as it is a whole
+    // number of microns, the grid of the FLEXSPACE positions.
+    double largest = m_fillers.getLargestWidth();
+    for(int64_t multiple = 1; multiple <= 1000; multiple++)
+    {
+        double growth = multiple * largest;
+        double steps  = flexSpaces * growth / grid;
+        if (steps > c_maxPeriod)
+        {
+            break;
+        }
+        if ((std::fabs(growth - std::round(growth)) < 1e-6) && 
+            (std::fabs(steps - std::round(steps)) < 1e-6))
+        {
+            return std::llround(steps);
+        }
+    }
+    return 0;
+}
+
+double DieFitter::search(Layout &edge1, Layout &edge2)
+{
+    double grid = (m_padring.m_grid > 0.0) ? m_padring.m_grid : 1.0;
+
+    // the die must at least hold all the cells, corners
+    // and fixed spaces of both edges.
+    double minSize = std::max(edge1.getMinSize(), edge2.getMinSize());
+    int64_t lo = static_cast<int64_t>(std::ceil(minSize / grid - 1e-9));
+    if (lo < 1)
+    {
+        lo = 1;
+    }
+
+    // feasibility is not monotone in the die size: the
+    // spaces must add up to filler widths and the extra
+    // space is shared by all the flexible spaces, so a
+    // larger die can fail where a smaller one fits. 
+    // the first grid steps are checked one by one.
+    for(int64_t size = lo; size <= (lo + c_scanSteps); size++)
+    {
+        if (isFeasible(edge1, edge2, size*grid))
+        {
+            return size*grid;
+        }
+    }
+
+    // the feasibility of each edge repeats after a number of
+    // grid steps, so one period of each edge holds all the
+    // sizes that need to be checked.
+    int64_t period1 = getPeriod(edge1, grid);
+    int64_t period2 = getPeriod(edge2, grid);
+    if ((period1 == 0) || (period2 == 0))
+    {
+        doLog(LOG_ERROR, "The die size search needs more than %lld grid steps\n", 
+            static_cast<long long>(c_maxPeriod));
+        return -1.0;
+    }
+
+    std::vector<int64_t> feasible1;
+    for(int64_t step = 0; step < period1; step++)
+    {
+        if (isFeasible(edge1, (lo + step)*grid))
+        {
+            feasible1.push_back(step);
+        }
+    }
+
+    std::vector<bool> feasible2(period2);
+    for(int64_t step = 0; step < period2; step++)
+    {
+        feasible2[step] = isFeasible(edge2, (lo + step)*grid);
+    }
+
+    // the smallest size that is feasible for both edges, 
+    // before both periods start over at the same time.
+    int64_t cycles = period2 / std::gcd(period1, period2);
+    for(int64_t cycle = 0; cycle < cycles; cycle++)
+    {
+        for(auto step : feasible1)
+        {
+            int64_t extra = cycle*period1 + step;
+            if (feasible2[extra % period2])
+            {
+                return (lo + extra)*grid;
+            }
+        }
+    }
+    return -1.0;
+}
+
+bool DieFitter::fit()
+{
+    m_width = search(m_padring.m_north, m_padring.m_south);
+    if (m_width < 0.0)
+    {
+        doLog(LOG_ERROR, "Cannot find a die width that can be filled with the available filler cells\n");
+        return false;
+    }
+
+    m_height = search(m_padring.m_east, m_padring.m_west);
+    if (m_height < 0.0)
+    {
+        doLog(LOG_ERROR, "Cannot find a die height that can be filled with the available filler cells\n");
+        return false;
+    }
+
+    m_padring.onArea(m_width, m_height);
+    return true;
+}
+
+void DieFitter::report()
+{
+    doLog(LOG_INFO,"Minimum die area: %f x %f microns\n", m_width, m_height);
+    doLog(LOG_INFO,"North slack     : %f microns\n", m_width - m_padring.m_north.getMinSize());
+    doLog(LOG_INFO,"South slack     : %f microns\n", m_width - m_padring.m_south.getMinSize());
+    doLog(LOG_INFO,"East slack      : %f microns\n", m_height - m_padring.m_east.getMinSize());
+    doLog(LOG_INFO,"West slack      : %f microns\n", m_height - m_padring.m_west.getMinSize());
+}
@@ -0,0 +1,96 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef diefitter_h
+#define diefitter_h
+
+#include "layout.h"
+#include "padringdb.h"
+#include "fillerhandler.h"
+
+/** Searches for the smallest die width and height
+    on which the padring can be laid out and all the
+    spaces can be filled with filler cells.
+
+    The search works on the already parsed padring
+    database, so no LEF or configuration file is
+    read again.
+*/
+class DieFitter
+{
+public:
+    DieFitter(PadringDB &padring, FillerHandler &fillers)
+        : m_padring(padring), m_fillers(fillers) {}
+
+    /** search for the smallest die size.
+        returns false if no size could be found.
+        on success, the die area of the padring
+        database is set to the size found.
+    */
+    bool fit();
+
+    /** report the die size and the slack of each edge */
+    void report();
+
+    double getWidth() const { return m_width; }
+    double getHeight() const { return m_height; }
+
+protected:
+    /** check if the two (opposing) edges can be laid out
+        and filled using the given die size.
+    */
+    bool isFeasible(Layout &edge1, Layout &edge2, double dieSize);
+
+    /** check if an edge can be laid out and 
+        filled using the given die size.
+    */
+    bool isFeasible(Layout &edge, double dieSize);
+
+    /** get the number of grid steps after which the
+        feasibility of an edge repeats, or 0 if there 
+        is no such period of at most c_maxPeriod steps.
+    */
+    int64_t getPeriod(Layout &edge, double grid);
+
+    /** check if all the spaces in a laid out edge
+        can be filled with filler cells. */
+    bool canFillEdge(Layout &edge);
+
+    /** search the smallest feasible die size for two
+        opposing edges on a grid. returns a negative number
+        if no feasible size was found.
+    */
+    double search(Layout &edge1, Layout &edge2);
+
+    /** number of grid steps above the lower bound that
+        are checked for both edges at once before the
+        period of each edge is searched */
+    static const int64_t c_scanSteps = 256;
+
+    /** the longest period, in grid steps, that is searched */
+    static const int64_t c_maxPeriod = 1<<24;
+
+    PadringDB       &m_padring;
+    FillerHandler   &m_fillers;
+
+    double m_width;
+    double m_height;
+};
+
+#endif
@@ -20,8 +20,10 @@
 #ifndef fillerhandler_h
 #define fillerhandler_h
 
+#include <stdint.h>
 #include <string>
 #include <list>
+#include <vector>
 
 class FillerHandler
 {
@@ -59,12 +61,110 @@ public:
         return -1.0;    // not found
     }
 
+    /** fill a space with filler cells, largest first. 
+     *  cellFunc(cellName, width) is called for every filler
+     *  cell, in order. this is the fill that is used for all
+     *  the outputs and reports.
+     * 
+     *  returns false if the space cannot be filled completely,
+     *  space is then set to the width that is left.
+     **/
+    template<typename CellFunc>
+    bool fill(double &space, CellFunc cellFunc)
+    {
+        std::string cellName;
+        while(space > 0)
+        {
+            double width = getFillerCell(space, cellName);
+            if (width <= 0.0)
+            {
+                return false;
+            }
+            cellFunc(cellName, width);
+            space -= width;
+        }
+        return true;
+    }
+
+    /** return the number of filler cells needed to fill
+     *  the given space, using the same largest-first strategy 
+     *  that is used to emit the filler cells.
+     * 
+     *  if the space cannot be filled, -1 is returned.
+     **/
+    int32_t getFillerCount(double space)
+    {
+        int32_t count = 0;
+        if (!fill(space, [&count](const std::string &, double) { count++; }))
+        {
+            return -1;
+        }
+        return count;
+    }
+
+    /** filler cell names and counts, in fill order */
+    typedef std::vector<std::pair<std::string, uint32_t> > fillerList_t;
+
+    /** fill a space and append the filler cells to a list.
+     *  a cell that is the same as the last one in the list 
+     *  is added to its count.
+     * 
+     *  returns the number of filler cells, or -1 if the space
+     *  cannot be filled completely.
+     **/
+    int32_t fillList(double space, fillerList_t &list)
+    {
+        int32_t count = 0;
+        bool filled = fill(space, [&list, &count](const std::string &cellName, double)
+            {
+                if (list.empty() || (list.back().first != cellName))
+                {
+                    list.emplace_back(cellName, 0);
+                }
+                list.back().second++;
+                count++;
+            });
+        return filled ? count : -1;
+    }
+
+    /** return a filler list as text, e.g. "FILLER10*3 FILLER01*1" */
+    static std::string toString(const fillerList_t &list)
+    {
+        std::string result;
+        for(auto const &filler : list)
+        {
+            if (!result.empty())
+            {
+                result += " ";
+            }
+            result += filler.first + "*" + std::to_string(filler.second);
+        }
+        return result;
+    }
+
+    /** check if the given space can be filled completely */
+    bool canFill(double space)
+    {
+        return getFillerCount(space) >= 0;
+    }
+
     /** return the number of filler cells available */
     size_t getCellCount() const
     {
         return m_fillerCells.size();
     }
 
+    /** return the names of the filler cells */
+    std::vector<std::string> getCellNames() const
+    {
+        std::vector<std::string> names;
+        for(auto const &cell : m_fillerCells)
+        {
+            names.push_back(cell.second);
+        }
+        return names;
+    }
+
     /** Get the smallest filler cell as a hint for the 
         actual grid spacing of IO cells.
 
@@ -84,6 +184,24 @@ public:
         return -1.0;
     }
 
+    /** Get the largest filler cell width.
+
+        returns -1.0 on error.
+    */
+    double getLargestWidth()
+    {
+        if (!m_sorted)
+        {
+            m_sorted = true;
+            m_fillerCells.sort(cellCompare);
+        }
+
+        if (!m_fillerCells.empty())
+            return m_fillerCells.front().first;
+
+        return -1.0;
+    }
+
 protected:
 
     /** pair: filler cell width & filler cell name. */
@@ -0,0 +1,403 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <map>
+#include <algorithm>
+
+#include "../logging.h"
+#include "../gzipwriter.h"
+#include "gds2writer.h"
+#include "gds2hierwriter.h"
+
+GDS2HierWriter* GDS2HierWriter::open(const std::string &filename, 
+    const std::string &designName, double dieWidth, double dieHeight)
+{
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (f == nullptr)
+    {
+        return nullptr;
+    }
+
+    return new GDS2HierWriter(f, designName, dieWidth, dieHeight,
+        GzipWriter::isGzipFilename(filename));
+}
+
+GDS2HierWriter::GDS2HierWriter(FILE *f, const std::string &designName, double dieWidth, double dieHeight, bool compress) 
+    : m_fout(f), 
+      m_designName(designName),
+      m_dieWidth(dieWidth),
+      m_dieHeight(dieHeight),
+      m_compress(compress),
+      m_library(nullptr)
+{
+    doLog(LOG_VERBOSE,"GDS2HierWriter created\n");
+}
+
+GDS2HierWriter::~GDS2HierWriter()
+{
+    if (m_fout != nullptr)
+    {
+        fclose(m_fout);
+    }
+    doLog(LOG_VERBOSE,"GDS2HierWriter destroyed\n");
+}
+
+bool GDS2HierWriter::close()
+{
+    if (m_fout == nullptr)
+    {
+        return true;
+    }
+
+    bool ok = writeFile();
+    if (fclose(m_fout) != 0)
+    {
+        ok = false;
+    }
+    m_fout = nullptr;
+    return ok;
+}
+
+void GDS2HierWriter::writeCell(const LayoutItem *item)
+{
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    if (!m_cells)
+    {
+        m_cells = std::make_shared<PlacementBlock>();
+        m_blocks.push_back(m_cells);
+    }
+    m_cells->push_back(*item);
+}
+
+void GDS2HierWriter::writeBlock(const std::shared_ptr<const PlacementBlock> &block)
+{
+    m_cells.reset();
+    m_blocks.push_back(block);
+}
+
+GDS2HierWriter::Element GDS2HierWriter::toElement(const LayoutItem *item)
+{
+    double px, py;
+    Element e;
+    GDS2Writer::getTransform(item, px, py, e.m_rot, e.m_flip);
+
+    // same rounding as GDS2Writer
+    e.m_cellName = item->m_cellname;
+    e.m_x = static_cast<int32_t>(static_cast<uint32_t>(px*1000.0));
+    e.m_y = static_cast<int32_t>(static_cast<uint32_t>(py*1000.0));
+    e.m_isFiller = (item->m_ltype == LayoutItem::TYPE_FILLER);
+    return e;
+}
+
+GDS2HierWriter::Element GDS2HierWriter::toLocal(const Element &e, const EdgeFrame &frame)
+{
+    // GDS2 reflects, rotates and then translates, so
+    // the inverse frame transform only affects the 
+    // rotation and position of the element.
+    Element local = e;
+    int64_t dx = e.m_x - frame.m_x;
+    int64_t dy = e.m_y - frame.m_y;
+    switch(frame.m_rot)
+    {
+    case 90:
+        local.m_x = dy;
+        local.m_y = -dx;
+        break;
+    case 180:
+        local.m_x = -dx;
+        local.m_y = -dy;
+        break;
+    case 270:
+        local.m_x = -dy;
+        local.m_y = dx;
+        break;
+    default:
+        local.m_x = dx;
+        local.m_y = dy;
+    }
+    local.m_rot = (e.m_rot + 360 - frame.m_rot) % 360;
+    return local;
+}
+
+std::string GDS2HierWriter::getKey(const std::vector<Element>::const_iterator &begin, 
+    const std::vector<Element>::const_iterator &end, bool relative)
+{
+    int64_t x0 = relative ? begin->m_x : 0;
+    int64_t y0 = relative ? begin->m_y : 0;
+
+    std::string key;
+    for(auto iter = begin; iter != end; ++iter)
+    {
+        key += iter->m_cellName;
+        key += ' ';
+        key += std::to_string(iter->m_rot);
+        key += iter->m_flip ? " F " : " N ";
+        key += std::to_string(iter->m_x - x0);
+        key += ' ';
+        key += std::to_string(iter->m_y - y0);
+        key += ';';
+    }
+    return key;
+}
+
+size_t GDS2HierWriter::getGapLength(const std::vector<Element> &elements, size_t idx)
+{
+    size_t len = 0;
+    while(((idx + len) < elements.size()) &&
+        elements[idx + len].m_isFiller &&
+        (elements[idx + len].m_rot == 0) &&
+        (!elements[idx + len].m_flip))
+    {
+        len++;
+    }
+    return len;
+}
+
+void GDS2HierWriter::appendSREF(const Element &e)
+{
+    size_t pos = m_data.size();
+    m_data.resize(pos + GDS2Writer::getSREFSize(e.m_cellName, e.m_rot));
+    GDS2Writer::encodeSREF(&m_data[pos], e.m_cellName, e.m_rot, e.m_flip, 
+        static_cast<uint32_t>(e.m_x), static_cast<uint32_t>(e.m_y));
+}
+
+void GDS2HierWriter::appendStructure(const std::string &name, const std::vector<Element> &elements)
+{
+    size_t pos = m_data.size();
+    m_data.resize(pos + GDS2Writer::getBeginStructureSize(name));
+    GDS2Writer::encodeBeginStructure(&m_data[pos], name);
+
+    for(auto const &e : elements)
+    {
+        appendSREF(e);
+    }
+
+    pos = m_data.size();
+    m_data.resize(pos + 4);
+    GDS2Writer::encodeEndStructure(&m_data[pos]);
+}
+
+bool GDS2HierWriter::writeFile()
+{
+    int64_t width  = static_cast<int32_t>(static_cast<uint32_t>(m_dieWidth*1000.0));
+    int64_t height = static_cast<int32_t>(static_cast<uint32_t>(m_dieHeight*1000.0));
+
+    // the local frame of every edge runs along the x axis, 
+    // with the pads facing the same way as on the south edge.
+    const size_t edgeCount = 4;
+    EdgeFrame frames[edgeCount] = 
+    {
+        {"N", 180, width, height},
+        {"S", 0,   0,     0},
+        {"W", 270, 0,     height},
+        {"E", 90,  width, 0}
+    };
+
+    std::vector<Element> top;
+    std::vector<Element> edges[edgeCount];
+    for(auto const &block : m_blocks)
+    {
+        for(auto const &item : *block)
+        {
+            size_t edge = 0;
+            while((edge < edgeCount) && (frames[edge].m_location != item.m_location))
+            {
+                edge++;
+            }
+
+            if (edge == edgeCount)
+            {
+                top.push_back(toElement(&item));
+            }
+            else
+            {
+                edges[edge].push_back(toLocal(toElement(&item), frames[edge]));
+            }
+        }
+    }
+
+    // the north and west edges are emitted in the
+    // opposite direction of their local x axis.
+    std::reverse(edges[0].begin(), edges[0].end());
+    std::reverse(edges[2].begin(), edges[2].end());
+
+    // share the structures of identical edges
+    std::map<std::string, size_t> edgeKeys;
+    std::vector<size_t> uniqueEdges;
+    size_t edgeStruct[edgeCount];
+    for(size_t edge=0; edge<edgeCount; edge++)
+    {
+        if (edges[edge].empty())
+        {
+            continue;
+        }
+
+        std::string key = getKey(edges[edge].begin(), edges[edge].end(), false);
+        auto iter = edgeKeys.find(key);
+        if (iter == edgeKeys.end())
+        {
+            iter = edgeKeys.emplace(key, uniqueEdges.size()).first;
+            uniqueEdges.push_back(edge);
+        }
+        edgeStruct[edge] = iter->second;
+    }
+
+    // count how often every run of fillers occurs
+    std::map<std::string, size_t> gapUsage;
+    for(auto edge : uniqueEdges)
+    {
+        auto const &elements = edges[edge];
+        size_t idx = 0;
+        while(idx < elements.size())
+        {
+            size_t len = getGapLength(elements, idx);
+            if (len >= 2)
+            {
+                gapUsage[getKey(elements.begin() + idx, elements.begin() + idx + len, true)]++;
+            }
+            idx += std::max<size_t>(len, 1);
+        }
+    }
+
+    // replace the repeated runs of fillers by 
+    // a reference to a gap structure.
+    std::map<std::string, std::string> gapNames;
+    std::vector<std::vector<Element> > gapStructs;
+    std::vector<std::vector<Element> > edgeStructs;
+    for(auto edge : uniqueEdges)
+    {
+        auto const &elements = edges[edge];
+        std::vector<Element> contents;
+        size_t idx = 0;
+        while(idx < elements.size())
+        {
+            size_t len = getGapLength(elements, idx);
+            std::string key;
+            if (len >= 2)
+            {
+                key = getKey(elements.begin() + idx, elements.begin() + idx + len, true);
+            }
+
+            if ((len < 2) || (gapUsage[key] < 2))
+            {
+                len = std::max<size_t>(len, 1);
+                contents.insert(contents.end(), elements.begin() + idx, elements.begin() + idx + len);
+                idx += len;
+                continue;
+            }
+
+            auto iter = gapNames.find(key);
+            if (iter == gapNames.end())
+            {
+                std::vector<Element> gap(elements.begin() + idx, elements.begin() + idx + len);
+                for(auto &e : gap)
+                {
+                    e.m_x -= elements[idx].m_x;
+                    e.m_y -= elements[idx].m_y;
+                }
+                gapStructs.push_back(gap);
+                iter = gapNames.emplace(key, m_designName + "_GAP" + std::to_string(gapStructs.size()-1)).first;
+            }
+
+            Element ref;
+            ref.m_cellName = iter->second;
+            ref.m_rot  = 0;
+            ref.m_flip = false;
+            ref.m_x = elements[idx].m_x;
+            ref.m_y = elements[idx].m_y;
+            ref.m_isFiller = false;
+            contents.push_back(ref);
+            idx += len;
+        }
+        edgeStructs.push_back(contents);
+    }
+
+    doLog(LOG_VERBOSE, "GDS2: %zu edge structures, %zu gap structures\n", edgeStructs.size(), gapStructs.size());
+
+    // write the children before the structures
+    // that refer to them.
+    m_data.resize(GDS2Writer::c_libHeaderSize);
+    GDS2Writer::encodeLibHeader(&m_data[0]);
+
+    if (m_library != nullptr)
+    {
+        auto structures = m_library->getStructures(m_blocks);
+        doLog(LOG_VERBOSE, "GDS2: copying %zu library structures\n", structures.size());
+        for(auto const &s : structures)
+        {
+            m_data.insert(m_data.end(), s.m_data, s.m_data + s.m_size);
+        }
+    }
+
+    for(size_t i=0; i<gapStructs.size(); i++)
+    {
+        appendStructure(m_designName + "_GAP" + std::to_string(i), gapStructs[i]);
+    }
+
+    for(size_t i=0; i<edgeStructs.size(); i++)
+    {
+        appendStructure(m_designName + "_EDGE" + std::to_string(i), edgeStructs[i]);
+    }
+
+    for(size_t edge=0; edge<edgeCount; edge++)
+    {
+        if (edges[edge].empty())
+        {
+            continue;
+        }
+
+        Element ref;
+        ref.m_cellName = m_designName + "_EDGE" + std::to_string(edgeStruct[edge]);
+        ref.m_rot  = frames[edge].m_rot;
+        ref.m_flip = false;
+        ref.m_x = frames[edge].m_x;
+        ref.m_y = frames[edge].m_y;
+        ref.m_isFiller = false;
+        top.push_back(ref);
+    }
+
+    size_t pos = m_data.size();
+    m_data.resize(pos + GDS2Writer::getBeginStructureSize(m_designName));
+    GDS2Writer::encodeBeginStructure(&m_data[pos], m_designName);
+    for(auto const &e : top)
+    {
+        appendSREF(e);
+    }
+
+    pos = m_data.size();
+    m_data.resize(pos + GDS2Writer::c_epilogSize);
+    GDS2Writer::encodeEpilog(&m_data[pos]);
+
+    if (m_compress)
+    {
+        FILE *fout = m_fout;
+        GzipWriter gzip([fout](const uint8_t *p, size_t bytes)
+            {
+                return fwrite(p, 1, bytes, fout) == bytes;
+            });
+        gzip.write(&m_data[0], m_data.size());
+        return gzip.finish();
+    }
+
+    return (fwrite(&m_data[0], 1, m_data.size(), m_fout) == m_data.size());
+}
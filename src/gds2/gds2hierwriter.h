@@ -0,0 +1,133 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef gds2hierwriter_h
+#define gds2hierwriter_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <memory>
+#include <vector>
+
+#include "../outputsink.h"
+#include "gds2library.h"
+
+/** GDS2 writer that writes a hierarchical padring.
+
+    Every edge is transformed into a local frame in which
+    it runs along the x axis, like the south edge. Edges
+    with identical contents in their local frame share a
+    single structure. Runs of fillers that occur more than
+    once with the same decomposition become a structure of
+    their own as well. The top structure only holds the
+    corners and one transformed SREF per edge.
+
+    All the coordinates are handled in database units,
+    so flattening the hierarchy gives exactly the same
+    placements as GDS2Writer.
+*/
+class GDS2HierWriter : public OutputSink
+{
+public:
+    /** open a GDS2 file for writing. returns nullptr
+        if the file cannot be created.
+    */
+    static GDS2HierWriter* open(
+        const std::string &filename,
+        const std::string &designName,
+        double dieWidth,
+        double dieHeight);
+
+    /** closes the file, if the writer was not closed */
+    virtual ~GDS2HierWriter();
+
+    void writeCell(const LayoutItem *item) override;
+    void writeBlock(const std::shared_ptr<const PlacementBlock> &block) override;
+
+    /** writes the hierarchy and closes the file.
+        returns false on an I/O error. */
+    bool close() override;
+
+    /** copy the library structures of the placed cells,
+        and their children, into the file. the library
+        must outlive the writer.
+    */
+    void setLibrary(const GDS2Library *library)
+    {
+        m_library = library;
+    }
+
+protected:
+    GDS2HierWriter(FILE *f, const std::string &designName, double dieWidth, double dieHeight, bool compress);
+
+    /** a reference to a cell or structure, in database units */
+    struct Element
+    {
+        std::string m_cellName;
+        uint32_t    m_rot;      ///< rotation in degrees
+        bool        m_flip;     ///< reflection about the x axis
+        int64_t     m_x;
+        int64_t     m_y;
+        bool        m_isFiller;
+    };
+
+    /** transform from the local frame of an edge to the top structure */
+    struct EdgeFrame
+    {
+        std::string m_location;
+        uint32_t    m_rot;
+        int64_t     m_x;
+        int64_t     m_y;
+    };
+
+    /** convert an item into an element at the same position as GDS2Writer */
+    static Element toElement(const LayoutItem *item);
+
+    /** transform a top-level element into the local frame of an edge */
+    static Element toLocal(const Element &e, const EdgeFrame &frame);
+
+    /** a string that identifies a sequence of elements */
+    static std::string getKey(const std::vector<Element>::const_iterator &begin, 
+        const std::vector<Element>::const_iterator &end, bool relative);
+
+    /** get the length of the run of fillers starting at an element */
+    static size_t getGapLength(const std::vector<Element> &elements, size_t idx);
+
+    /** build the hierarchy and write the file.
+        returns false on an I/O error. */
+    bool writeFile();
+
+    void appendSREF(const Element &e);
+    void appendStructure(const std::string &name, const std::vector<Element> &elements);
+
+    FILE        *m_fout;        ///< GDS2 file handle
+    std::string m_designName;
+    double      m_dieWidth;
+    double      m_dieHeight;
+    bool        m_compress;     ///< write a gzip compressed file
+    const GDS2Library *m_library;   ///< cell library, or nullptr
+
+    std::vector<std::shared_ptr<const PlacementBlock> > m_blocks;
+    std::shared_ptr<PlacementBlock> m_cells;   ///< cells written one by one
+
+    std::vector<uint8_t> m_data;    ///< encoded file
+};
+
+#endif
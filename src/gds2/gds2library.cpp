@@ -0,0 +1,186 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <string.h>
+
+#include "../logging.h"
+#include "gds2writer.h"
+#include "gds2library.h"
+
+// GDS2 record types
+enum gds2Record_t
+{
+    GDS2_UNITS    = 0x03,
+    GDS2_ENDLIB   = 0x04,
+    GDS2_BGNSTR   = 0x05,
+    GDS2_STRNAME  = 0x06,
+    GDS2_ENDSTR   = 0x07,
+    GDS2_SNAME    = 0x12
+};
+
+bool GDS2Library::addFile(const std::string &filename)
+{
+    GDS2Reader *reader = GDS2Reader::open(filename);
+    if (reader == nullptr)
+    {
+        doLog(LOG_ERROR, "Cannot read GDS2 library %s\n", filename.c_str());
+        return false;
+    }
+
+    m_files.emplace_back(reader);
+    return indexFile(*reader);
+}
+
+bool GDS2Library::indexFile(GDS2Reader &reader)
+{
+    // the UNITS record this writer uses
+    uint8_t units[GDS2Writer::c_libHeaderSize];
+    GDS2Writer::encodeLibHeader(units);
+    const uint8_t *ourUnits = units + GDS2Writer::c_libHeaderSize - 0x14;
+
+    const char *filename = reader.getFilename().c_str();
+    const uint8_t *structStart = nullptr;
+    std::string structName;
+    std::vector<std::string> children;
+    size_t count = 0;
+
+    GDS2Reader::Record r;
+    while(reader.next(r))
+    {
+        switch(r.m_type)
+        {
+        case GDS2_UNITS:
+            if ((r.m_size != 0x14) || (memcmp(r.m_data, ourUnits, 0x14) != 0))
+            {
+                doLog(LOG_WARN, "GDS2 library %s uses different units, its structures are copied without scaling\n",
+                    filename);
+            }
+            break;
+        case GDS2_BGNSTR:
+            structStart = r.m_data;
+            structName.clear();
+            children.clear();
+            break;
+        case GDS2_STRNAME:
+            structName = r.getString();
+            break;
+        case GDS2_SNAME:
+            if (structStart != nullptr)
+            {
+                children.push_back(r.getString());
+            }
+            break;
+        case GDS2_ENDSTR:
+            if (structStart != nullptr)
+            {
+                Structure s;
+                s.m_data = structStart;
+                s.m_size = r.m_data + r.m_size - structStart;
+                std::sort(children.begin(), children.end());
+                children.erase(std::unique(children.begin(), children.end()), children.end());
+                s.m_children = children;
+                structStart = nullptr;
+
+                // the first library that defines a cell wins
+                if (!m_structures.emplace(structName, s).second)
+                {
+                    doLog(LOG_WARN, "GDS2 library %s: structure %s is already defined, skipped\n",
+                        filename, structName.c_str());
+                }
+                count++;
+            }
+            break;
+        case GDS2_ENDLIB:
+            doLog(LOG_VERBOSE, "GDS2 library %s: %zu structures\n", filename, count);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return !reader.hasError();
+}
+
+void GDS2Library::collect(const std::string &name, 
+    std::unordered_set<std::string> &visited, 
+    std::vector<Range> &ranges) const
+{
+    if (!visited.insert(name).second)
+    {
+        return;
+    }
+
+    auto iter = m_structures.find(name);
+    if (iter == m_structures.end())
+    {
+        doLog(LOG_WARN, "Cell %s is not in the GDS2 libraries\n", name.c_str());
+        return;
+    }
+
+    for(auto const &child : iter->second.m_children)
+    {
+        collect(child, visited, ranges);
+    }
+
+    Range r;
+    r.m_data = iter->second.m_data;
+    r.m_size = iter->second.m_size;
+    ranges.push_back(r);
+}
+
+std::vector<GDS2Library::Range> GDS2Library::getStructures(const std::unordered_set<std::string> &cellNames) const
+{
+    // sort the names so the output does not
+    // depend on the hash order.
+    std::vector<std::string> names(cellNames.begin(), cellNames.end());
+    std::sort(names.begin(), names.end());
+
+    std::unordered_set<std::string> visited;
+    std::vector<Range> ranges;
+    for(auto const &name : names)
+    {
+        collect(name, visited, ranges);
+    }
+    return ranges;
+}
+
+std::vector<GDS2Library::Range> GDS2Library::getStructures(
+    const std::vector<std::shared_ptr<const PlacementBlock> > &blocks) const
+{
+    std::unordered_set<std::string> cellNames;
+    for(auto const &block : blocks)
+    {
+        for(auto const &item : *block)
+        {
+            cellNames.insert(item.m_cellname);
+        }
+    }
+    return getStructures(cellNames);
+}
+
+size_t GDS2Library::getSize(const std::vector<Range> &ranges)
+{
+    size_t bytes = 0;
+    for(auto const &r : ranges)
+    {
+        bytes += r.m_size;
+    }
+    return bytes;
+}
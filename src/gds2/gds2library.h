@@ -0,0 +1,100 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef gds2library_h
+#define gds2library_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <memory>
+
+#include "../outputsink.h"
+#include "gds2reader.h"
+
+/** A set of cell library GDS2 files whose structures
+    are copied into the padring GDS2 file.
+
+    The files are read with GDS2Reader and only the structure
+    boundaries and the names of referenced structures are
+    indexed. The geometry is never decoded: a structure
+    is copied as the verbatim byte range from its BGNSTR
+    up to and including its ENDSTR record.
+*/
+class GDS2Library
+{
+public:
+    GDS2Library() {}
+
+    /** map a library file and index its structures.
+        returns false if the file cannot be read or
+        is not a valid GDS2 file.
+    */
+    bool addFile(const std::string &filename);
+
+    /** the encoded records of a structure */
+    struct Range
+    {
+        const uint8_t *m_data;
+        size_t         m_size;
+    };
+
+    /** get the structures of the given cells and of all the
+        structures they reference, children first. cells
+        that are not in the library are skipped. 
+    */
+    std::vector<Range> getStructures(const std::unordered_set<std::string> &cellNames) const;
+
+    /** get the structures of all the cells placed in the blocks */
+    std::vector<Range> getStructures(const std::vector<std::shared_ptr<const PlacementBlock> > &blocks) const;
+
+    /** get the total number of bytes of a list of structures */
+    static size_t getSize(const std::vector<Range> &ranges);
+
+    /** return the number of indexed structures */
+    size_t getStructureCount() const
+    {
+        return m_structures.size();
+    }
+
+protected:
+    /** an indexed structure */
+    struct Structure
+    {
+        const uint8_t           *m_data;
+        size_t                   m_size;
+        std::vector<std::string> m_children;   ///< names of the referenced structures
+    };
+
+    /** index the structures of a library file */
+    bool indexFile(GDS2Reader &reader);
+
+    /** add a structure and its children to the list, 
+        children first */
+    void collect(const std::string &name, 
+        std::unordered_set<std::string> &visited, 
+        std::vector<Range> &ranges) const;
+
+    std::vector<std::unique_ptr<GDS2Reader> > m_files;
+    std::unordered_map<std::string, Structure> m_structures;
+};
+
+#endif
@@ -0,0 +1,302 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "../logging.h"
+#include "../threadpool.h"
+#include "../gzipwriter.h"
+#include "gds2writer.h"
+#include "gds2templates.h"
+#include "gds2mappedwriter.h"
+
+GDS2MappedWriter* GDS2MappedWriter::open(const std::string &filename, 
+    const std::string &designName, uint32_t threads)
+{
+    int fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    return new GDS2MappedWriter(fd, filename, designName, threads);
+}
+
+GDS2MappedWriter::GDS2MappedWriter(int fd, const std::string &filename, 
+    const std::string &designName, uint32_t threads) 
+    : m_fd(fd), 
+      m_filename(filename),
+      m_designName(designName),
+      m_threads(threads),
+      m_useAREF(true),
+      m_compress(GzipWriter::isGzipFilename(filename)),
+      m_library(nullptr),
+      m_cache(nullptr)
+{
+    doLog(LOG_VERBOSE,"GDS2MappedWriter created\n");
+}
+
+GDS2MappedWriter::~GDS2MappedWriter()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+    doLog(LOG_VERBOSE,"GDS2MappedWriter destroyed\n");
+}
+
+bool GDS2MappedWriter::close()
+{
+    if (m_fd < 0)
+    {
+        return true;
+    }
+
+    bool ok = writeFile();
+    if (::close(m_fd) != 0)
+    {
+        ok = false;
+    }
+    m_fd = -1;
+    return ok;
+}
+
+void GDS2MappedWriter::writeCell(const LayoutItem *item)
+{
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    // collect single cells in a block of their own
+    if (!m_cells)
+    {
+        m_cells = std::make_shared<PlacementBlock>();
+        m_blocks.push_back(m_cells);
+    }
+    m_cells->push_back(*item);
+}
+
+void GDS2MappedWriter::writeBlock(const std::shared_ptr<const PlacementBlock> &block)
+{
+    m_cells.reset();
+    m_blocks.push_back(block);
+}
+
+bool GDS2MappedWriter::writeAll(int fd, const uint8_t *data, size_t bytes)
+{
+    while(bytes > 0)
+    {
+        ssize_t written = ::write(fd, data, bytes);
+        if (written <= 0)
+        {
+            return false;
+        }
+        data += written;
+        bytes -= written;
+    }
+    return true;
+}
+
+size_t GDS2MappedWriter::getRun(const PlacementBlock &block, size_t idx) const
+{
+    if (!m_useAREF)
+    {
+        return 1;
+    }
+    return GDS2Writer::getFillerRun(&block[idx], block.size() - idx);
+}
+
+bool GDS2MappedWriter::writeFile()
+{
+    // no more threads than blocks
+    uint32_t threads = m_threads;
+    if (threads == 0)
+    {
+        threads = std::thread::hardware_concurrency();
+    }
+    threads = std::max<size_t>(1, std::min<size_t>(threads, m_blocks.size()));
+    ThreadPool pool(threads);
+
+    // prefix pass: the size of every block
+    std::vector<size_t> offsets(m_blocks.size() + 1, 0);
+    std::vector<size_t> arrays(m_blocks.size(), 0);
+    std::vector<std::shared_ptr<const std::vector<uint8_t> > > encoded(m_blocks.size());
+    for(size_t i=0; i<m_blocks.size(); i++)
+    {
+        if (m_cache != nullptr)
+        {
+            encoded[i] = m_cache->getGDS2(m_blocks[i].get(), m_useAREF);
+            if (encoded[i])
+            {
+                offsets[i+1] = encoded[i]->size();
+                continue;
+            }
+        }
+
+        pool.submit([this, i, &offsets, &arrays]()
+        {
+            GDS2Templates templates;
+            const PlacementBlock &block = *m_blocks[i];
+            size_t bytes = 0;
+            size_t idx = 0;
+            while(idx < block.size())
+            {
+                size_t run = getRun(block, idx);
+                if (run > 1)
+                {
+                    bytes += GDS2Writer::getArraySize(&block[idx]);
+                    arrays[i]++;
+                }
+                else
+                {
+                    bytes += templates.getCellSize(&block[idx]);
+                }
+                idx += run;
+            }
+            offsets[i+1] = bytes;
+        });
+    }
+    pool.wait();
+
+    size_t items = 0;
+    size_t arrayCount = 0;
+    for(size_t i=0; i<m_blocks.size(); i++)
+    {
+        items += m_blocks[i]->size();
+        arrayCount += arrays[i];
+    }
+    doLog(LOG_VERBOSE, "GDS2: %zu cells written using %zu AREF elements\n", items, arrayCount);
+
+    // library structures go between the library
+    // header and the padring structure.
+    std::vector<GDS2Library::Range> structures;
+    if (m_library != nullptr)
+    {
+        structures = m_library->getStructures(m_blocks);
+        doLog(LOG_VERBOSE, "GDS2: copying %zu library structures\n", structures.size());
+    }
+
+    offsets[0] = GDS2Writer::getHeaderSize(m_designName) + GDS2Library::getSize(structures);
+    for(size_t i=1; i<offsets.size(); i++)
+    {
+        offsets[i] += offsets[i-1];
+    }
+    size_t fileSize = offsets.back() + GDS2Writer::c_epilogSize;
+
+    // reserve the blocks of the file before mapping it, so a
+    // full disk is reported here instead of raising SIGBUS when
+    // the mapping is written. compressed files, and files that
+    // cannot be reserved or mapped, are encoded in memory first.
+    std::vector<uint8_t> memory;
+    void *map = MAP_FAILED;
+    if (!m_compress)
+    {
+        if (posix_fallocate(m_fd, 0, fileSize) == 0)
+        {
+            map = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+        }
+        if (map == MAP_FAILED)
+        {
+            doLog(LOG_VERBOSE, "GDS2: cannot map %s, writing it from memory\n", m_filename.c_str());
+        }
+    }
+
+    uint8_t *data;
+    if (map != MAP_FAILED)
+    {
+        data = static_cast<uint8_t*>(map);
+    }
+    else
+    {
+        memory.resize(fileSize);
+        data = memory.data();
+    }
+
+    uint8_t *p = GDS2Writer::encodeLibHeader(data);
+    for(auto const &s : structures)
+    {
+        memcpy(p, s.m_data, s.m_size);
+        p += s.m_size;
+    }
+    GDS2Writer::encodeBeginStructure(p, m_designName);
+
+    // every block is encoded into its own region
+    for(size_t i=0; i<m_blocks.size(); i++)
+    {
+        if (encoded[i])
+        {
+            memcpy(data + offsets[i], encoded[i]->data(), encoded[i]->size());
+            continue;
+        }
+
+        pool.submit([this, i, data, &offsets]()
+        {
+            GDS2Templates templates;
+            const PlacementBlock &block = *m_blocks[i];
+            uint8_t *p = data + offsets[i];
+            size_t idx = 0;
+            while(idx < block.size())
+            {
+                size_t run = getRun(block, idx);
+                if (run > 1)
+                {
+                    p = GDS2Writer::encodeArray(p, &block[idx], run);
+                }
+                else
+                {
+                    p = templates.encodeCell(p, &block[idx]);
+                }
+                idx += run;
+            }
+
+            if (m_cache != nullptr)
+            {
+                m_cache->setGDS2(&block, m_useAREF, data + offsets[i], offsets[i+1] - offsets[i]);
+            }
+        });
+    }
+    pool.wait();
+
+    GDS2Writer::encodeEpilog(data + offsets.back());
+
+    if (map != MAP_FAILED)
+    {
+        // msync reports the write errors of the mapping
+        bool ok = (msync(map, fileSize, MS_SYNC) == 0);
+        return (munmap(map, fileSize) == 0) && ok;
+    }
+
+    if (m_compress)
+    {
+        int fd = m_fd;
+        GzipWriter gzip([fd](const uint8_t *p, size_t bytes)
+            {
+                return writeAll(fd, p, bytes);
+            }, m_threads);
+        gzip.write(data, fileSize);
+        return gzip.finish();
+    }
+
+    return writeAll(m_fd, data, fileSize);
+}
@@ -0,0 +1,130 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef gds2mappedwriter_h
+#define gds2mappedwriter_h
+
+#include <stdint.h>
+#include <string>
+#include <memory>
+#include <vector>
+
+#include "../outputsink.h"
+#include "gds2library.h"
+#include "../placementcache.h"
+
+/** GDS2 writer that encodes the placement blocks in
+    parallel, straight into a memory-mapped file.
+
+    The blocks are collected until the writer is closed.
+    The size of every SREF element is known in advance, so 
+    a prefix pass computes the file offset of each block.
+    The file is then allocated at its exact size and mapped,
+    and the blocks are encoded into their disjoint regions by
+    worker threads. The header and epilog are written
+    around them. When the file cannot be allocated or 
+    mapped, it is encoded in memory and written from there.
+
+    The output is byte-identical to GDS2Writer, unless
+    a cell library is set: its structures for the placed 
+    cells are then copied in front of the padring structure.
+
+    When the file name ends in .gz, the blocks are encoded
+    into memory instead and the result is compressed in
+    parallel with GzipWriter.
+*/
+class GDS2MappedWriter : public OutputSink
+{
+public:
+    /** open a GDS2 file for writing. returns nullptr
+        if the file cannot be created. when threads is 0, 
+        the number of hardware threads is used.
+    */
+    static GDS2MappedWriter* open(
+        const std::string &filename,
+        const std::string &designName,
+        uint32_t threads = 0);
+
+    /** closes the file, if the writer was not closed */
+    virtual ~GDS2MappedWriter();
+
+    void writeCell(const LayoutItem *item) override;
+    void writeBlock(const std::shared_ptr<const PlacementBlock> &block) override;
+
+    /** encodes all the blocks and closes the file.
+        returns false on an I/O error. */
+    bool close() override;
+
+    /** when enabled, runs of identical fillers within a 
+        block are written as a single array reference (AREF),
+        like GDS2Writer does.
+    */
+    void setUseAREF(bool useAREF)
+    {
+        m_useAREF = useAREF;
+    }
+
+    /** copy the library structures of the placed cells,
+        and their children, into the file. the library
+        must outlive the writer.
+    */
+    void setLibrary(const GDS2Library *library)
+    {
+        m_library = library;
+    }
+
+    /** reuse the encoding of blocks that were encoded
+        before and keep the encoding of new cached blocks.
+        the cache must outlive the writer.
+    */
+    void setCache(PlacementCache *cache)
+    {
+        m_cache = cache;
+    }
+
+protected:
+    GDS2MappedWriter(int fd, const std::string &filename, 
+        const std::string &designName, uint32_t threads);
+
+    /** encode all the blocks into the file.
+        returns false on an I/O error. */
+    bool writeFile();
+
+    /** write all the bytes to a file descriptor.
+        returns false on an I/O error. */
+    static bool writeAll(int fd, const uint8_t *data, size_t bytes);
+
+    /** get the length of the run of fillers in a block
+        starting at the given index */
+    size_t getRun(const PlacementBlock &block, size_t idx) const;
+
+    int         m_fd;           ///< GDS2 file descriptor
+    std::string m_filename;
+    std::string m_designName;
+    uint32_t    m_threads;
+    bool        m_useAREF;
+    bool        m_compress;     ///< write a gzip compressed file
+    const GDS2Library *m_library;   ///< cell library, or nullptr
+    PlacementCache    *m_cache;     ///< block encodings, or nullptr
+
+    std::vector<std::shared_ptr<const PlacementBlock> > m_blocks;
+    std::shared_ptr<PlacementBlock> m_cells;   ///< cells written one by one
+};
+
+#endif
@@ -0,0 +1,408 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <cmath>
+#include <string.h>
+#include <tuple>
+#include <unordered_map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "../logging.h"
+#include "gds2reader.h"
+
+// GDS2 record types
+enum gds2Record_t
+{
+    GDS2_ENDLIB   = 0x04,
+    GDS2_BGNSTR   = 0x05,
+    GDS2_STRNAME  = 0x06,
+    GDS2_ENDSTR   = 0x07,
+    GDS2_SREF     = 0x0A,
+    GDS2_AREF     = 0x0B,
+    GDS2_XY       = 0x10,
+    GDS2_ENDEL    = 0x11,
+    GDS2_SNAME    = 0x12,
+    GDS2_COLROW   = 0x13,
+    GDS2_STRANS   = 0x1A,
+    GDS2_ANGLE    = 0x1C
+};
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (static_cast<uint16_t>(p[0]) << 8) | p[1];
+}
+
+static int32_t get32(const uint8_t *p)
+{
+    return static_cast<int32_t>((static_cast<uint32_t>(p[0]) << 24) | 
+        (static_cast<uint32_t>(p[1]) << 16) | 
+        (static_cast<uint32_t>(p[2]) << 8) | p[3]);
+}
+
+GDS2Reader* GDS2Reader::open(const std::string &filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat st;
+    if ((fstat(fd, &st) != 0) || (st.st_size == 0))
+    {
+        ::close(fd);
+        return nullptr;
+    }
+
+    // map all the pages up front, instead of
+    // faulting them in one by one.
+    void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    return new GDS2Reader(filename, static_cast<const uint8_t*>(map), st.st_size);
+}
+
+GDS2Reader::GDS2Reader(const std::string &filename, const uint8_t *data, size_t size)
+    : m_filename(filename),
+      m_data(data),
+      m_size(size),
+      m_pos(0),
+      m_error(false),
+      m_ended(false)
+{
+}
+
+GDS2Reader::~GDS2Reader()
+{
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+std::string GDS2Reader::Record::getString() const
+{
+    // strings are padded with a NUL to an even length
+    size_t bytes = getBodySize();
+    const uint8_t *body = getBody();
+    while((bytes > 0) && (body[bytes-1] == 0))
+    {
+        bytes--;
+    }
+    return std::string(reinterpret_cast<const char*>(body), bytes);
+}
+
+bool GDS2Reader::next(Record &record)
+{
+    if (m_error || m_ended)
+    {
+        return false;
+    }
+
+    if ((m_pos + 4) > m_size)
+    {
+        doLog(LOG_ERROR, "GDS2 file %s: missing ENDLIB record\n", m_filename.c_str());
+        m_error = true;
+        return false;
+    }
+
+    size_t bytes = get16(m_data + m_pos);
+    if ((bytes < 4) || ((bytes % 2) != 0) || ((m_pos + bytes) > m_size))
+    {
+        doLog(LOG_ERROR, "GDS2 file %s: invalid record at offset %zu\n", m_filename.c_str(), m_pos);
+        m_error = true;
+        return false;
+    }
+
+    record.m_type     = m_data[m_pos+2];
+    record.m_dataType = m_data[m_pos+3];
+    record.m_data     = m_data + m_pos;
+    record.m_size     = bytes;
+    m_pos += bytes;
+
+    m_ended = (record.m_type == GDS2_ENDLIB);
+    return true;
+}
+
+double GDS2Reader::decodeReal(const uint8_t *p)
+{
+    // sign, excess-64 base-16 exponent and
+    // a 56-bit fraction.
+    uint64_t mantissa = 0;
+    for(uint32_t i=1; i<8; i++)
+    {
+        mantissa = (mantissa << 8) | p[i];
+    }
+    int32_t exponent = (p[0] & 0x7F) - 64;
+    double v = std::ldexp(static_cast<double>(mantissa), 4*exponent - 56);
+    return (p[0] & 0x80) ? -v : v;
+}
+
+bool GDS2Reader::readStructures(std::vector<Structure> &structures)
+{
+    rewind();
+
+    // references are decoded in place, at the
+    // end of the list of the current structure.
+    Record r;
+    Reference *ref = nullptr;
+    Structure *current = nullptr;
+    bool     hasAngle = false;
+    uint64_t angleBits = 0;
+    uint32_t angleRot = 0;
+    while(next(r))
+    {
+        switch(r.m_type)
+        {
+        case GDS2_BGNSTR:
+            structures.emplace_back();
+            current = &structures.back();
+            break;
+        case GDS2_STRNAME:
+            if (current != nullptr)
+            {
+                current->m_name = r.getString();
+            }
+            break;
+        case GDS2_ENDSTR:
+            current = nullptr;
+            break;
+        case GDS2_SREF:
+        case GDS2_AREF:
+            if (current != nullptr)
+            {
+                current->m_references.emplace_back();
+                ref = &current->m_references.back();
+                ref->m_rot = 0;
+                ref->m_flip = false;
+                ref->m_isArray = (r.m_type == GDS2_AREF);
+                ref->m_cols = 1;
+                ref->m_rows = 1;
+            }
+            break;
+        case GDS2_SNAME:
+            if (ref != nullptr)
+            {
+                ref->m_cellName = r.getString();
+            }
+            break;
+        case GDS2_STRANS:
+            if ((ref != nullptr) && (r.getBodySize() >= 2))
+            {
+                ref->m_flip = (r.getBody()[0] & 0x80) != 0;
+            }
+            break;
+        case GDS2_ANGLE:
+            if ((ref != nullptr) && (r.getBodySize() == 8))
+            {
+                // the same few angles are used over and over
+                uint64_t bits;
+                memcpy(&bits, r.getBody(), 8);
+                if (!hasAngle || (bits != angleBits))
+                {
+                    double angle = std::fmod(std::round(decodeReal(r.getBody())), 360.0);
+                    angleRot = static_cast<uint32_t>((angle < 0.0) ? angle + 360.0 : angle);
+                    angleBits = bits;
+                    hasAngle = true;
+                }
+                ref->m_rot = angleRot;
+            }
+            break;
+        case GDS2_COLROW:
+            if ((ref != nullptr) && (r.getBodySize() == 4))
+            {
+                ref->m_cols = get16(r.getBody());
+                ref->m_rows = get16(r.getBody() + 2);
+            }
+            break;
+        case GDS2_XY:
+            if (ref != nullptr)
+            {
+                size_t points = ref->m_isArray ? 3 : 1;
+                if (r.getBodySize() != points*8)
+                {
+                    doLog(LOG_ERROR, "GDS2 file %s: invalid XY record at offset %zu\n", 
+                        m_filename.c_str(), r.m_data - m_data);
+                    return false;
+                }
+                for(size_t i=0; i<points*2; i++)
+                {
+                    ref->m_xy[i] = get32(r.getBody() + 4*i);
+                }
+            }
+            break;
+        case GDS2_ENDEL:
+            ref = nullptr;
+            break;
+        default:
+            break;
+        }
+    }
+
+    return !hasError();
+}
+
+bool GDS2Reader::Placement::operator<(const Placement &other) const
+{
+    return std::tie(m_cellName, m_rot, m_flip, m_x, m_y) <
+        std::tie(other.m_cellName, other.m_rot, other.m_flip, other.m_x, other.m_y);
+}
+
+bool GDS2Reader::Placement::operator==(const Placement &other) const
+{
+    return std::tie(m_cellName, m_rot, m_flip, m_x, m_y) ==
+        std::tie(other.m_cellName, other.m_rot, other.m_flip, other.m_x, other.m_y);
+}
+
+namespace
+{
+    /** v -> R(rot) F(flip) v + (x,y) */
+    struct Transform
+    {
+        uint32_t    m_rot;
+        bool        m_flip;
+        int64_t     m_x;
+        int64_t     m_y;
+    };
+
+    void rotate(int64_t &x, int64_t &y, uint32_t rot)
+    {
+        int64_t tx = x;
+        switch(rot)
+        {
+        case 0:
+            break;
+        case 90:
+            x = -y;
+            y = tx;
+            break;
+        case 180:
+            x = -x;
+            y = -y;
+            break;
+        case 270:
+            x = y;
+            y = -tx;
+            break;
+        default:
+            {
+                double a = rot * M_PI / 180.0;
+                x = std::llround(tx*std::cos(a) - y*std::sin(a));
+                y = std::llround(tx*std::sin(a) + y*std::cos(a));
+            }
+            break;
+        }
+    }
+
+    bool flattenStructure(const std::vector<GDS2Reader::Structure> &structures,
+        const std::unordered_map<std::string, size_t> &index,
+        size_t structure,
+        const Transform &t,
+        const std::unordered_set<std::string> &leafCells,
+        std::vector<GDS2Reader::Placement> &placements,
+        uint32_t depth)
+    {
+        if (depth > 64)
+        {
+            doLog(LOG_ERROR, "GDS2 hierarchy is too deep or recursive\n");
+            return false;
+        }
+
+        for(auto const &ref : structures[structure].m_references)
+        {
+            for(uint32_t row=0; row<ref.m_rows; row++)
+            {
+                for(uint32_t col=0; col<ref.m_cols; col++)
+                {
+                    // the array points are in the coordinates
+                    // of the parent structure.
+                    int64_t x = ref.m_xy[0];
+                    int64_t y = ref.m_xy[1];
+                    if (ref.m_isArray)
+                    {
+                        x += (static_cast<int64_t>(ref.m_xy[2]) - ref.m_xy[0]) * col / ref.m_cols;
+                        y += (static_cast<int64_t>(ref.m_xy[3]) - ref.m_xy[1]) * col / ref.m_cols;
+                        x += (static_cast<int64_t>(ref.m_xy[4]) - ref.m_xy[0]) * row / ref.m_rows;
+                        y += (static_cast<int64_t>(ref.m_xy[5]) - ref.m_xy[1]) * row / ref.m_rows;
+                    }
+
+                    // compose with the transform of the parent
+                    if (t.m_flip)
+                    {
+                        y = -y;
+                    }
+                    rotate(x, y, t.m_rot);
+
+                    Transform child;
+                    child.m_x = x + t.m_x;
+                    child.m_y = y + t.m_y;
+                    child.m_flip = t.m_flip != ref.m_flip;
+                    child.m_rot = ((t.m_flip ? (360 - ref.m_rot) : ref.m_rot) + t.m_rot) % 360;
+
+                    auto iter = index.find(ref.m_cellName);
+                    if ((leafCells.count(ref.m_cellName) > 0) || (iter == index.end()))
+                    {
+                        GDS2Reader::Placement p;
+                        p.m_cellName = ref.m_cellName;
+                        p.m_rot  = child.m_rot;
+                        p.m_flip = child.m_flip;
+                        p.m_x = child.m_x;
+                        p.m_y = child.m_y;
+                        placements.push_back(p);
+                    }
+                    else if (!flattenStructure(structures, index, iter->second, child, leafCells, placements, depth+1))
+                    {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+
+bool GDS2Reader::flatten(const std::vector<Structure> &structures,
+    const std::string &top,
+    const std::unordered_set<std::string> &leafCells,
+    std::vector<Placement> &placements)
+{
+    std::unordered_map<std::string, size_t> index;
+    for(size_t i=0; i<structures.size(); i++)
+    {
+        index[structures[i].m_name] = i;
+    }
+
+    auto iter = index.find(top);
+    if (iter == index.end())
+    {
+        doLog(LOG_ERROR, "GDS2 structure %s not found\n", top.c_str());
+        return false;
+    }
+
+    Transform t;
+    t.m_rot = 0;
+    t.m_flip = false;
+    t.m_x = 0;
+    t.m_y = 0;
+    return flattenStructure(structures, index, iter->second, t, leafCells, placements, 0);
+}
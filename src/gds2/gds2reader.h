@@ -0,0 +1,164 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef gds2reader_h
+#define gds2reader_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+/** A streaming GDS2 reader.
+
+    The file is memory-mapped and the records are
+    iterated in place, without copying. On top of the
+    record iteration, the structures and their SREF and
+    AREF elements can be decoded; all the other elements,
+    including the geometry, are skipped.
+*/
+class GDS2Reader
+{
+public:
+    /** map a GDS2 file for reading. returns nullptr
+        if the file cannot be read.
+    */
+    static GDS2Reader* open(const std::string &filename);
+
+    virtual ~GDS2Reader();
+
+    /** a record in the mapped file */
+    struct Record
+    {
+        uint8_t         m_type;     ///< record type
+        uint8_t         m_dataType; ///< data type
+        const uint8_t  *m_data;     ///< start of the record, including the header
+        size_t          m_size;     ///< size of the record in bytes
+
+        const uint8_t* getBody() const
+        {
+            return m_data + 4;
+        }
+
+        size_t getBodySize() const
+        {
+            return m_size - 4;
+        }
+
+        /** get the record body as a string, without padding */
+        std::string getString() const;
+    };
+
+    /** get the next record. returns false at the end of
+        the library (after ENDLIB) or on an invalid record, 
+        see hasError().
+    */
+    bool next(Record &record);
+
+    /** restart reading from the beginning of the file */
+    void rewind()
+    {
+        m_pos = 0;
+        m_error = false;
+        m_ended = false;
+    }
+
+    /** true if an invalid record was found */
+    bool hasError() const
+    {
+        return m_error;
+    }
+
+    /** get the offset of the next record */
+    size_t getPosition() const
+    {
+        return m_pos;
+    }
+
+    const std::string& getFilename() const
+    {
+        return m_filename;
+    }
+
+    size_t getSize() const
+    {
+        return m_size;
+    }
+
+    /** an SREF or AREF element */
+    struct Reference
+    {
+        std::string m_cellName;
+        uint32_t    m_rot;      ///< rotation in degrees
+        bool        m_flip;     ///< reflection about the x axis
+        bool        m_isArray;  ///< AREF element
+        uint16_t    m_cols;
+        uint16_t    m_rows;
+        int32_t     m_xy[6];    ///< position, and for an AREF the column and row end points
+    };
+
+    /** a structure and the references it holds */
+    struct Structure
+    {
+        std::string             m_name;
+        std::vector<Reference>  m_references;
+    };
+
+    /** decode all the structures and their references.
+        returns false if the file is not valid.
+    */
+    bool readStructures(std::vector<Structure> &structures);
+
+    /** a placed cell in the coordinates of the top structure */
+    struct Placement
+    {
+        std::string m_cellName;
+        uint32_t    m_rot;
+        bool        m_flip;
+        int64_t     m_x;
+        int64_t     m_y;
+
+        bool operator<(const Placement &other) const;
+        bool operator==(const Placement &other) const;
+    };
+
+    /** flatten the hierarchy below the top structure, expanding
+        the arrays. references to leaf cells, or to structures
+        that are not in the file, become placements.
+    */
+    static bool flatten(const std::vector<Structure> &structures,
+        const std::string &top,
+        const std::unordered_set<std::string> &leafCells,
+        std::vector<Placement> &placements);
+
+    /** decode an 8-byte GDS2 real */
+    static double decodeReal(const uint8_t *p);
+
+protected:
+    GDS2Reader(const std::string &filename, const uint8_t *data, size_t size);
+
+    std::string     m_filename;
+    const uint8_t   *m_data;
+    size_t          m_size;
+    size_t          m_pos;      ///< offset of the next record
+    bool            m_error;
+    bool            m_ended;    ///< ENDLIB was read
+};
+
+#endif
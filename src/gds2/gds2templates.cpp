@@ -0,0 +1,89 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <string.h>
+#include "gds2writer.h"
+#include "gds2templates.h"
+
+const GDS2Templates::Template* GDS2Templates::getTemplate(const LayoutItem *item)
+{
+    // consecutive instances, such as fillers, 
+    // often use the same template.
+    if ((m_last != nullptr) && isMatch(*m_last, item))
+    {
+        return m_last;
+    }
+
+    // there are only a handful of templates,
+    // so a linear search is fast enough.
+    for(auto const &t : m_templates)
+    {
+        if (isMatch(t, item))
+        {
+            m_last = &t;
+            return m_last;
+        }
+    }
+
+    Template t;
+    t.m_cellName = item->m_cellname;
+    t.m_location = item->m_location;
+    t.m_flipped  = item->m_flipped;
+    t.m_lefinfo  = item->m_lefinfo;
+
+    // the offset of the GDS2 position from the item
+    // position only depends on the location, flip
+    // and cell size.
+    LayoutItem origin(*item);
+    origin.m_x = 0.0;
+    origin.m_y = 0.0;
+    uint32_t rot;
+    bool flip;
+    GDS2Writer::getTransform(&origin, t.m_dx, t.m_dy, rot, flip);
+
+    // 4 + 4 + name + 6 + 12 + 12 + 4 bytes at most
+    t.m_bytes.resize(t.m_cellName.size() + 48);
+    uint8_t *end = GDS2Writer::encodeSREF(&t.m_bytes[0], t.m_cellName, rot, flip, 0.0, 0.0);
+    t.m_bytes.resize(end - &t.m_bytes[0]);
+    m_templates.push_back(std::move(t));
+
+    m_last = &m_templates.back();
+    return m_last;
+}
+
+size_t GDS2Templates::getCellSize(const LayoutItem *item)
+{
+    return getTemplate(item)->m_bytes.size();
+}
+
+uint8_t* GDS2Templates::encodeCell(uint8_t *p, const LayoutItem *item)
+{
+    const Template *t = getTemplate(item);
+    size_t bytes = t->m_bytes.size();
+    memcpy(p, &t->m_bytes[0], bytes);
+
+    // the XY payload is followed by the 4-byte ENDEL record.
+    // the position is computed the same way as in GDS2Writer.
+    double px = item->m_x + t->m_dx;
+    double py = item->m_y + t->m_dy;
+    uint8_t *xy = p + bytes - 12;
+    xy = GDS2Writer::put32(xy, static_cast<uint32_t>(px*1000.0));
+    GDS2Writer::put32(xy, static_cast<uint32_t>(py*1000.0));
+    return p + bytes;
+}
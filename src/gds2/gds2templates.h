@@ -0,0 +1,85 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef gds2templates_h
+#define gds2templates_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+
+#include "../layout.h"
+
+/** Cache of pre-encoded GDS2 SREF elements.
+
+    A padring only uses a handful of distinct combinations
+    of cell, rotation and flip. The complete SREF element
+    of each combination of cell, location and flip is 
+    encoded once, together with the offset of the GDS2
+    position. For every instance the template is copied 
+    and only the XY payload is patched.
+
+    The cache is not thread-safe; every thread needs
+    its own instance.
+*/
+class GDS2Templates
+{
+public:
+    GDS2Templates() : m_last(nullptr) {}
+
+    /** get the number of bytes of the SREF element of a cell */
+    size_t getCellSize(const LayoutItem *item);
+
+    /** encode the SREF element of a cell and return 
+        the position after it. */
+    uint8_t* encodeCell(uint8_t *p, const LayoutItem *item);
+
+    /** number of templates in the cache */
+    size_t getTemplateCount() const 
+    {
+        return m_templates.size();
+    }
+
+protected:
+    struct Template
+    {
+        std::string m_cellName;
+        std::string m_location;
+        bool        m_flipped;
+        const PRLEFReader::LEFCellInfo_t *m_lefinfo;
+        double      m_dx;               ///< x offset of the GDS2 position in microns
+        double      m_dy;               ///< y offset of the GDS2 position in microns
+        std::vector<uint8_t> m_bytes;   ///< encoded SREF element at (0,0)
+    };
+
+    static bool isMatch(const Template &t, const LayoutItem *item)
+    {
+        return (t.m_lefinfo == item->m_lefinfo) && (t.m_flipped == item->m_flipped) &&
+            (t.m_location == item->m_location) && (t.m_cellName == item->m_cellname);
+    }
+
+    /** get the template of an item, encoding it if it does not exist */
+    const Template* getTemplate(const LayoutItem *item);
+
+    std::deque<Template> m_templates;   ///< deque, so pointers stay valid
+    const Template *m_last;     ///< last template used
+};
+
+#endif
@@ -0,0 +1,103 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+#include "../logging.h"
+#include "gds2writer.h"
+#include "gds2verifier.h"
+
+void GDS2Verifier::writeCell(const LayoutItem *item)
+{
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    // same rounding as GDS2Writer
+    double px, py;
+    GDS2Reader::Placement p;
+    GDS2Writer::getTransform(item, px, py, p.m_rot, p.m_flip);
+    p.m_cellName = item->m_cellname;
+    p.m_x = static_cast<int32_t>(static_cast<uint32_t>(px*1000.0));
+    p.m_y = static_cast<int32_t>(static_cast<uint32_t>(py*1000.0));
+    m_expected.push_back(p);
+    m_cellNames.insert(item->m_cellname);
+}
+
+static std::string toString(const GDS2Reader::Placement &p)
+{
+    return p.m_cellName + " at (" + std::to_string(p.m_x) + "," + std::to_string(p.m_y) + 
+        ") rotation " + std::to_string(p.m_rot) + (p.m_flip ? " flipped" : "");
+}
+
+bool GDS2Verifier::verify(const std::string &filename, const std::string &topName)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<GDS2Reader> reader(GDS2Reader::open(filename));
+    if (!reader)
+    {
+        doLog(LOG_ERROR, "Cannot read GDS2 file %s for verification\n", filename.c_str());
+        return false;
+    }
+
+    std::vector<GDS2Reader::Structure> structures;
+    std::vector<GDS2Reader::Placement> found;
+    if (!reader->readStructures(structures) || 
+        !GDS2Reader::flatten(structures, topName, m_cellNames, found))
+    {
+        doLog(LOG_ERROR, "Cannot decode GDS2 file %s\n", filename.c_str());
+        return false;
+    }
+
+    std::sort(m_expected.begin(), m_expected.end());
+    std::sort(found.begin(), found.end());
+
+    std::vector<GDS2Reader::Placement> missing;
+    std::vector<GDS2Reader::Placement> extra;
+    std::set_difference(m_expected.begin(), m_expected.end(), found.begin(), found.end(), 
+        std::back_inserter(missing));
+    std::set_difference(found.begin(), found.end(), m_expected.begin(), m_expected.end(), 
+        std::back_inserter(extra));
+
+    const size_t maxReports = 10;
+    for(size_t i=0; i<std::min(maxReports, missing.size()); i++)
+    {
+        doLog(LOG_ERROR, "GDS2 verify: missing %s\n", toString(missing[i]).c_str());
+    }
+    for(size_t i=0; i<std::min(maxReports, extra.size()); i++)
+    {
+        doLog(LOG_ERROR, "GDS2 verify: unexpected %s\n", toString(extra[i]).c_str());
+    }
+
+    if (!missing.empty() || !extra.empty())
+    {
+        doLog(LOG_ERROR, "GDS2 verify failed: %zu missing and %zu unexpected instances\n", 
+            missing.size(), extra.size());
+        return false;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    doLog(LOG_INFO, "GDS2 verify: %zu instances OK (%zu bytes in %f s)\n", 
+        found.size(), reader->getSize(), elapsed.count());
+    return true;
+}
@@ -0,0 +1,57 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef gds2verifier_h
+#define gds2verifier_h
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+#include "../outputsink.h"
+#include "gds2reader.h"
+
+/** Checks a written GDS2 file against the layout.
+
+    The verifier is an output sink: it receives the same
+    placement records as the GDS2 writer and converts them
+    to the expected placements in database units. After 
+    the file has been written, verify() reads it back, 
+    flattens the hierarchy and arrays and checks that it 
+    holds exactly the expected instances.
+*/
+class GDS2Verifier : public OutputSink
+{
+public:
+    GDS2Verifier() {}
+
+    void writeCell(const LayoutItem *item) override;
+
+    /** read the GDS2 file and compare it to the placement
+        records. returns false if the file cannot be read 
+        or does not match.
+    */
+    bool verify(const std::string &filename, const std::string &topName);
+
+protected:
+    std::vector<GDS2Reader::Placement> m_expected;
+    std::unordered_set<std::string>     m_cellNames;
+};
+
+#endif
@@ -19,6 +19,7 @@
 
 #include "../logging.h"
 #include "gds2writer.h"
+#include "gds2templates.h"
 
 GDS2Writer* GDS2Writer::open(const std::string &filename, const std::string &designName)
 {
@@ -32,7 +33,12 @@ GDS2Writer* GDS2Writer::open(const std::string &filename, const std::string &des
 }
 
 GDS2Writer::GDS2Writer(FILE *f, const std::string &designName) 
-    : m_fout(f), m_designName(designName)
+    : m_fout(f), 
+      m_useAREF(true),
+      m_buffer(1024*1024), 
+      m_bufferPos(0), 
+      m_writeOK(true),
+      m_designName(designName)
 {   
     doLog(LOG_VERBOSE,"GDS2Writer created\n");
     writeHeader();
@@ -40,198 +46,137 @@ GDS2Writer::GDS2Writer(FILE *f, const std::string &designName)
 
 GDS2Writer::~GDS2Writer()
 {
-    writeEpilog();
-    fclose(m_fout);
+    if (m_fout != nullptr)
+    {
+        fclose(m_fout);
+    }
     doLog(LOG_VERBOSE,"GDS2Writer destroyed\n");
 }
 
-inline void endian_swap(uint16_t &x)
+bool GDS2Writer::close()
 {
-    x = (x>>8) | 
-        (x<<8);
-}
+    if (m_fout == nullptr)
+    {
+        return true;
+    }
 
-inline void endian_swap(int16_t &x)
-{
-    uint16_t y = static_cast<uint16_t>(x);
-    x = static_cast<uint16_t>((y>>8) | (y<<8));
-}
+    flushRun();
+    writeEpilog();
+    flush();
 
-inline void endian_swap(uint32_t &x)
-{
-    x = (x>>24) | 
-        ((x<<8) & 0x00FF0000) |
-        ((x>>8) & 0x0000FF00) |
-        (x<<24);
+    bool ok = m_writeOK;
+    if (fclose(m_fout) != 0)
+    {
+        ok = false;
+    }
+    m_fout = nullptr;
+    return ok;
 }
 
-inline void endian_swap(int32_t &x)
+void GDS2Writer::flush()
 {
-    uint32_t y = static_cast<uint16_t>(x);
-    x = static_cast<uint32_t>((y>>24) | 
-        ((y<<8) & 0x00FF0000) |
-        ((y>>8) & 0x0000FF00) |
-        (y<<24));
+    if (m_bufferPos > 0)
+    {
+        if (fwrite(&m_buffer[0], 1, m_bufferPos, m_fout) != m_bufferPos)
+        {
+            m_writeOK = false;
+        }
+        m_bufferPos = 0;
+    }
 }
 
-inline void endian_swap(uint64_t &x)
+size_t GDS2Writer::getHeaderSize(const std::string &designName)
 {
-    x = (x>>56) | 
-        ((x<<40) & 0x00FF000000000000) |
-        ((x<<24) & 0x0000FF0000000000) |
-        ((x<<8)  & 0x000000FF00000000) |
-        ((x>>8)  & 0x00000000FF000000) |
-        ((x>>24) & 0x0000000000FF0000) |
-        ((x>>40) & 0x000000000000FF00) |
-        (x<<56);
+    return c_libHeaderSize + getBeginStructureSize(designName);
 }
 
-void GDS2Writer::writeUint32(uint32_t v)
+uint8_t* GDS2Writer::encodeHeader(uint8_t *p, const std::string &designName)
 {
-    endian_swap(v);
-    fwrite(&v, sizeof(v), 1, m_fout);
+    p = encodeLibHeader(p);
+    return encodeBeginStructure(p, designName);
 }
 
-void GDS2Writer::writeUint16(uint16_t v)
+uint8_t* GDS2Writer::encodeLibHeader(uint8_t *p)
 {
-    endian_swap(v);
-    fwrite(&v, sizeof(v), 1, m_fout);
-}
+    // HEADER record, version 3
+    p = putRecord(p, 0x0006, 0x0002);
+    p = put16(p, 0x0003);
 
-void GDS2Writer::writeUint8(uint8_t v)
-{
-    fwrite(&v, sizeof(v), 1, m_fout);
-}
+    // BGNLIB, with zero modification and access times
+    p = putRecord(p, 0x001C, 0x0102);
+    for(uint32_t i=0; i<12; i++)
+    {
+        p = put16(p, 0x0000);
+    }
 
-void GDS2Writer::writeInt32(uint32_t v)
-{
-    endian_swap(v);
-    fwrite(&v, sizeof(v), 1, m_fout);
+    // LIBNAME
+    p = putRecord(p, 0x0012, 0x0206);
+    for(uint32_t i=0; i<7; i++)
+    {
+        p = put16(p, 0x4141);
+    }
+
+    // UNITS, two 8-byte reals
+    p = putRecord(p, 0x0014, 0x0305);
+    p = put32(p, 0x3E418937);
+    p = put32(p, 0x4BC6A7EF);
+    p = put32(p, 0x3944B82F);
+    p = put32(p, 0xA09B5A54);
+    return p;
 }
 
-void GDS2Writer::writeInt16(uint16_t v)
+size_t GDS2Writer::getBeginStructureSize(const std::string &name)
 {
-    endian_swap(v);
-    fwrite(&v, sizeof(v), 1, m_fout);
+    return 0x1C + 4 + name.size() + (name.size() % 2);
 }
 
-void GDS2Writer::writeFloat32(float v)
+uint8_t* GDS2Writer::encodeBeginStructure(uint8_t *p, const std::string &name)
 {
-    uint32_t *ptr = reinterpret_cast<uint32_t*>(&v);
-    endian_swap(*ptr);
-    fwrite(ptr, sizeof(v), 1, m_fout);
+    // BGNSTR
+    p = putRecord(p, 0x001C, 0x0502);
+    for(uint32_t i=0; i<12; i++)
+    {
+        p = put16(p, 0x0000);
+    }
+
+    // STRNAME
+    uint32_t bytes = name.size() + (name.size() % 2);
+    p = putRecord(p, bytes+4, 0x0606);
+    p = putString(p, name);
+    return p;
 }
 
-void GDS2Writer::writeFloat64(double v)
+uint8_t* GDS2Writer::encodeEndStructure(uint8_t *p)
 {
-    uint64_t *ptr = reinterpret_cast<uint64_t*>(&v);
-    endian_swap(*ptr);
-    fwrite(ptr, sizeof(v), 1, m_fout);
+    return putRecord(p, 0x0004, 0x0700);   // ENDSTR
 }
 
-uint32_t GDS2Writer::writeString(const std::string &str)
+uint8_t* GDS2Writer::encodeEpilog(uint8_t *p)
 {
-    uint32_t bytes = str.size();
-    for(auto c : str)
-    {
-        fputc(c, m_fout);
-    }
-    if ((str.size() % 2) == 1)
-    {
-        fputc(0, m_fout);
-        bytes++;
-    }
-    return bytes;
+    p = encodeEndStructure(p);
+    p = putRecord(p, 0x0004, 0x0400);   // ENDLIB
+    return p;
 }
 
 void GDS2Writer::writeHeader()
 {
-    // HEADER record
-    writeUint16(0x0006);    // Len = 6 bytes
-    writeUint16(0x0002);    // HEADER id
-    writeUint16(0x0003);    // version 3?
-
-    // BGNLIB
-    writeUint16(0x001C);    // Len
-    writeUint16(0x0102);    // BGNLIB id
-    writeUint16(0x0000);    // year (last modified)
-    writeUint16(0x0000);    // month
-    writeUint16(0x0000);    // day
-    writeUint16(0x0000);    // hour
-    writeUint16(0x0000);    // minute
-    writeUint16(0x0000);    // second
-    writeUint16(0x0000);    // year (last accessed)
-    writeUint16(0x0000);    // month
-    writeUint16(0x0000);    // day
-    writeUint16(0x0000);    // hour
-    writeUint16(0x0000);    // minute
-    writeUint16(0x0000);    // second    
-
-    // LIBNAME
-    writeUint16(0x0012);    // Len 18
-    writeUint16(0x0206);    // LIBNAME id
-    writeUint16(0x4141);
-    writeUint16(0x4141);
-    writeUint16(0x4141);
-    writeUint16(0x4141);
-    writeUint16(0x4141);
-    writeUint16(0x4141);
-    writeUint16(0x4141);
-
-    // UNITS
-    writeUint16(0x0014);     // two 8-byte real
-    writeUint16(0x0305);    // UNITS id
-    writeUint32(0x3E418937);
-    writeUint32(0x4BC6A7EF);    
-    writeUint32(0x3944B82F);
-    writeUint32(0xA09B5A54);    
-    
-    // BGNSTR
-    writeUint16(0x001C);    // Len
-    writeUint16(0x0502);    // BGNSTR id
-    writeUint16(0x0000);    // year (last modified)
-    writeUint16(0x0000);    // month
-    writeUint16(0x0000);    // day
-    writeUint16(0x0000);    // hour
-    writeUint16(0x0000);    // minute
-    writeUint16(0x0000);    // second
-    writeUint16(0x0000);    // year (last accessed)
-    writeUint16(0x0000);    // month
-    writeUint16(0x0000);    // day
-    writeUint16(0x0000);    // hour
-    writeUint16(0x0000);    // minute
-    writeUint16(0x0000);    // second
-
-    // STRNAME 
-    uint32_t bytes = m_designName.size() + (m_designName.size() % 2);
-    writeUint16(bytes+4);   // Len
-    writeUint16(0x0606);    // STRNAME id
-    writeString(m_designName);
+    size_t bytes = getHeaderSize(m_designName);
+    encodeHeader(reserveBytes(bytes), m_designName);
+    commitBytes(bytes);
 }
 
 void GDS2Writer::writeEpilog()
 {
-    // ENDSTR
-    writeUint16(0x0004);    // Len = 4
-    writeUint16(0x0700);    // ENDSTR id
-
-    // ENDLIB
-    writeUint16(0x0004);    // Len = 4
-    writeUint16(0x0400);    // ENDLIB id
+    encodeEpilog(reserveBytes(c_epilogSize));
+    commitBytes(c_epilogSize);
 }
 
-
-void GDS2Writer::writeCell(const LayoutItem *item)
+void GDS2Writer::getTransform(const LayoutItem *item, double &px, double &py, uint32_t &rot, bool &flip)
 {
-    if (item == nullptr)
-    {
-        return;
-    }
-
-    double px = item->m_x;      // x-position in microns
-    double py = item->m_y;      // y-position in microns
-    uint32_t rot = 0;           // rotation in degrees
-    bool     flip = false;      // true if cell is to be flipped (GDS2 flipping style!)
+    px = item->m_x;
+    py = item->m_y;
+    rot = 0;
+    flip = false;
 
     // process regular cells that have N,S,E,W
     // locations
@@ -308,189 +253,225 @@ void GDS2Writer::writeCell(const LayoutItem *item)
     {
         // nothing.
     }
+}
 
-    // SREF
-    writeUint16(0x0004);    // Len
-    writeUint16(0x0A00);    // SREF id
+size_t GDS2Writer::getCellSize(const LayoutItem *item)
+{
+    double px, py;
+    uint32_t rot;
+    bool flip;
+    getTransform(item, px, py, rot, flip);
+    return getSREFSize(item->m_cellname, rot);
+}
+
+uint8_t* GDS2Writer::encodeCell(uint8_t *p, const LayoutItem *item)
+{
+    double px;          // x-position in microns
+    double py;          // y-position in microns
+    uint32_t rot;       // rotation in degrees
+    bool flip;          // true if cell is to be flipped (GDS2 flipping style!)
+    getTransform(item, px, py, rot, flip);
+
+    return encodeSREF(p, item->m_cellname, rot, flip, px, py);
+}
+
+uint8_t* GDS2Writer::encodeTransform(uint8_t *p, const std::string &cellName, uint32_t rot, bool flip)
+{
+    uint32_t nameBytes = cellName.size() + (cellName.size() % 2);
 
     // SNAME
-    uint32_t bytes = item->m_cellname.size() + (item->m_cellname.size() % 2);
-    writeUint16(bytes+4);   // Len
-    writeUint16(0x1206);    // SNAME
-    writeString(item->m_cellname);
+    p = putRecord(p, nameBytes+4, 0x1206);
+    p = putString(p, cellName);
 
-    // check for FLIP
-    if (flip)
-    {
-        writeUint16(0x0006);
-        writeUint16(0x1A01);    // write STRANS
-        writeUint16(0x8000);     
-    }
-    else
-    {
-        writeUint16(0x0006);
-        writeUint16(0x1A01);    // write STRANS
-        writeUint16(0x0000);
-    }
+    // STRANS, with the reflection bit for FLIP
+    p = putRecord(p, 0x0006, 0x1A01);
+    p = put16(p, flip ? 0x8000 : 0x0000);
 
-    // ANGLE
+    // ANGLE as an 8-byte GDS2 real
     if (rot != 0)
     {
-        writeUint16(4+8);
-        writeUint16(0x1C05);    // ANGLE id
+        p = putRecord(p, 4+8, 0x1C05);
         switch(rot)
         {
         case 90:
-            writeUint8(2+64);       // exponent
-            writeUint32(0x5A000000);// mantissa
-            writeUint8(0);
-            writeUint8(0);
-            writeUint8(0);    
+            *p++ = 2+64;                // exponent
+            p = put32(p, 0x5A000000);   // mantissa
             break;
         case 180:
-            writeUint8(2+64);       // exponent
-            writeUint32(0xB4000000);// mantissa
-            writeUint8(0);
-            writeUint8(0);
-            writeUint8(0);    
+            *p++ = 2+64;                // exponent
+            p = put32(p, 0xB4000000);   // mantissa
             break;
         case 270:
-            writeUint8(3+64);       // exponent
-            writeUint32(0x10E00000);// mantissa
-            writeUint8(0);
-            writeUint8(0);
-            writeUint8(0);    
+            *p++ = 3+64;                // exponent
+            p = put32(p, 0x10E00000);   // mantissa
             break;
         default:
-            writeUint8(64);         // exponent
-            writeUint32(0x00000000);// mantissa
-            writeUint8(0);
-            writeUint8(0);
-            writeUint8(0);          
+            *p++ = 64;                  // exponent
+            p = put32(p, 0x00000000);   // mantissa
         }
+        *p++ = 0;
+        *p++ = 0;
+        *p++ = 0;
     }
+    return p;
+}
+
+uint8_t* GDS2Writer::encodeSREF(uint8_t *p, const std::string &cellName, 
+    uint32_t rot, bool flip, double px, double py)
+{
+    return encodeSREF(p, cellName, rot, flip, 
+        static_cast<uint32_t>(px*1000.0), 
+        static_cast<uint32_t>(py*1000.0));
+}
+
+uint8_t* GDS2Writer::encodeSREF(uint8_t *p, const std::string &cellName, 
+    uint32_t rot, bool flip, uint32_t x, uint32_t y)
+{
+    // SREF
+    p = putRecord(p, 0x0004, 0x0A00);
+
+    p = encodeTransform(p, cellName, rot, flip);
 
     // XY
-    writeUint16(4+8);
-    writeUint16(0x1003);    // XY id
-    writeInt32(px*1000.0);
-    writeInt32(py*1000.0);
+    p = putRecord(p, 4+8, 0x1003);
+    p = put32(p, x);
+    p = put32(p, y);
 
     // ENDEL
-    writeUint16(4);         // Len
-    writeUint16(0x1100);    // ENDEL id
+    p = putRecord(p, 4, 0x1100);
 
+    return p;
 }
 
+bool GDS2Writer::isRunContinuation(const LayoutItem *prev, const LayoutItem *item)
+{
+    if ((prev->m_ltype != LayoutItem::TYPE_FILLER) || (item->m_ltype != LayoutItem::TYPE_FILLER))
+    {
+        return false;
+    }
+
+    if ((prev->m_lefinfo != item->m_lefinfo) || (prev->m_flipped != item->m_flipped) ||
+        (prev->m_size != item->m_size) || (prev->m_location != item->m_location) ||
+        (prev->m_cellname != item->m_cellname))
+    {
+        return false;
+    }
+
+    if ((item->m_location == "N") || (item->m_location == "S"))
+    {
+        return (item->m_y == prev->m_y) && (item->m_x == (prev->m_x + prev->m_size));
+    }
+    return (item->m_x == prev->m_x) && (item->m_y == (prev->m_y + prev->m_size));
+}
 
-#if 0
-void GDS2Writer::writeCell(const std::string &cellName, int32_t x, int32_t y, orientation_t orientation, bool flip)
+size_t GDS2Writer::getFillerRun(const LayoutItem *items, size_t count)
 {
-    // SREF
-    writeUint16(0x0004);    // Len
-    writeUint16(0x0A00);    // SREF id
+    size_t run = 1;
+    while((run < count) && (run < c_maxColumns) && isRunContinuation(&items[run-1], &items[run]))
+    {
+        run++;
+    }
+    return run;
+}
 
-    // SNAME
-    uint32_t bytes = cellName.size() + (cellName.size() % 2);
-    writeUint16(bytes+4);   // Len
-    writeUint16(0x1206);    // SNAME
-    writeString(cellName);
+size_t GDS2Writer::getArraySize(const LayoutItem *first)
+{
+    // an SREF plus the COLROW record and two more points
+    return getCellSize(first) + 8 + 16;
+}
 
-    // STRANS
-    //writeUint16(6);
-    //writeUint16(0x1A01);    // STRANS id
-    //writeInt32(x);
-    //writeInt32(y);
+uint8_t* GDS2Writer::encodeArray(uint8_t *p, const LayoutItem *first, size_t columns)
+{
+    double px;
+    double py;
+    uint32_t rot;
+    bool flip;
+    getTransform(first, px, py, rot, flip);
+
+    // columns run along the edge, the single row
+    // is perpendicular to it.
+    double pitch = first->m_size;
+    double colx = pitch;
+    double coly = 0.0;
+    if ((first->m_location != "N") && (first->m_location != "S"))
+    {
+        colx = 0.0;
+        coly = pitch;
+    }
 
-/*
+    // AREF
+    p = putRecord(p, 0x0004, 0x0B00);
 
-    7-bit exponent = + 64
-    mantissa*16^exponent
+    p = encodeTransform(p, first->m_cellname, rot, flip);
 
-    mantissa is always >=1/16 and <1
+    // COLROW
+    p = putRecord(p, 4+4, 0x1302);
+    p = put16(p, static_cast<uint16_t>(columns));
+    p = put16(p, 1);
 
-    exp = floor(log(v)/log(16))
-    mant = 1e-3 / 16^exp
+    // XY: the origin, the origin displaced by all 
+    // the columns and by the single row.
+    p = putRecord(p, 4+24, 0x1003);
+    p = put32(p, static_cast<uint32_t>(px*1000.0));
+    p = put32(p, static_cast<uint32_t>(py*1000.0));
+    p = put32(p, static_cast<uint32_t>((px + columns*colx)*1000.0));
+    p = put32(p, static_cast<uint32_t>((py + columns*coly)*1000.0));
+    p = put32(p, static_cast<uint32_t>((px + coly)*1000.0));
+    p = put32(p, static_cast<uint32_t>((py + colx)*1000.0));
 
-    90 -> exp = 2, mantissa = 5A000000
-    180 -> exp = 2, mantissa = B4000000
-    270 -> exp = 3, mantissa = 10E00000
-*/
+    // ENDEL
+    p = putRecord(p, 4, 0x1100);
 
-    // check for FLIP
-    if (flip)
+    return p;
+}
+
+void GDS2Writer::flushRun()
+{
+    if (m_run.size() == 1)
     {
-        writeUint16(0x0006);
-        writeUint16(0x1A01);    // write STRANS
-        writeUint16(0x8000);
-        switch(orientation)
-        {
-        case ROT0:
-            orientation = ROT180;
-            break;
-        case ROT90:
-            orientation = ROT270;
-            break;
-        case ROT180:
-            orientation = ROT0;
-            break; 
-        case ROT270:
-            orientation = ROT90;
-            break;            
-        }
+        uint8_t *start = reserveBytes(m_templates.getCellSize(&m_run[0]));
+        commitBytes(m_templates.encodeCell(start, &m_run[0]) - start);
     }
-    else
+    else if (m_run.size() > 1)
+    {
+        uint8_t *start = reserveBytes(getArraySize(&m_run[0]));
+        commitBytes(encodeArray(start, &m_run[0], m_run.size()) - start);
+    }
+    m_run.clear();
+}
+
+void GDS2Writer::writeBlock(const std::shared_ptr<const PlacementBlock> &block)
+{
+    flushRun();
+    for(auto const &item : *block)
+    {
+        writeCell(&item);
+    }
+    flushRun();
+}
+
+void GDS2Writer::writeCell(const LayoutItem *item)
+{
+    if (item == nullptr)
     {
-        writeUint16(0x0006);
-        writeUint16(0x1A01);    // write STRANS
-        writeUint16(0x0000);
+        return;
     }
 
-    // ANGLE
-    if (orientation != ROT0)
+    if (m_useAREF)
     {
-        writeUint16(4+8);
-        writeUint16(0x1C05);    // ANGLE id
-        switch(orientation)
+        // collect runs of fillers
+        if (!m_run.empty() && ((m_run.size() == c_maxColumns) || !isRunContinuation(&m_run.back(), item)))
         {
-        case ROT90:
-            writeUint8(2+64);       // exponent
-            writeUint32(0x5A000000);// mantissa
-            writeUint8(0);
-            writeUint8(0);
-            writeUint8(0);    
-            break;
-        case ROT180:
-            writeUint8(2+64);       // exponent
-            writeUint32(0xB4000000);// mantissa
-            writeUint8(0);
-            writeUint8(0);
-            writeUint8(0);    
-            break;
-        case ROT270:
-            writeUint8(3+64);       // exponent
-            writeUint32(0x10E00000);// mantissa
-            writeUint8(0);
-            writeUint8(0);
-            writeUint8(0);    
-            break;
-        default:
-            writeUint8(64);         // exponent
-            writeUint32(0x00000000);// mantissa
-            writeUint8(0);
-            writeUint8(0);
-            writeUint8(0);          
+            flushRun();
         }
-    }
 
-    // XY
-    writeUint16(4+8);
-    writeUint16(0x1003);    // XY id
-    writeInt32(x);
-    writeInt32(y);
+        if (item->m_ltype == LayoutItem::TYPE_FILLER)
+        {
+            m_run.push_back(*item);
+            return;
+        }
+    }
 
-    // ENDEL
-    writeUint16(4);         // Len
-    writeUint16(0x1100);    // ENDEL id
+    uint8_t *start = reserveBytes(m_templates.getCellSize(item));
+    commitBytes(m_templates.encodeCell(start, item) - start);
 }
-#endif
\ No newline at end of file
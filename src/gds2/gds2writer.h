@@ -23,44 +23,205 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 #include "../layout.h"
+#include "../outputsink.h"
+#include "gds2templates.h"
 
-class GDS2Writer
+class GDS2Writer : public OutputSink
 {
 public:
     static GDS2Writer* open(
         const std::string &filename,
         const std::string &designName);
 
+    /** closes the file, if the writer was not closed */
     virtual ~GDS2Writer();
 
+    /** writes the epilog and closes the file.
+        returns false on an I/O error. */
+    bool close() override;
+
     /** Write a structural reference (SREF) to the GDS2
         that places a cell.
     */
-    void writeCell(const LayoutItem *item);
+    void writeCell(const LayoutItem *item) override;
+
+    /** Write a block of placement records. Runs of 
+        fillers do not extend beyond the block.
+    */
+    void writeBlock(const std::shared_ptr<const PlacementBlock> &block) override;
+
+    /** when enabled, runs of identical fillers at a uniform 
+        pitch are written as a single array reference (AREF)
+        instead of one SREF per filler.
+    */
+    void setUseAREF(bool useAREF)
+    {
+        flushRun();
+        m_useAREF = useAREF;
+    }
+
+    /** get the number of bytes of the GDS2 records
+        written before the cells.
+    */
+    static size_t getHeaderSize(const std::string &designName);
+
+    /** encode the GDS2 records written before the cells
+        and return the position after them. */
+    static uint8_t* encodeHeader(uint8_t *p, const std::string &designName);
+
+    /** encode the GDS2 records written after the cells
+        and return the position after them. */
+    static uint8_t* encodeEpilog(uint8_t *p);
+
+    /** encode the HEADER, BGNLIB, LIBNAME and UNITS records */
+    static uint8_t* encodeLibHeader(uint8_t *p);
+
+    /** get the number of bytes of the BGNSTR and STRNAME records */
+    static size_t getBeginStructureSize(const std::string &name);
+
+    /** encode the BGNSTR and STRNAME records of a structure */
+    static uint8_t* encodeBeginStructure(uint8_t *p, const std::string &name);
+
+    /** encode the ENDSTR record */
+    static uint8_t* encodeEndStructure(uint8_t *p);
+
+    /** get the number of bytes of the SREF element of a cell */
+    static size_t getCellSize(const LayoutItem *item);
+
+    /** encode the SREF element of a cell and return 
+        the position after it. */
+    static uint8_t* encodeCell(uint8_t *p, const LayoutItem *item);
+
+    /** encode an SREF element and return the position after it.
+        px and py are in microns, rot in degrees. */
+    static uint8_t* encodeSREF(uint8_t *p, const std::string &cellName, 
+        uint32_t rot, bool flip, double px, double py);
+
+    /** encode an SREF element with the position in 
+        database units. */
+    static uint8_t* encodeSREF(uint8_t *p, const std::string &cellName, 
+        uint32_t rot, bool flip, uint32_t x, uint32_t y);
+
+    /** get the number of bytes of an SREF element */
+    static size_t getSREFSize(const std::string &cellName, uint32_t rot)
+    {
+        uint32_t nameBytes = cellName.size() + (cellName.size() % 2);
+        return 4 + (4 + nameBytes) + 6 + ((rot != 0) ? 12 : 0) + 12 + 4;
+    }
+
+    /** check if an item continues a run of fillers:
+        the same filler cell placed directly after the
+        previous one on the same edge. */
+    static bool isRunContinuation(const LayoutItem *prev, const LayoutItem *item);
+
+    /** get the number of items at the start of the array
+        that form a run of fillers, at most c_maxColumns.
+        returns 1 if the first item does not start a run.
+    */
+    static size_t getFillerRun(const LayoutItem *items, size_t count);
+
+    /** get the number of bytes of the AREF element of a run */
+    static size_t getArraySize(const LayoutItem *first);
+
+    /** encode the AREF element of a run of fillers and
+        return the position after it. */
+    static uint8_t* encodeArray(uint8_t *p, const LayoutItem *first, size_t columns);
+
+    /** get the GDS2 position, rotation and flip of a cell */
+    static void getTransform(const LayoutItem *item, double &px, double &py, uint32_t &rot, bool &flip);
+
+    static const size_t c_epilogSize = 8;   ///< size of the ENDSTR and ENDLIB records
+    static const size_t c_libHeaderSize = 6 + 0x1C + 0x12 + 0x14; ///< size of the library header records
+    static const size_t c_maxColumns = 32767;   ///< maximum number of AREF columns
 
 protected:
+    friend class GDS2Templates;
+
     void writeHeader();
     void writeEpilog();
-    
-    void writeUint32(uint32_t v);
-    void writeUint16(uint16_t v);
-    void writeUint8(uint8_t v);
-    void writeInt32(uint32_t v);
-    void writeInt16(uint16_t v);
-    void writeFloat32(float v);
-    void writeFloat64(double v);
 
+    /** write the pending run of fillers */
+    void flushRun();
+
+    /** encode the SNAME, STRANS and ANGLE records of a reference */
+    static uint8_t* encodeTransform(uint8_t *p, const std::string &cellName, uint32_t rot, bool flip);
+
+    /** make room for the given number of bytes in the
+        output buffer, flushing it when needed, and return
+        a pointer to the write position. the caller must
+        call commitBytes() after filling the space.
+    */
+    uint8_t* reserveBytes(size_t bytes)
+    {
+        if ((m_bufferPos + bytes) > m_buffer.size())
+        {
+            flush();
+            if (bytes > m_buffer.size())
+            {
+                m_buffer.resize(bytes);
+            }
+        }
+        return &m_buffer[m_bufferPos];
+    }
+
+    void commitBytes(size_t bytes)
+    {
+        m_bufferPos += bytes;
+    }
+
+    /** write the output buffer to the file */
+    void flush();
+
+    /** big-endian encoding into the output buffer */
+    static uint8_t* put16(uint8_t *p, uint16_t v)
+    {
+        p[0] = static_cast<uint8_t>(v >> 8);
+        p[1] = static_cast<uint8_t>(v);
+        return p+2;
+    }
+
+    static uint8_t* put32(uint8_t *p, uint32_t v)
+    {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+        return p+4;
+    }
 
+    /** write a record header: length in bytes,
+        including the header, and record id */
+    static uint8_t* putRecord(uint8_t *p, uint16_t len, uint16_t id)
+    {
+        return put16(put16(p, len), id);
+    }
 
-    // returns the number of bytes written
-    uint32_t writeString(const std::string &str);
+    /** write a string, padded to an even length */
+    static uint8_t* putString(uint8_t *p, const std::string &str)
+    {
+        for(auto c : str)
+        {
+            *p++ = static_cast<uint8_t>(c);
+        }
+        if ((str.size() % 2) == 1)
+        {
+            *p++ = 0;
+        }
+        return p;
+    }
 
     GDS2Writer(FILE *f, const std::string &designName);
     
     FILE        *m_fout;        ///< GDS2 file handle
-    uint32_t    m_words;        ///< words written
+    GDS2Templates m_templates;  ///< pre-encoded SREF elements
+    bool        m_useAREF;      ///< write runs of fillers as AREF
+    std::vector<LayoutItem> m_run;  ///< pending run of fillers
+    std::vector<uint8_t> m_buffer;  ///< output buffer
+    size_t      m_bufferPos;    ///< number of bytes in the output buffer
+    bool        m_writeOK;      ///< false when a write has failed
     std::string m_designName;   ///< set the design name
 };
 
@@ -0,0 +1,238 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <string.h>
+#include <ostream>
+#include <zlib.h>
+
+#include "logging.h"
+#include "gzipwriter.h"
+
+static const size_t c_windowSize = 32768;   ///< deflate history size
+
+GzipWriter::GzipWriter(output_t output, uint32_t threads, int level, size_t chunkSize)
+    : m_output(output),
+      m_level(level),
+      m_chunkSize(chunkSize),
+      m_finished(false),
+      m_ok(true),
+      m_crc(crc32(0, Z_NULL, 0)),
+      m_inputSize(0),
+      m_pool(threads)
+{
+    m_current.reserve(m_chunkSize);
+
+    // gzip header: deflate, no flags, no time stamp, unix
+    const uint8_t header[10] = {0x1F, 0x8B, 0x08, 0, 0, 0, 0, 0, 0, 0x03};
+    m_ok = m_output(header, sizeof(header));
+}
+
+GzipWriter::~GzipWriter()
+{
+    if (!m_finished)
+    {
+        finish();
+    }
+}
+
+bool GzipWriter::isGzipFilename(const std::string &filename)
+{
+    return (filename.size() > 3) && (filename.compare(filename.size() - 3, 3, ".gz") == 0);
+}
+
+void GzipWriter::write(const uint8_t *data, size_t bytes)
+{
+    while(bytes > 0)
+    {
+        // only submit a full chunk when there is more data,
+        // so the last chunk is always submitted by finish().
+        if (m_current.size() == m_chunkSize)
+        {
+            submit(false);
+        }
+
+        size_t n = std::min(bytes, m_chunkSize - m_current.size());
+        m_current.insert(m_current.end(), data, data + n);
+        data += n;
+        bytes -= n;
+    }
+}
+
+void GzipWriter::submit(bool last)
+{
+    auto chunk = std::make_shared<Chunk>();
+    chunk->m_input.swap(m_current);
+    chunk->m_dictionary.swap(m_dictionary);
+    chunk->m_last = last;
+    chunk->m_ok = false;
+    m_inputSize += chunk->m_input.size();
+
+    // the next chunk continues with the history of this one
+    size_t history = std::min(c_windowSize, chunk->m_input.size());
+    m_dictionary.assign(chunk->m_input.end() - history, chunk->m_input.end());
+    m_current.reserve(m_chunkSize);
+
+    auto task = std::make_shared<std::packaged_task<void()> >([this, chunk]() { compress(*chunk); });
+    chunk->m_done = task->get_future();
+    m_pool.submit([task]() { (*task)(); });
+    m_pending.push_back(chunk);
+
+    // limit the amount of data in flight
+    while(m_pending.size() > 2*m_pool.getThreadCount())
+    {
+        retire();
+    }
+}
+
+void GzipWriter::compress(Chunk &chunk)
+{
+    chunk.m_crc = crc32(0, chunk.m_input.data(), chunk.m_input.size());
+
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit2(&strm, m_level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return;
+    }
+
+    if (!chunk.m_dictionary.empty())
+    {
+        deflateSetDictionary(&strm, chunk.m_dictionary.data(), chunk.m_dictionary.size());
+    }
+
+    // room for the deflated data plus the flush marker
+    chunk.m_output.resize(deflateBound(&strm, chunk.m_input.size()) + 16);
+    strm.next_in   = chunk.m_input.data();
+    strm.avail_in  = chunk.m_input.size();
+    strm.next_out  = chunk.m_output.data();
+    strm.avail_out = chunk.m_output.size();
+
+    int result = deflate(&strm, chunk.m_last ? Z_FINISH : Z_SYNC_FLUSH);
+    chunk.m_ok = chunk.m_last ? (result == Z_STREAM_END) : ((result == Z_OK) && (strm.avail_in == 0));
+    chunk.m_output.resize(strm.total_out);
+    deflateEnd(&strm);
+}
+
+void GzipWriter::retire()
+{
+    std::shared_ptr<Chunk> chunk = m_pending.front();
+    m_pending.pop_front();
+    chunk->m_done.wait();
+
+    if (!chunk->m_ok)
+    {
+        doLog(LOG_ERROR, "gzip compression failed\n");
+        m_ok = false;
+    }
+
+    if (m_ok)
+    {
+        m_ok = m_output(chunk->m_output.data(), chunk->m_output.size());
+    }
+    m_crc = crc32_combine(m_crc, chunk->m_crc, chunk->m_input.size());
+}
+
+bool GzipWriter::finish()
+{
+    if (m_finished)
+    {
+        return m_ok;
+    }
+    m_finished = true;
+
+    submit(true);
+    while(!m_pending.empty())
+    {
+        retire();
+    }
+
+    // trailer: CRC and size, little endian
+    uint8_t trailer[8];
+    for(uint32_t i=0; i<4; i++)
+    {
+        trailer[i]   = static_cast<uint8_t>(m_crc >> (8*i));
+        trailer[4+i] = static_cast<uint8_t>(m_inputSize >> (8*i));
+    }
+
+    if (m_ok)
+    {
+        m_ok = m_output(trailer, sizeof(trailer));
+    }
+    return m_ok;
+}
+
+GzipStreamBuf::GzipStreamBuf(std::ostream &os, uint32_t threads)
+    : m_os(os),
+      m_buffer(64*1024),
+      m_writer([this](const uint8_t *data, size_t bytes)
+        {
+            m_os.write(reinterpret_cast<const char*>(data), bytes);
+            return m_os.good();
+        }, threads)
+{
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+GzipStreamBuf::~GzipStreamBuf()
+{
+    finish();
+}
+
+bool GzipStreamBuf::finish()
+{
+    flushBuffer();
+    bool ok = m_writer.finish();
+    m_os.flush();
+    return ok && m_os.good();
+}
+
+void GzipStreamBuf::flushBuffer()
+{
+    m_writer.write(reinterpret_cast<const uint8_t*>(pbase()), pptr() - pbase());
+    setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+int GzipStreamBuf::overflow(int c)
+{
+    flushBuffer();
+    if (c != traits_type::eof())
+    {
+        *pptr() = static_cast<char>(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+std::streamsize GzipStreamBuf::xsputn(const char *s, std::streamsize n)
+{
+    // large writes skip the buffer
+    if (n > static_cast<std::streamsize>(m_buffer.size()))
+    {
+        flushBuffer();
+        m_writer.write(reinterpret_cast<const uint8_t*>(s), n);
+        return n;
+    }
+    return std::streambuf::xsputn(s, n);
+}
+
+int GzipStreamBuf::sync()
+{
+    flushBuffer();
+    return 0;
+}
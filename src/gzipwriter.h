@@ -0,0 +1,158 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef gzipwriter_h
+#define gzipwriter_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <future>
+#include <functional>
+#include <streambuf>
+#include <ostream>
+
+#include "threadpool.h"
+
+/** Writes a gzip stream, compressing blocks of data
+    in parallel, like pigz.
+
+    The data is cut into chunks that are deflated on a 
+    thread pool. Every chunk is primed with the last 32k
+    of the chunk before it and ends with a sync flush, so 
+    the compressed chunks can be concatenated into one
+    deflate stream. The CRCs of the chunks are combined
+    for the gzip trailer. The compressed chunks are
+    written in order, as soon as they are done.
+*/
+class GzipWriter
+{
+public:
+    /** called with the compressed data, in order. 
+        returns false on an I/O error. */
+    typedef std::function<bool(const uint8_t *data, size_t bytes)> output_t;
+
+    /** when threads is 0, the number of hardware threads is used. */
+    GzipWriter(output_t output, uint32_t threads = 0, 
+        int level = 6, size_t chunkSize = 1024*1024);
+
+    /** finishes the stream, if that was not done yet */
+    virtual ~GzipWriter();
+
+    /** compress data */
+    void write(const uint8_t *data, size_t bytes);
+
+    /** compress the remaining data and write the 
+        gzip trailer. returns false on an error. 
+    */
+    bool finish();
+
+    /** check if a filename has a .gz extension */
+    static bool isGzipFilename(const std::string &filename);
+
+protected:
+    /** a chunk of data and its compressed form */
+    struct Chunk
+    {
+        std::vector<uint8_t> m_input;
+        std::vector<uint8_t> m_dictionary;  ///< the end of the previous chunk
+        std::vector<uint8_t> m_output;
+        uint32_t             m_crc;
+        bool                 m_last;
+        bool                 m_ok;
+        std::future<void>    m_done;
+    };
+
+    /** deflate a chunk, on a worker thread */
+    void compress(Chunk &chunk);
+
+    /** submit the current chunk for compression */
+    void submit(bool last);
+
+    /** wait for the oldest chunk and write it */
+    void retire();
+
+    output_t    m_output;
+    int         m_level;
+    size_t      m_chunkSize;
+    bool        m_finished;
+    bool        m_ok;
+
+    uint32_t    m_crc;          ///< CRC of all the retired chunks
+    uint64_t    m_inputSize;    ///< total number of input bytes
+
+    std::vector<uint8_t> m_current;     ///< chunk being filled
+    std::vector<uint8_t> m_dictionary;  ///< the end of the last submitted chunk
+    std::deque<std::shared_ptr<Chunk> > m_pending;
+
+    ThreadPool  m_pool;
+};
+
+/** A stream buffer that compresses everything written 
+    to it with a GzipWriter into another stream, so the
+    std::ostream based writers can write gzip files.
+*/
+class GzipStreamBuf : public std::streambuf
+{
+public:
+    GzipStreamBuf(std::ostream &os, uint32_t threads = 0);
+
+    /** finishes the gzip stream, if that was not done yet */
+    virtual ~GzipStreamBuf();
+
+    /** compress the buffered data and write the gzip
+        trailer. returns false on an error. */
+    bool finish();
+
+protected:
+    int overflow(int c) override;
+    std::streamsize xsputn(const char *s, std::streamsize n) override;
+    int sync() override;
+
+    /** hand the buffered data to the compressor */
+    void flushBuffer();
+
+    std::ostream        &m_os;
+    std::vector<char>   m_buffer;
+    GzipWriter          m_writer;
+};
+
+/** An output stream that writes gzip compressed
+    data to another stream. */
+class GzipOStream : public std::ostream
+{
+public:
+    GzipOStream(std::ostream &os) : std::ostream(nullptr), m_buf(os)
+    {
+        rdbuf(&m_buf);
+    }
+
+    /** finish the gzip stream. returns false on an error. */
+    bool finish()
+    {
+        return m_buf.finish();
+    }
+
+protected:
+    GzipStreamBuf m_buf;
+};
+
+#endif
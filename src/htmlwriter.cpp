@@ -0,0 +1,506 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <math.h>
+#include <algorithm>
+#include <unordered_map>
+#include "logging.h"
+#include "textwriter.h"
+#include "htmlwriter.h"
+
+HTMLWriter::HTMLWriter(std::ostream &os, double width, double height)
+    : m_html(os),
+      m_width(width),
+      m_height(height),
+      m_designName("PADRING"),
+      m_unitsPerMicron(1000.0)
+{
+    // keep the coordinates within 32 bits
+    while(std::max(width, height) * m_unitsPerMicron > 1.0e9)
+    {
+        m_unitsPerMicron /= 10.0;
+    }
+}
+
+bool HTMLWriter::close()
+{
+    writeFile();
+    m_html.flush();
+    return m_html.good();
+}
+
+int32_t HTMLWriter::toUnits(double v) const
+{
+    return static_cast<int32_t>(llround(v * m_unitsPerMicron));
+}
+
+uint32_t HTMLWriter::getMaster(const std::string &cellName)
+{
+    // the number of masters is small, and cells of the 
+    // same master tend to follow each other.
+    if (!m_masters.empty() && (m_masterNames[m_masters.back()] == cellName))
+    {
+        return m_masters.back();
+    }
+
+    auto iter = std::find(m_masterNames.begin(), m_masterNames.end(), cellName);
+    if (iter != m_masterNames.end())
+    {
+        return iter - m_masterNames.begin();
+    }
+    m_masterNames.push_back(cellName);
+    return m_masterNames.size() - 1;
+}
+
+void HTMLWriter::writeCell(const LayoutItem *item)
+{
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    double x,y,w,h;
+    uint32_t orientation = getPlacedBox(item, x, y, w, h);
+
+    m_rects.push_back(toUnits(x));
+    m_rects.push_back(toUnits(y));
+    m_rects.push_back(toUnits(x + w));
+    m_rects.push_back(toUnits(y + h));
+
+    uint8_t kind = KIND_CELL;
+    if (item->m_ltype == LayoutItem::TYPE_CORNER)
+    {
+        kind = KIND_CORNER;
+    }
+    else if (item->m_ltype == LayoutItem::TYPE_FILLER)
+    {
+        kind = KIND_FILLER;
+    }
+    m_kinds.push_back(kind | (orientation << 2));
+    addSegment(&m_rects[m_rects.size()-4], kind);
+    m_masters.push_back(getMaster(item->m_cellname));
+    m_names.push_back((kind == KIND_FILLER) ? std::string() : item->m_instance);
+}
+
+void HTMLWriter::addSegment(const int32_t *rect, uint8_t kind)
+{
+    if (!m_segmentKinds.empty() && (m_segmentKinds.back() == kind))
+    {
+        int32_t *s = &m_segments[m_segments.size()-4];
+        bool sameRow    = (s[1] == rect[1]) && (s[3] == rect[3]);
+        bool sameColumn = (s[0] == rect[0]) && (s[2] == rect[2]);
+        if (sameRow && ((s[2] == rect[0]) || (s[0] == rect[2])))
+        {
+            s[0] = std::min(s[0], rect[0]);
+            s[2] = std::max(s[2], rect[2]);
+            return;
+        }
+        if (sameColumn && ((s[3] == rect[1]) || (s[1] == rect[3])))
+        {
+            s[1] = std::min(s[1], rect[1]);
+            s[3] = std::max(s[3], rect[3]);
+            return;
+        }
+    }
+
+    m_segments.insert(m_segments.end(), rect, rect + 4);
+    m_segmentKinds.push_back(kind);
+}
+
+void HTMLWriter::buildIndex(uint32_t gridSize, std::vector<uint32_t> &offsets, 
+    std::vector<uint32_t> &items) const
+{
+    double cellWidth  = std::max(m_width * m_unitsPerMicron / gridSize, 1.0);
+    double cellHeight = std::max(m_height * m_unitsPerMicron / gridSize, 1.0);
+    int32_t maxCell = gridSize - 1;
+
+    auto toCell = [maxCell](double v, double size) 
+    {
+        return std::max(0, std::min(maxCell, static_cast<int32_t>(floor(v / size))));
+    };
+
+    // count the items per grid cell, then fill
+    // in the item indices.
+    size_t count = m_kinds.size();
+    offsets.assign(gridSize*gridSize + 1, 0);
+    for(int pass=0; pass<2; pass++)
+    {
+        std::vector<uint32_t> fill;
+        if (pass == 1)
+        {
+            for(size_t i=1; i<offsets.size(); i++)
+            {
+                offsets[i] += offsets[i-1];
+            }
+            items.resize(offsets.back());
+            fill.assign(offsets.begin(), offsets.end() - 1);
+        }
+
+        for(size_t i=0; i<count; i++)
+        {
+            const int32_t *r = &m_rects[i*4];
+            int32_t gx1 = toCell(r[0], cellWidth);
+            int32_t gy1 = toCell(r[1], cellHeight);
+            int32_t gx2 = toCell(r[2], cellWidth);
+            int32_t gy2 = toCell(r[3], cellHeight);
+            for(int32_t gy=gy1; gy<=gy2; gy++)
+            {
+                for(int32_t gx=gx1; gx<=gx2; gx++)
+                {
+                    size_t cell = gy*gridSize + gx;
+                    if (pass == 0)
+                    {
+                        offsets[cell+1]++;
+                    }
+                    else
+                    {
+                        items[fill[cell]++] = i;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void HTMLWriter::writeBase64(const void *data, size_t bytes)
+{
+    static const char *c_alphabet = 
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    const uint8_t *p = static_cast<const uint8_t*>(data);
+    std::string out;
+    out.reserve((bytes + 2) / 3 * 4 + 2);
+    out += '"';
+    size_t i = 0;
+    for(; i+3 <= bytes; i += 3)
+    {
+        uint32_t v = (p[i] << 16) | (p[i+1] << 8) | p[i+2];
+        out += c_alphabet[(v >> 18) & 63];
+        out += c_alphabet[(v >> 12) & 63];
+        out += c_alphabet[(v >> 6) & 63];
+        out += c_alphabet[v & 63];
+    }
+
+    if (i < bytes)
+    {
+        uint32_t v = p[i] << 16;
+        if (i+1 < bytes)
+        {
+            v |= p[i+1] << 8;
+        }
+        out += c_alphabet[(v >> 18) & 63];
+        out += c_alphabet[(v >> 12) & 63];
+        out += (i+1 < bytes) ? c_alphabet[(v >> 6) & 63] : '=';
+        out += '=';
+    }
+    out += '"';
+    m_html << out;
+}
+
+/** the viewer: decodes the data, draws the visible part
+    of the padring and handles pan, zoom and hover. */
+static const char *c_viewerScript = R"JS(
+(function() {
+"use strict";
+function decode(s, T) {
+    const b = atob(s);
+    const u = new Uint8Array(b.length);
+    for (let i = 0; i < b.length; i++) u[i] = b.charCodeAt(i);
+    return new T(u.buffer);
+}
+const rects = decode(padring.rects, Int32Array);
+const kinds = decode(padring.kinds, Uint8Array);
+const masters = decode(padring.masters, Uint32Array);
+const offsets = decode(padring.offsets, Uint32Array);
+const index = decode(padring.index, Uint32Array);
+const segments = decode(padring.segments, Int32Array);
+const segmentKinds = decode(padring.segmentKinds, Uint8Array);
+const count = kinds.length;
+const G = padring.grid;
+const units = padring.units;
+const dieW = padring.width * units, dieH = padring.height * units;
+const cellW = Math.max(dieW / G, 1), cellH = Math.max(dieH / G, 1);
+const orientations = ["N","S","E","W","FN","FS","FE","FW"];
+// per orientation: corner of the cell origin (0/1 of width, 
+// height), direction of the cell x axis and of the cell y axis.
+const axes = [[0,0, 1,0, 0,1], [1,1, -1,0, 0,-1], [0,1, 0,-1, 1,0], [1,0, 0,1, -1,0],
+              [1,0, -1,0, 0,1], [0,1, 1,0, 0,-1], [1,1, 0,-1, -1,0], [0,0, 0,1, 1,0]];
+const fills = ["#FAAD35", "#FAAD35", "#BFE1F3"];
+const strokes = ["#F25844", "#F25844", "#179AA9"];
+const canvas = document.getElementById("view");
+const ctx = canvas.getContext("2d");
+const tip = document.getElementById("tip");
+const bar = document.getElementById("bar");
+const stamp = new Uint32Array(count);
+let frame = 0, scale = 1, ox = 0, oy = 0, pending = false;
+
+// the average size of the cells along the edges, to decide
+// when to draw the segments instead of the cells.
+let cellSize = 0;
+for (let i = 0; i < count; i++) {
+    const r = i * 4;
+    cellSize += Math.min(rects[r + 2] - rects[r], rects[r + 3] - rects[r + 1]);
+}
+cellSize /= Math.max(count, 1);
+
+function fit() {
+    const w = window.innerWidth, h = window.innerHeight;
+    scale = 0.95 * Math.min(w / dieW, h / dieH);
+    ox = (w - dieW * scale) / 2;
+    oy = (h + dieH * scale) / 2;
+    redraw();
+}
+function redraw() {
+    if (!pending) { pending = true; requestAnimationFrame(draw); }
+}
+function cellRange(v, size) {
+    return Math.max(0, Math.min(G - 1, Math.floor(v / size)));
+}
+function visible(x1, y1, x2, y2) {
+    // items in the grid cells that overlap the rectangle
+    const out = [];
+    frame++;
+    const gx1 = cellRange(x1, cellW), gx2 = cellRange(x2, cellW);
+    const gy1 = cellRange(y1, cellH), gy2 = cellRange(y2, cellH);
+    for (let gy = gy1; gy <= gy2; gy++) {
+        for (let gx = gx1; gx <= gx2; gx++) {
+            const c = gy * G + gx;
+            for (let k = offsets[c]; k < offsets[c + 1]; k++) {
+                const i = index[k];
+                if (stamp[i] === frame) continue;
+                stamp[i] = frame;
+                const r = i * 4;
+                if (rects[r] > x2 || rects[r + 2] < x1 || rects[r + 1] > y2 || rects[r + 3] < y1) continue;
+                out.push(i);
+            }
+        }
+    }
+    return out;
+}
+function draw() {
+    pending = false;
+    const dpr = window.devicePixelRatio || 1;
+    const w = window.innerWidth, h = window.innerHeight;
+    if (canvas.width !== Math.round(w * dpr) || canvas.height !== Math.round(h * dpr)) {
+        canvas.width = Math.round(w * dpr);
+        canvas.height = Math.round(h * dpr);
+        canvas.style.width = w + "px";
+        canvas.style.height = h + "px";
+    }
+    ctx.setTransform(dpr, 0, 0, dpr, 0, 0);
+    ctx.fillStyle = "#FFFFFF";
+    ctx.fillRect(0, 0, w, h);
+    ctx.strokeStyle = "#808080";
+    ctx.lineWidth = 1;
+    ctx.strokeRect(ox, oy - dieH * scale, dieW * scale, dieH * scale);
+
+    const x1 = -ox / scale, y1 = (oy - h) / scale, x2 = (w - ox) / scale, y2 = oy / scale;
+    if (cellSize * scale < 1.5) {
+        drawSegments(x1, y1, x2, y2);
+        return;
+    }
+    const items = visible(x1, y1, x2, y2);
+    for (let kind = 2; kind >= 0; kind--) {
+        ctx.beginPath();
+        let n = 0;
+        for (const i of items) {
+            if ((kinds[i] & 3) !== kind) continue;
+            const r = i * 4;
+            ctx.rect(ox + rects[r] * scale, oy - rects[r + 3] * scale,
+                Math.max((rects[r + 2] - rects[r]) * scale, 0.5),
+                Math.max((rects[r + 3] - rects[r + 1]) * scale, 0.5));
+            n++;
+        }
+        if (n === 0) continue;
+        ctx.fillStyle = fills[kind];
+        ctx.fill();
+        ctx.strokeStyle = strokes[kind];
+        ctx.lineWidth = (kind === 2) ? 0.5 : 1;
+        ctx.stroke();
+    }
+
+    // orientation markers and labels, when zoomed in
+    ctx.strokeStyle = "#F25844";
+    ctx.lineWidth = 1;
+    ctx.fillStyle = "#000000";
+    ctx.textAlign = "center";
+    ctx.textBaseline = "middle";
+    ctx.font = "11px sans-serif";
+    ctx.beginPath();
+    const labels = [];
+    for (const i of items) {
+        const r = i * 4;
+        const sw = (rects[r + 2] - rects[r]) * scale, sh = (rects[r + 3] - rects[r + 1]) * scale;
+        if (Math.min(sw, sh) < 6) continue;
+        const a = axes[kinds[i] >> 2];
+        const px = ox + (a[0] ? rects[r + 2] : rects[r]) * scale;
+        const py = oy - (a[1] ? rects[r + 3] : rects[r + 1]) * scale;
+        const len = 0.2 * (a[2] !== 0 ? sw : sh);
+        ctx.moveTo(px + a[2] * len, py - a[3] * len);
+        ctx.lineTo(px + a[4] * len, py - a[5] * len);
+        if ((kinds[i] & 3) !== 2 && sw > 60 && sh > 30) labels.push(i);
+    }
+    ctx.stroke();
+    for (const i of labels) {
+        const r = i * 4;
+        const cx = ox + (rects[r] + rects[r + 2]) * 0.5 * scale;
+        const cy = oy - (rects[r + 1] + rects[r + 3]) * 0.5 * scale;
+        ctx.fillText(padring.names[i], cx, cy - 7);
+        ctx.fillText(padring.masterNames[masters[i]], cx, cy + 7);
+    }
+    bar.textContent = padring.design + ": " + count + " instances, " + items.length + " in view";
+}
+function drawSegments(x1, y1, x2, y2) {
+    let n = 0;
+    for (let kind = 2; kind >= 0; kind--) {
+        ctx.beginPath();
+        for (let s = 0; s < segmentKinds.length; s++) {
+            const r = s * 4;
+            if (segmentKinds[s] !== kind) continue;
+            if (segments[r] > x2 || segments[r + 2] < x1 || segments[r + 1] > y2 || segments[r + 3] < y1) continue;
+            ctx.rect(ox + segments[r] * scale, oy - segments[r + 3] * scale,
+                Math.max((segments[r + 2] - segments[r]) * scale, 0.5),
+                Math.max((segments[r + 3] - segments[r + 1]) * scale, 0.5));
+            n++;
+        }
+        ctx.fillStyle = fills[kind];
+        ctx.fill();
+        ctx.strokeStyle = strokes[kind];
+        ctx.lineWidth = 0.5;
+        ctx.stroke();
+    }
+    bar.textContent = padring.design + ": " + count + " instances, " + n + " segments in view";
+}
+function pick(mx, my) {
+    const x = (mx - ox) / scale, y = (oy - my) / scale;
+    let best = -1;
+    for (const i of visible(x, y, x, y)) {
+        // prefer pads and corners over fillers
+        if (best < 0 || (kinds[best] & 3) === 2) best = i;
+    }
+    return best;
+}
+function um(v) {
+    return (v / units).toString();
+}
+let drag = null;
+canvas.addEventListener("mousedown", function(e) { drag = [e.clientX, e.clientY]; });
+window.addEventListener("mouseup", function() { drag = null; });
+canvas.addEventListener("mousemove", function(e) {
+    if (drag) {
+        ox += e.clientX - drag[0];
+        oy += e.clientY - drag[1];
+        drag = [e.clientX, e.clientY];
+        tip.style.display = "none";
+        redraw();
+        return;
+    }
+    const i = pick(e.clientX, e.clientY);
+    if (i < 0) { tip.style.display = "none"; return; }
+    const r = i * 4, kind = kinds[i] & 3;
+    tip.textContent = (kind === 2 ? "filler" : padring.names[i]) + "\n" +
+        "cell: " + padring.masterNames[masters[i]] + "\n" +
+        "at: (" + um(rects[r]) + ", " + um(rects[r + 1]) + ") " + orientations[kinds[i] >> 2] + "\n" +
+        "size: " + um(rects[r + 2] - rects[r]) + " x " + um(rects[r + 3] - rects[r + 1]);
+    tip.style.left = (e.clientX + 12) + "px";
+    tip.style.top = (e.clientY + 12) + "px";
+    tip.style.display = "block";
+});
+canvas.addEventListener("mouseleave", function() { tip.style.display = "none"; });
+canvas.addEventListener("wheel", function(e) {
+    e.preventDefault();
+    const f = Math.exp(-e.deltaY * 0.002);
+    ox = e.clientX - (e.clientX - ox) * f;
+    oy = e.clientY - (e.clientY - oy) * f;
+    scale *= f;
+    redraw();
+}, {passive: false});
+canvas.addEventListener("dblclick", fit);
+window.addEventListener("resize", redraw);
+fit();
+})();
+)JS";
+
+void HTMLWriter::writeFile()
+{
+    // roughly 8 items per grid cell, but the items
+    // are only along the edges of the die.
+    uint32_t gridSize = static_cast<uint32_t>(sqrt(m_kinds.size() / 8.0));
+    gridSize = std::max(1u, std::min(gridSize, 1024u));
+
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> items;
+    buildIndex(gridSize, offsets, items);
+
+    m_html << "<!DOCTYPE html>\n<html>\n<head>\n<meta charset=\"utf-8\">\n<title>";
+    for(char c : m_designName)
+    {
+        if (c == '<') m_html << "&lt;";
+        else if (c == '&') m_html << "&amp;";
+        else m_html << c;
+    }
+    m_html << "</title>\n<style>\n";
+    m_html << "html, body { margin: 0; height: 100%; overflow: hidden; font: 12px sans-serif; }\n";
+    m_html << "canvas { display: block; cursor: crosshair; }\n";
+    m_html << "#tip { position: absolute; display: none; pointer-events: none; white-space: pre; "
+        "background: #FFFFFF; border: 1px solid #179AA9; padding: 4px; }\n";
+    m_html << "#bar { position: absolute; left: 4px; top: 4px; background: rgba(255,255,255,0.8); padding: 2px 4px; }\n";
+    m_html << "</style>\n</head>\n<body>\n";
+    m_html << "<canvas id=\"view\"></canvas><div id=\"tip\"></div><div id=\"bar\"></div>\n";
+
+    m_html << "<script>\nconst padring = {\n";
+    m_html << "design: ";
+    m_html << TextWriter::toJSONString(m_designName, true);
+    m_html << ",\nwidth: " << m_width << ",\nheight: " << m_height;
+    m_html << ",\nunits: " << m_unitsPerMicron;
+    m_html << ",\ngrid: " << gridSize;
+    m_html << ",\nmasterNames: [";
+    for(size_t i=0; i<m_masterNames.size(); i++)
+    {
+        m_html << ((i > 0) ? "," : "");
+        m_html << TextWriter::toJSONString(m_masterNames[i], true);
+    }
+    m_html << "],\nnames: [";
+    for(size_t i=0; i<m_names.size(); i++)
+    {
+        m_html << ((i > 0) ? "," : "");
+        m_html << TextWriter::toJSONString(m_names[i], true);
+    }
+    m_html << "],\nrects: ";
+    writeBase64(m_rects.data(), m_rects.size() * sizeof(int32_t));
+    m_html << ",\nkinds: ";
+    writeBase64(m_kinds.data(), m_kinds.size());
+    m_html << ",\nmasters: ";
+    writeBase64(m_masters.data(), m_masters.size() * sizeof(uint32_t));
+    m_html << ",\noffsets: ";
+    writeBase64(offsets.data(), offsets.size() * sizeof(uint32_t));
+    m_html << ",\nindex: ";
+    writeBase64(items.data(), items.size() * sizeof(uint32_t));
+    m_html << ",\nsegments: ";
+    writeBase64(m_segments.data(), m_segments.size() * sizeof(int32_t));
+    m_html << ",\nsegmentKinds: ";
+    writeBase64(m_segmentKinds.data(), m_segmentKinds.size());
+    m_html << "\n};\n</script>\n";
+
+    m_html << "<script>" << c_viewerScript << "</script>\n";
+    m_html << "</body>\n</html>\n";
+    m_html.flush();
+
+    doLog(LOG_VERBOSE, "HTML viewer: %zu instances, %u x %u grid\n", m_kinds.size(), gridSize, gridSize);
+}
@@ -0,0 +1,105 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef htmlwriter_h
+#define htmlwriter_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "layout.h"
+#include "outputsink.h"
+
+/** Writes a self-contained HTML file with a canvas
+    based viewer for the padring.
+
+    The placements are collected as integer rectangles
+    (nanometers, unless the die is too large for that)
+    and written, together with a grid index of the die,
+    as base64 encoded typed arrays. The viewer only draws
+    the grid cells in view, shows the labels when zoomed
+    in far enough and shows the instance, cell and 
+    position of the cell under the mouse. When zoomed out
+    so far that cells are smaller than a pixel, it draws
+    segments of touching cells of the same kind instead.
+    Nothing is loaded from the network.
+*/
+class HTMLWriter : public OutputSink
+{
+public:
+    HTMLWriter(std::ostream &os, double width, double height);
+
+    void writeCell(const LayoutItem *item) override;
+
+    /** writes the HTML file. returns false on an I/O error. */
+    bool close() override;
+
+    void setDesignName(const std::string &designName)
+    {
+        m_designName = designName;
+    }
+
+protected:
+    /** cell types, as used by the viewer */
+    enum kind_t
+    {
+        KIND_CELL   = 0,
+        KIND_CORNER = 1,
+        KIND_FILLER = 2
+    };
+
+    /** return the index of a cell master, adding it if needed */
+    uint32_t getMaster(const std::string &cellName);
+
+    /** build the grid index: for every grid cell, the 
+        items that overlap it. */
+    void buildIndex(uint32_t gridSize, std::vector<uint32_t> &offsets, 
+        std::vector<uint32_t> &items) const;
+
+    /** add a cell rectangle to the segments, extending
+        the last segment when the cell touches it. */
+    void addSegment(const int32_t *rect, uint8_t kind);
+
+    void writeFile();
+
+    /** write binary data as a base64 string literal */
+    void writeBase64(const void *data, size_t bytes);
+
+    /** convert microns to integer coordinates */
+    int32_t toUnits(double v) const;
+
+    std::ostream    &m_html;
+    double          m_width;
+    double          m_height;
+    std::string     m_designName;
+    double          m_unitsPerMicron;   ///< 1000, unless the die is very large
+
+    std::vector<int32_t>    m_rects;    ///< x1,y1,x2,y2 for each item
+    std::vector<uint8_t>    m_kinds;    ///< kind | (orientation << 2)
+    std::vector<uint32_t>   m_masters;  ///< master index for each item
+    std::vector<std::string> m_names;   ///< instance names, empty for fillers
+    std::vector<std::string> m_masterNames;
+
+    std::vector<int32_t>    m_segments;     ///< x1,y1,x2,y2 of touching cells
+    std::vector<uint8_t>    m_segmentKinds;
+};
+
+#endif
@@ -23,18 +23,82 @@
 #include "layout.h"
 
 
-Layout::Layout(direction_t dir) : m_dir(dir), m_edgePos(0.0), m_insertFlexSpacer(true)
+Layout::Layout(direction_t dir) : m_insertFlexSpacer(true), m_dieSize(0.0), m_dir(dir), m_edgePos(0.0)
 {
     m_firstCorner = nullptr;
     m_lastCorner  = nullptr;
 }
 
+Layout::Layout(const Layout &other) : m_insertFlexSpacer(other.m_insertFlexSpacer),
+    m_dieSize(other.m_dieSize),
+    m_dir(other.m_dir),
+    m_edgePos(other.m_edgePos)
+{
+    for(auto c : other.m_items)
+    {
+        m_items.push_back(new LayoutItem(*c));
+    }
+
+    m_firstCorner = (other.m_firstCorner != nullptr) ? new LayoutItem(*other.m_firstCorner) : nullptr;
+    m_lastCorner  = (other.m_lastCorner != nullptr) ? new LayoutItem(*other.m_lastCorner) : nullptr;
+}
+
 Layout::~Layout()
 {
     for(auto c : m_items)
     {
         delete c;
     }
+
+    delete m_firstCorner;
+    delete m_lastCorner;
+}
+
+static void appendSignature(std::string &key, const LayoutItem *item)
+{
+    if (item == nullptr)
+    {
+        key += '-';
+        return;
+    }
+
+    // sizes and positions are compared bit for bit
+    double values[3] = {item->m_size, item->m_x, item->m_y};
+    key.append(reinterpret_cast<const char*>(values), sizeof(values));
+    key.append(reinterpret_cast<const char*>(&item->m_lefinfo), sizeof(item->m_lefinfo));
+    key += static_cast<char>(item->m_ltype);
+    key += item->m_flipped ? 'F' : 'N';
+    for(auto str : {&item->m_instance, &item->m_cellname, &item->m_location})
+    {
+        key += *str;
+        key += '\0';
+    }
+}
+
+std::string Layout::getSignature() const
+{
+    std::string key;
+    double values[2] = {m_dieSize, m_edgePos};
+    key.append(reinterpret_cast<const char*>(values), sizeof(values));
+    key += (m_dir == DIR_HORIZONTAL) ? 'H' : 'V';
+    appendSignature(key, m_firstCorner);
+    appendSignature(key, m_lastCorner);
+    for(auto item : m_items)
+    {
+        appendSignature(key, item);
+    }
+    return key;
+}
+
+void Layout::swap(Layout &other)
+{
+    std::swap(m_insertFlexSpacer, other.m_insertFlexSpacer);
+    std::swap(m_dieSize, other.m_dieSize);
+    std::swap(m_dir, other.m_dir);
+    std::swap(m_edgePos, other.m_edgePos);
+    std::swap(m_items, other.m_items);
+    std::swap(m_firstCorner, other.m_firstCorner);
+    std::swap(m_lastCorner, other.m_lastCorner);
 }
 
 double Layout::getMinSize() const
@@ -42,7 +106,9 @@ double Layout::getMinSize() const
     double total = 0.0;
     for(auto item : m_items)
     {
-        if (item->m_size >= 0)
+        // FLEXSPACE items get their size from a
+        // previous layout run, so skip them.
+        if ((item->m_ltype != LayoutItem::TYPE_FLEXSPACE) && (item->m_size >= 0))
         {
             total += item->m_size;
         }
@@ -117,6 +183,7 @@ bool Layout::doLayout()
 
     double meanFlexSpaceSize = (m_dieSize - minx) / static_cast<double>(flexSpaceItems);
     double pos = 0;
+    double newPos;
 
     // position the first corner
     if (m_firstCorner != nullptr)
@@ -126,10 +193,8 @@ bool Layout::doLayout()
         setItemEdgePos(m_firstCorner);
     }
 
-    // FIXME: make grid configurable! 
-    double grid = 1.0;
-    double newPos;
-    double error = 0.0;
+    double fixedPos = pos;      // position without any FLEXSPACE
+    uint32_t flexCount = 0;
     for(auto item : m_items)
     {
         setItemPos(item, pos);
@@ -139,20 +204,17 @@ bool Layout::doLayout()
         switch(item->m_ltype)
         {
         case LayoutItem::TYPE_FLEXSPACE:
-            newPos = pos + meanFlexSpaceSize + error;
-            newPos = std::floor(newPos / grid) * grid;  // round new position to grid
+            flexCount++;
+            newPos = getFlexSpaceEnd(fixedPos, flexCount, meanFlexSpaceSize);
             item->m_size = newPos - pos;                // set size of FLEXSPACE
             pos = newPos;
-            error += (meanFlexSpaceSize - item->m_size);
             break;
         case LayoutItem::TYPE_CELL:
-            pos += item->m_size;
-            break;
         case LayoutItem::TYPE_CORNER:
-            pos += item->m_size;
-            break;
         case LayoutItem::TYPE_FIXEDSPACE:
+        default:
             pos += item->m_size;
+            fixedPos += item->m_size;
             break;
         }
     }
@@ -167,6 +229,19 @@ bool Layout::doLayout()
     return true;
 }
 
+double Layout::getFlexSpaceEnd(double fixedPos, uint32_t flexCount, double meanFlexSpaceSize)
+{
+    // FIXME: make grid configurable! 
+    double grid = 1.0;
+
+    // the n-th FLEXSPACE ends where n mean sized 
+    // spaces would end, rounded to the grid.
+    // this spreads the rounding error over all
+    // the spaces.
+    double newPos = fixedPos + flexCount*meanFlexSpaceSize;
+    return std::floor(newPos / grid) * grid;
+}
+
 void Layout::dump()
 {
     if (m_firstCorner != nullptr)
@@ -24,6 +24,7 @@
 
 #include <string>
 #include <list>
+#include <vector>
 
 class LayoutItem
 {
@@ -38,10 +39,10 @@ public:
     };
 
     LayoutItem(LayoutItemType ltype) : m_lefinfo(nullptr),
-        m_ltype(ltype),
         m_size(-1),
         m_x(-1.0), m_y(-1.0),
-        m_flipped(false)
+        m_flipped(false),
+        m_ltype(ltype)
     {        
     }
 
@@ -72,11 +73,20 @@ public:
 
     Layout(direction_t dir);
 
+    /** make a deep copy of a layout, including its items
+        and corners. LEF information is shared. */
+    Layout(const Layout &other);
+
+    Layout& operator=(const Layout &other) = delete;
+
     virtual ~Layout();
 
     /** Set the die size in the layout direction */
     void setDieSize(double dieSize) { m_dieSize = dieSize; }
 
+    /** Get the die size in the layout direction */
+    double getDieSize() const { return m_dieSize; }
+
     /** Add a layout item.
         Inserts a FLEXSPACE item if the previously
         inserted item was a cell.
@@ -149,12 +159,67 @@ public:
         setItemEdgePos(m_lastCorner);
     }
 
+    /** get all the cells, excluding corners, in layout order */
+    std::vector<LayoutItem*> getCells() const
+    {
+        std::vector<LayoutItem*> cells;
+        for(auto item : m_items)
+        {
+            if (item->m_ltype == LayoutItem::TYPE_CELL)
+            {
+                cells.push_back(item);
+            }
+        }
+        return cells;
+    }
+
+    /** replace the cells, in layout order, with the given
+        cells. spaces stay where they are. the number of 
+        cells must not change.
+    */
+    void setCells(const std::vector<LayoutItem*> &cells)
+    {
+        size_t idx = 0;
+        for(auto &item : m_items)
+        {
+            if ((item->m_ltype == LayoutItem::TYPE_CELL) && (idx < cells.size()))
+            {
+                item = cells[idx++];
+            }
+        }
+    }
+
+    /** set the size of all the fixed spaces */
+    void setFixedSpaceSize(double space)
+    {
+        for(auto item : m_items)
+        {
+            if (item->m_ltype == LayoutItem::TYPE_FIXEDSPACE)
+            {
+                item->m_size = space;
+            }
+        }
+    }
+
     /** get the minimum size of all the items */
     double getMinSize() const;
 
-    /** perform the layout */
+    /** perform the layout.
+        the layout can be performed multiple times,
+        for instance after changing the die size.
+    */
     bool doLayout();
 
+    /** return a key that is equal for two layouts with the
+        same die size, edge position, corners and items,
+        including their sizes and positions. 
+    */
+    std::string getSignature() const;
+
+    /** exchange the items, corners and settings 
+        of two layouts */
+    void swap(Layout &other);
+
     /** dump layout */
     void dump();
 
@@ -167,6 +232,17 @@ public:
     item_iterator end() { return m_items.end(); }
 
 protected: 
+    friend class LayoutEditor;
+    friend class Snapshot;
+
+    /** get the end position of a FLEXSPACE.
+        fixedPos is the position of the FLEXSPACE when
+        all the preceding FLEXSPACE items would have zero
+        size. flexCount is the number of FLEXSPACE items
+        up to and including this one.
+    */
+    static double getFlexSpaceEnd(double fixedPos, uint32_t flexCount, double meanFlexSpaceSize);
+
     double getItemPos(const LayoutItem *item) const
     {
         if (m_dir == DIR_HORIZONTAL)
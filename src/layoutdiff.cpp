@@ -0,0 +1,424 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <math.h>
+#include <unordered_map>
+#include "logging.h"
+#include "outputsink.h"
+#include "defwriter.h"
+#include "textwriter.h"
+#include "layoutdiff.h"
+
+LayoutDiff::LayoutDiff(PadringDB &oldPadring, FillerHandler &oldFillers, 
+    PadringDB &newPadring, FillerHandler &newFillers)
+    : m_oldPadring(oldPadring),
+      m_oldFillers(oldFillers),
+      m_newPadring(newPadring),
+      m_newFillers(newFillers),
+      m_databaseUnits(0.0)
+{
+}
+
+int64_t LayoutDiff::toDBU(double v) const
+{
+    return std::llround(v * m_databaseUnits);
+}
+
+const char* LayoutDiff::getChangeName(change_t change)
+{
+    switch(change)
+    {
+    case CHANGE_ADDED:
+        return "added";
+    case CHANGE_REMOVED:
+        return "removed";
+    case CHANGE_MOVED:
+        return "moved";
+    default:
+        return "resized";
+    }
+}
+
+uint32_t LayoutDiff::getCount(change_t change) const
+{
+    uint32_t count = 0;
+    for(auto const &componentChange : m_componentChanges)
+    {
+        if (componentChange.m_change == change)
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool LayoutDiff::collect(PadringDB &padring, FillerHandler &fillers, Side &side)
+{
+    const LayoutItem *corners[4] = {
+        padring.m_north.getFirstCorner(), padring.m_north.getLastCorner(),
+        padring.m_south.getFirstCorner(), padring.m_south.getLastCorner()};
+
+    const char *locations[4] = {"N", "S", "E", "W"};
+    ::Layout *edges[4] = {&padring.m_north, &padring.m_south, &padring.m_east, &padring.m_west};
+
+    for(uint32_t e=0; e<5; e++)
+    {
+        std::vector<const LayoutItem*> items;
+        if (e == 0)
+        {
+            items.assign(corners, corners + 4);
+        }
+        else
+        {
+            items.assign(edges[e-1]->begin(), edges[e-1]->end());
+        }
+
+        for(auto item : items)
+        {
+            if ((item == nullptr) || ((item->m_ltype != LayoutItem::TYPE_CELL) && (item->m_ltype != LayoutItem::TYPE_CORNER)))
+            {
+                continue;
+            }
+
+            double x,y,w,h;
+            Component component;
+            component.m_item = item;
+            component.m_type = (item->m_ltype == LayoutItem::TYPE_CORNER) ? "corner" : "pad";
+            component.m_edge = (e == 0) ? item->m_location : std::string(locations[e-1]);
+            component.m_orientation = OutputSink::getPlacedBox(item, x, y, w, h);
+            component.m_x = toDBU(x);
+            component.m_y = toDBU(y);
+            side.m_components.push_back(component);
+        }
+    }
+
+    // the spaces between two components are one gap
+    for(uint32_t e=0; e<4; e++)
+    {
+        const LayoutItem *first = edges[e]->getFirstCorner();
+        const LayoutItem *last  = edges[e]->getLastCorner();
+
+        Gap gap;
+        gap.m_edge = locations[e];
+        gap.m_from = (first != nullptr) ? first->m_instance : "";
+        double size = 0.0;
+        for(auto item : *edges[e])
+        {
+            if (item->m_ltype == LayoutItem::TYPE_CELL)
+            {
+                if (size > 0.0)
+                {
+                    gap.m_to   = item->m_instance;
+                    gap.m_size = toDBU(size);
+                    side.m_gaps.push_back(gap);
+                }
+                gap = Gap();
+                gap.m_edge = locations[e];
+                gap.m_from = item->m_instance;
+                size = 0.0;
+            }
+            else if (((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE)) &&
+                (item->m_size > 0.0))
+            {
+                if (size <= 0.0)
+                {
+                    gap.m_x = toDBU(item->m_x);
+                    gap.m_y = toDBU(item->m_y);
+                }
+                size += item->m_size;
+                if (fillers.fillList(item->m_size, gap.m_fillers) < 0)
+                {
+                    doLog(LOG_ERROR, "Cannot find filler cell that fits remaining width %f\n", item->m_size);
+                    return false;
+                }
+            }
+        }
+
+        if (size > 0.0)
+        {
+            gap.m_to   = (last != nullptr) ? last->m_instance : "";
+            gap.m_size = toDBU(size);
+            side.m_gaps.push_back(gap);
+        }
+    }
+    return true;
+}
+
+bool LayoutDiff::compare()
+{
+    if (m_databaseUnits < 1e-12)
+    {
+        doLog(LOG_WARN, "Diff: database units not set, using 100 units per micron\n");
+        m_databaseUnits = 100.0;
+    }
+
+    m_old = Side();
+    m_new = Side();
+    m_componentChanges.clear();
+    m_gapChanges.clear();
+    if (!collect(m_oldPadring, m_oldFillers, m_old) || !collect(m_newPadring, m_newFillers, m_new))
+    {
+        return false;
+    }
+
+    // components, by instance name
+    std::unordered_map<std::string, size_t> oldComponents;
+    oldComponents.reserve(m_old.m_components.size());
+    for(size_t i=0; i<m_old.m_components.size(); i++)
+    {
+        oldComponents.emplace(m_old.m_components[i].m_item->m_instance, i);
+    }
+
+    std::vector<bool> matched(m_old.m_components.size(), false);
+    for(auto const &component : m_new.m_components)
+    {
+        auto iter = oldComponents.find(component.m_item->m_instance);
+        if (iter == oldComponents.end())
+        {
+            m_componentChanges.push_back({CHANGE_ADDED, nullptr, &component});
+            continue;
+        }
+
+        const Component &old = m_old.m_components[iter->second];
+        matched[iter->second] = true;
+        if (old.m_item->m_cellname != component.m_item->m_cellname)
+        {
+            m_componentChanges.push_back({CHANGE_REMOVED, &old, nullptr});
+            m_componentChanges.push_back({CHANGE_ADDED, nullptr, &component});
+        }
+        else if ((old.m_x != component.m_x) || (old.m_y != component.m_y) || 
+            (old.m_orientation != component.m_orientation) || (old.m_edge != component.m_edge))
+        {
+            m_componentChanges.push_back({CHANGE_MOVED, &old, &component});
+        }
+    }
+
+    for(size_t i=0; i<m_old.m_components.size(); i++)
+    {
+        if (!matched[i])
+        {
+            m_componentChanges.push_back({CHANGE_REMOVED, &m_old.m_components[i], nullptr});
+        }
+    }
+
+    // gaps, by edge and the instances on both sides
+    std::unordered_map<std::string, size_t> oldGaps;
+    oldGaps.reserve(m_old.m_gaps.size());
+    for(size_t i=0; i<m_old.m_gaps.size(); i++)
+    {
+        const Gap &gap = m_old.m_gaps[i];
+        oldGaps.emplace(gap.m_edge + '\0' + gap.m_from + '\0' + gap.m_to, i);
+    }
+
+    matched.assign(m_old.m_gaps.size(), false);
+    for(auto const &gap : m_new.m_gaps)
+    {
+        auto iter = oldGaps.find(gap.m_edge + '\0' + gap.m_from + '\0' + gap.m_to);
+        if (iter == oldGaps.end())
+        {
+            m_gapChanges.push_back({CHANGE_ADDED, nullptr, &gap});
+            continue;
+        }
+
+        const Gap &old = m_old.m_gaps[iter->second];
+        matched[iter->second] = true;
+        if ((old.m_x != gap.m_x) || (old.m_y != gap.m_y) || (old.m_size != gap.m_size) || 
+            (old.m_fillers != gap.m_fillers))
+        {
+            m_gapChanges.push_back({CHANGE_RESIZED, &old, &gap});
+        }
+    }
+
+    for(size_t i=0; i<m_old.m_gaps.size(); i++)
+    {
+        if (!matched[i])
+        {
+            m_gapChanges.push_back({CHANGE_REMOVED, &m_old.m_gaps[i], nullptr});
+        }
+    }
+    return true;
+}
+
+void LayoutDiff::report()
+{
+    doLog(LOG_INFO, "Diff: %d added, %d removed and %d moved components, %d changed filler gaps\n",
+        getCount(CHANGE_ADDED), getCount(CHANGE_REMOVED), getCount(CHANGE_MOVED), m_gapChanges.size());
+}
+
+bool LayoutDiff::writeDEF(std::ostream &os)
+{
+    os << "# padring ECO delta: " << getCount(CHANGE_ADDED) << " added, " 
+        << getCount(CHANGE_REMOVED) << " removed, " << getCount(CHANGE_MOVED) << " moved components, "
+        << m_gapChanges.size() << " changed filler gaps\n";
+
+    for(auto const &change : m_componentChanges)
+    {
+        if (change.m_change == CHANGE_REMOVED)
+        {
+            os << "# REMOVED " << change.m_old->m_item->m_instance << " " << change.m_old->m_item->m_cellname << "\n";
+        }
+    }
+
+    for(auto const &change : m_gapChanges)
+    {
+        const Gap *gap = (change.m_new != nullptr) ? change.m_new : change.m_old;
+        os << "# GAP " << getChangeName(change.m_change) << " " << gap->m_edge << " " 
+            << (gap->m_from.empty() ? "-" : gap->m_from) << " " << (gap->m_to.empty() ? "-" : gap->m_to) << " :";
+        if (change.m_old != nullptr)
+        {
+            os << " " << change.m_old->m_size << " " << FillerHandler::toString(change.m_old->m_fillers);
+        }
+        os << " ->";
+        if (change.m_new != nullptr)
+        {
+            os << " " << change.m_new->m_size << " " << FillerHandler::toString(change.m_new->m_fillers);
+        }
+        os << "\n";
+    }
+
+    DEFWriter def(os, m_newPadring.m_dieWidth, m_newPadring.m_dieHeight);
+    def.setDatabaseUnits(m_databaseUnits);
+    def.setDesignName(m_newPadring.m_designName);
+    def.setComponentCount(getCount(CHANGE_ADDED) + getCount(CHANGE_MOVED));
+    for(auto const &change : m_componentChanges)
+    {
+        if (change.m_new != nullptr)
+        {
+            def.writeCell(change.m_new->m_item);
+        }
+    }
+    return def.close();
+}
+
+void LayoutDiff::writeComponentJSON(std::ostream &os, const Component *component)
+{
+    if (component == nullptr)
+    {
+        os << "null";
+        return;
+    }
+
+    os << "{\"edge\": " << TextWriter::toJSONString(component->m_edge) << ", \"x\": " << component->m_x 
+        << ", \"y\": " << component->m_y << ", \"orientation\": \"" << OutputSink::getOrientationName(component->m_orientation) << "\"}";
+}
+
+void LayoutDiff::writeGapJSON(std::ostream &os, const Gap *gap)
+{
+    if (gap == nullptr)
+    {
+        os << "null";
+        return;
+    }
+
+    os << "{\"x\": " << gap->m_x << ", \"y\": " << gap->m_y << ", \"size\": " << gap->m_size << ", \"fillers\": [";
+    for(size_t i=0; i<gap->m_fillers.size(); i++)
+    {
+        os << ((i > 0) ? ", " : "") << "{\"cell\": " << TextWriter::toJSONString(gap->m_fillers[i].first) 
+            << ", \"count\": " << gap->m_fillers[i].second << "}";
+    }
+    os << "]}";
+}
+
+bool LayoutDiff::writeJSON(std::ostream &os)
+{
+    os << "{\n  \"design\": " << TextWriter::toJSONString(m_newPadring.m_designName) 
+        << ",\n  \"units\": " << llround(m_databaseUnits)
+        << ",\n  \"summary\": {\"added\": " << getCount(CHANGE_ADDED) << ", \"removed\": " << getCount(CHANGE_REMOVED)
+        << ", \"moved\": " << getCount(CHANGE_MOVED) << ", \"gaps\": " << m_gapChanges.size() << "},\n"
+        << "  \"components\": [\n";
+
+    for(size_t i=0; i<m_componentChanges.size(); i++)
+    {
+        auto const &change = m_componentChanges[i];
+        const Component *component = (change.m_new != nullptr) ? change.m_new : change.m_old;
+        os << "    {\"change\": \"" << getChangeName(change.m_change) << "\", \"instance\": " 
+            << TextWriter::toJSONString(component->m_item->m_instance) << ", \"cell\": " << TextWriter::toJSONString(component->m_item->m_cellname)
+            << ", \"type\": \"" << component->m_type << "\", \"old\": ";
+        writeComponentJSON(os, change.m_old);
+        os << ", \"new\": ";
+        writeComponentJSON(os, change.m_new);
+        os << ((i + 1 < m_componentChanges.size()) ? "},\n" : "}\n");
+    }
+
+    os << "  ],\n  \"gaps\": [\n";
+    for(size_t i=0; i<m_gapChanges.size(); i++)
+    {
+        auto const &change = m_gapChanges[i];
+        const Gap *gap = (change.m_new != nullptr) ? change.m_new : change.m_old;
+        os << "    {\"change\": \"" << getChangeName(change.m_change) << "\", \"edge\": " << TextWriter::toJSONString(gap->m_edge)
+            << ", \"from\": " << TextWriter::toJSONString(gap->m_from) << ", \"to\": " << TextWriter::toJSONString(gap->m_to) << ", \"old\": ";
+        writeGapJSON(os, change.m_old);
+        os << ", \"new\": ";
+        writeGapJSON(os, change.m_new);
+        os << ((i + 1 < m_gapChanges.size()) ? "},\n" : "}\n");
+    }
+    os << "  ]\n}\n";
+    os.flush();
+    return os.good();
+}
+
+bool LayoutDiff::writeCSV(std::ostream &os)
+{
+    os << "# design,units,added,removed,moved,gaps\n# " << TextWriter::toCSVField(m_newPadring.m_designName) << "," 
+        << llround(m_databaseUnits) << "," << getCount(CHANGE_ADDED) << "," << getCount(CHANGE_REMOVED) << ","
+        << getCount(CHANGE_MOVED) << "," << m_gapChanges.size() << "\n";
+
+    os << "change,type,name,cell,edge,old_x,old_y,old_orientation,old_fillers,new_x,new_y,new_orientation,new_fillers,old_size,new_size\n";
+    for(auto const &change : m_componentChanges)
+    {
+        const Component *component = (change.m_new != nullptr) ? change.m_new : change.m_old;
+        os << getChangeName(change.m_change) << "," << component->m_type << "," 
+            << TextWriter::toCSVField(component->m_item->m_instance) << "," << TextWriter::toCSVField(component->m_item->m_cellname) << ","
+            << component->m_edge;
+        for(auto side : {change.m_old, change.m_new})
+        {
+            if (side != nullptr)
+            {
+                os << "," << side->m_x << "," << side->m_y << "," << OutputSink::getOrientationName(side->m_orientation) << ",";
+            }
+            else
+            {
+                os << ",,,,";
+            }
+        }
+        os << ",,\n";
+    }
+
+    // a gap is named after the instances on both sides
+    for(auto const &change : m_gapChanges)
+    {
+        const Gap *gap = (change.m_new != nullptr) ? change.m_new : change.m_old;
+        os << getChangeName(change.m_change) << ",gap," << TextWriter::toCSVField(gap->m_from + ".." + gap->m_to) << ",," << gap->m_edge;
+        for(auto side : {change.m_old, change.m_new})
+        {
+            if (side != nullptr)
+            {
+                os << "," << side->m_x << "," << side->m_y << ",," << TextWriter::toCSVField(FillerHandler::toString(side->m_fillers));
+            }
+            else
+            {
+                os << ",,,,";
+            }
+        }
+        os << "," << ((change.m_old != nullptr) ? std::to_string(change.m_old->m_size) : "")
+            << "," << ((change.m_new != nullptr) ? std::to_string(change.m_new->m_size) : "") << "\n";
+    }
+    os.flush();
+    return os.good();
+}
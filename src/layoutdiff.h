@@ -0,0 +1,152 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef layoutdiff_h
+#define layoutdiff_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "padringdb.h"
+#include "fillerhandler.h"
+#include "outputsink.h"
+
+/** Compares two laid out padrings and writes the changes
+    as an ECO delta: a DEF file with only the added and 
+    moved components, and a JSON or CSV list of all the
+    changes.
+
+    Pads and corners are matched by instance name. A pad
+    whose cell changed is removed and added again. The
+    filler cells are not matched one by one, as their 
+    names change whenever a filler is added or removed
+    in front of them; instead every gap between two 
+    components is matched by its edge and the instances 
+    on both sides, and a changed gap is listed with the
+    filler cells that fill it before and after.
+
+    Both layouts are put in hash tables, so the comparison
+    takes time linear in the number of components.
+*/
+class LayoutDiff
+{
+public:
+    LayoutDiff(PadringDB &oldPadring, FillerHandler &oldFillers, 
+        PadringDB &newPadring, FillerHandler &newFillers);
+
+    void setDatabaseUnits(double databaseUnits)
+    {
+        m_databaseUnits = databaseUnits;
+    }
+
+    /** compare the layouts. returns false if a space
+        cannot be filled with filler cells. */
+    bool compare();
+
+    /** log the number of changes */
+    void report();
+
+    /** write the added and moved components of the new
+        layout as a DEF file. the removed components and
+        the changed gaps are listed as comments. */
+    bool writeDEF(std::ostream &os);
+
+    /** write the changes as JSON */
+    bool writeJSON(std::ostream &os);
+
+    /** write the changes as comma separated values */
+    bool writeCSV(std::ostream &os);
+
+    enum change_t
+    {
+        CHANGE_ADDED,
+        CHANGE_REMOVED,
+        CHANGE_MOVED,       ///< component at another position or orientation
+        CHANGE_RESIZED      ///< gap at another position, size or with other fillers
+    };
+
+protected:
+    /** a pad or corner */
+    struct Component
+    {
+        const LayoutItem *m_item;
+        const char  *m_type;        ///< "pad" or "corner"
+        std::string m_edge;         ///< N, S, E, W or the corner location
+        int64_t     m_x;            ///< placed position in database units
+        int64_t     m_y;
+        OutputSink::orientation_t m_orientation;
+    };
+
+    /** the spaces between two components, and the
+        filler cells that fill them */
+    struct Gap
+    {
+        std::string m_edge;
+        std::string m_from;         ///< instance before the gap, or empty
+        std::string m_to;           ///< instance after the gap, or empty
+        int64_t     m_x;            ///< start of the gap in database units
+        int64_t     m_y;
+        int64_t     m_size;
+        FillerHandler::fillerList_t m_fillers;
+    };
+
+    /** the components and gaps of one padring */
+    struct Side
+    {
+        std::vector<Component>  m_components;
+        std::vector<Gap>        m_gaps;
+    };
+
+    template<class T> struct Change
+    {
+        change_t    m_change;
+        const T     *m_old;     ///< nullptr when added
+        const T     *m_new;     ///< nullptr when removed
+    };
+
+    /** collect the components and gaps of a padring.
+        returns false if a space cannot be filled. */
+    bool collect(PadringDB &padring, FillerHandler &fillers, Side &side);
+
+    int64_t toDBU(double v) const;
+
+    /** the number of component changes of a kind */
+    uint32_t getCount(change_t change) const;
+
+    void writeComponentJSON(std::ostream &os, const Component *component);
+    void writeGapJSON(std::ostream &os, const Gap *gap);
+
+    static const char* getChangeName(change_t change);
+
+    PadringDB       &m_oldPadring;
+    FillerHandler   &m_oldFillers;
+    PadringDB       &m_newPadring;
+    FillerHandler   &m_newFillers;
+    double          m_databaseUnits;
+
+    Side m_old;
+    Side m_new;
+
+    std::vector<Change<Component> > m_componentChanges;
+    std::vector<Change<Gap> >       m_gapChanges;
+};
+
+#endif
@@ -0,0 +1,465 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <cmath>
+#include <algorithm>
+#include "layouteditor.h"
+
+LayoutEditor::LayoutEditor(Layout &layout) : m_layout(layout),
+    m_root(nullptr),
+    m_seed(0x12345678),
+    m_dirtyAll(false),
+    m_dirtyBegin(0),
+    m_dirtyEnd(0)
+{
+    for(auto item : m_layout.m_items)
+    {
+        m_root = merge(m_root, createNode(item));
+    }
+
+    m_base = 0.0;
+    m_cornerSize = 0.0;
+    if (m_layout.m_firstCorner != nullptr)
+    {
+        m_base = m_layout.m_firstCorner->m_size;
+        m_cornerSize += m_layout.m_firstCorner->m_size;
+    }
+    if (m_layout.m_lastCorner != nullptr)
+    {
+        m_cornerSize += m_layout.m_lastCorner->m_size;
+    }
+
+    m_mean = getMeanFlexSpaceSize();
+}
+
+LayoutEditor::~LayoutEditor()
+{
+    commit();
+    destroy(m_root);
+}
+
+LayoutEditor::Node* LayoutEditor::createNode(LayoutItem *item)
+{
+    // xorshift32 random priorities
+    m_seed ^= m_seed << 13;
+    m_seed ^= m_seed >> 17;
+    m_seed ^= m_seed << 5;
+
+    Node *n = new Node();
+    n->m_item = item;
+    n->m_priority = m_seed;
+    n->m_left  = nullptr;
+    n->m_right = nullptr;
+    updateNode(n);
+    return n;
+}
+
+void LayoutEditor::updateNode(Node *n)
+{
+    bool isFlex = (n->m_item->m_ltype == LayoutItem::TYPE_FLEXSPACE);
+    bool isCell = (n->m_item->m_ltype == LayoutItem::TYPE_CELL);
+
+    n->m_count     = count(n->m_left) + count(n->m_right) + 1;
+    n->m_cellCount = cellCount(n->m_left) + cellCount(n->m_right) + (isCell ? 1 : 0);
+    n->m_flexCount = flexCount(n->m_left) + flexCount(n->m_right) + (isFlex ? 1 : 0);
+    n->m_fixedSize = fixedSize(n->m_left) + fixedSize(n->m_right) + (isFlex ? 0.0 : n->m_item->m_size);
+}
+
+void LayoutEditor::split(Node *n, size_t k, Node *&left, Node *&right)
+{
+    if (n == nullptr)
+    {
+        left  = nullptr;
+        right = nullptr;
+        return;
+    }
+
+    if (count(n->m_left) >= k)
+    {
+        split(n->m_left, k, left, n->m_left);
+        right = n;
+    }
+    else
+    {
+        split(n->m_right, k - count(n->m_left) - 1, n->m_right, right);
+        left = n;
+    }
+    updateNode(n);
+}
+
+LayoutEditor::Node* LayoutEditor::merge(Node *left, Node *right)
+{
+    if (left == nullptr) return right;
+    if (right == nullptr) return left;
+
+    if (left->m_priority > right->m_priority)
+    {
+        left->m_right = merge(left->m_right, right);
+        updateNode(left);
+        return left;
+    }
+    
+    right->m_left = merge(left, right->m_left);
+    updateNode(right);
+    return right;
+}
+
+void LayoutEditor::destroy(Node *n)
+{
+    if (n == nullptr)
+    {
+        return;
+    }
+    destroy(n->m_left);
+    destroy(n->m_right);
+    delete n;
+}
+
+LayoutEditor::Node* LayoutEditor::itemNode(size_t itemIndex) const
+{
+    Node *n = m_root;
+    while(n != nullptr)
+    {
+        size_t leftCount = count(n->m_left);
+        if (itemIndex < leftCount)
+        {
+            n = n->m_left;
+        }
+        else if (itemIndex == leftCount)
+        {
+            return n;
+        }
+        else
+        {
+            itemIndex -= leftCount + 1;
+            n = n->m_right;
+        }
+    }
+    return nullptr;
+}
+
+size_t LayoutEditor::cellToItemIndex(size_t cellIndex) const
+{
+    size_t itemIndex = 0;
+    Node *n = m_root;
+    while(n != nullptr)
+    {
+        size_t leftCells = cellCount(n->m_left);
+        if (cellIndex < leftCells)
+        {
+            n = n->m_left;
+            continue;
+        }
+
+        cellIndex -= leftCells;
+        bool isCell = (n->m_item->m_ltype == LayoutItem::TYPE_CELL);
+        if (isCell && (cellIndex == 0))
+        {
+            return itemIndex + count(n->m_left);
+        }
+
+        if (isCell)
+        {
+            cellIndex--;
+        }
+        itemIndex += count(n->m_left) + 1;
+        n = n->m_right;
+    }
+
+    // past the last cell
+    return itemIndex;
+}
+
+void LayoutEditor::prefix(size_t k, double &fixedSum, uint32_t &flexSum) const
+{
+    fixedSum = 0.0;
+    flexSum  = 0;
+    Node *n = m_root;
+    while(n != nullptr)
+    {
+        if (k <= count(n->m_left))
+        {
+            n = n->m_left;
+            continue;
+        }
+
+        bool isFlex = (n->m_item->m_ltype == LayoutItem::TYPE_FLEXSPACE);
+        fixedSum += fixedSize(n->m_left) + (isFlex ? 0.0 : n->m_item->m_size);
+        flexSum  += flexCount(n->m_left) + (isFlex ? 1 : 0);
+        k -= count(n->m_left) + 1;
+        n = n->m_right;
+    }
+}
+
+double LayoutEditor::fixedSizeBeforeFlex(uint32_t flexIndex) const
+{
+    double fixedSum = 0.0;
+    Node *n = m_root;
+    while(n != nullptr)
+    {
+        if (flexCount(n->m_left) >= flexIndex)
+        {
+            n = n->m_left;
+            continue;
+        }
+
+        flexIndex -= flexCount(n->m_left);
+        fixedSum  += fixedSize(n->m_left);
+        if (n->m_item->m_ltype == LayoutItem::TYPE_FLEXSPACE)
+        {
+            if (flexIndex == 1)
+            {
+                return fixedSum;
+            }
+            flexIndex--;
+        }
+        else
+        {
+            fixedSum += n->m_item->m_size;
+        }
+        n = n->m_right;
+    }
+    return fixedSum;
+}
+
+double LayoutEditor::getMeanFlexSpaceSize() const
+{
+    if (flexCount(m_root) == 0)
+    {
+        return 0.0;
+    }
+
+    double minSize = fixedSize(m_root) + m_cornerSize;
+    return (m_layout.m_dieSize - minSize) / static_cast<double>(flexCount(m_root));
+}
+
+double LayoutEditor::getItemPos(size_t itemIndex) const
+{
+    double   fixedSum;
+    uint32_t flexSum;
+    prefix(itemIndex, fixedSum, flexSum);
+
+    double fixedPos = m_base + fixedSum;
+    if (flexSum == 0)
+    {
+        return fixedPos;
+    }
+
+    // the position is the end of the last FLEXSPACE
+    // plus the fixed size items after it.
+    double flexFixedPos = m_base + fixedSizeBeforeFlex(flexSum);
+    double flexEnd = Layout::getFlexSpaceEnd(flexFixedPos, flexSum, m_mean);
+    return flexEnd + (fixedPos - flexFixedPos);
+}
+
+void LayoutEditor::markDirty(size_t begin, size_t end)
+{
+    if (m_dirtyBegin == m_dirtyEnd)
+    {
+        m_dirtyBegin = begin;
+        m_dirtyEnd   = end;
+        return;
+    }
+    m_dirtyBegin = std::min(m_dirtyBegin, begin);
+    m_dirtyEnd   = std::max(m_dirtyEnd, end);
+}
+
+size_t LayoutEditor::getCellCount() const
+{
+    return cellCount(m_root);
+}
+
+LayoutItem* LayoutEditor::getCell(size_t cellIndex) const
+{
+    Node *n = itemNode(cellToItemIndex(cellIndex));
+    return (n != nullptr) ? n->m_item : nullptr;
+}
+
+void LayoutEditor::insertCell(size_t cellIndex, LayoutItem *cell)
+{
+    size_t itemIndex = cellToItemIndex(cellIndex);
+
+    // every cell is followed by a FLEXSPACE, just
+    // like Layout::addItem does.
+    LayoutItem *flex = new LayoutItem(LayoutItem::TYPE_FLEXSPACE);
+    m_layout.setItemEdgePos(cell);
+    m_layout.setItemEdgePos(flex);
+
+    Node *left, *right;
+    split(m_root, itemIndex, left, right);
+    m_root = merge(merge(left, merge(createNode(cell), createNode(flex))), right);
+
+    m_dirtyAll = true;
+}
+
+LayoutItem* LayoutEditor::removeCell(size_t cellIndex)
+{
+    if (cellIndex >= getCellCount())
+    {
+        return nullptr;
+    }
+
+    size_t itemIndex = cellToItemIndex(cellIndex);
+
+    // remove the cell and a FLEXSPACE next to it
+    size_t begin = itemIndex;
+    size_t end   = itemIndex + 1;
+    Node *next = itemNode(itemIndex + 1);
+    Node *prev = (itemIndex > 0) ? itemNode(itemIndex - 1) : nullptr;
+    if ((next != nullptr) && (next->m_item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
+    {
+        end++;
+    }
+    else if ((prev != nullptr) && (prev->m_item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
+    {
+        begin--;
+    }
+
+    Node *left, *middle, *right;
+    split(m_root, end, left, right);
+    split(left, begin, left, middle);
+    m_root = merge(left, right);
+
+    // the middle tree holds the cell and at most one FLEXSPACE
+    LayoutItem *cell = nullptr;
+    Node *nodes[3] = {middle, middle->m_left, middle->m_right};
+    for(auto n : nodes)
+    {
+        if (n == nullptr)
+        {
+            continue;
+        }
+        if (n->m_item->m_ltype == LayoutItem::TYPE_CELL)
+        {
+            cell = n->m_item;
+        }
+        else
+        {
+            // the layout still refers to the FLEXSPACE
+            // until commit() rebuilds its item list.
+            m_removed.push_back(n->m_item);
+        }
+    }
+    destroy(middle);
+
+    m_dirtyAll = true;
+    return cell;
+}
+
+void LayoutEditor::swapCells(size_t cellIndex1, size_t cellIndex2)
+{
+    if ((cellIndex1 == cellIndex2) || 
+        (cellIndex1 >= getCellCount()) || 
+        (cellIndex2 >= getCellCount()))
+    {
+        return;
+    }
+
+    size_t idx1 = cellToItemIndex(cellIndex1);
+    size_t idx2 = cellToItemIndex(cellIndex2);
+    if (idx1 > idx2)
+    {
+        std::swap(idx1, idx2);
+    }
+
+    // cut out both cells, swap them and put
+    // them back to update the subtree sizes.
+    Node *left, *first, *middle, *second, *right;
+    split(m_root, idx2 + 1, left, right);
+    split(left, idx2, left, second);
+    split(left, idx1 + 1, left, middle);
+    split(left, idx1, left, first);
+    m_root = merge(merge(merge(merge(left, second), middle), first), right);
+
+    markDirty(idx1, idx2 + 1);
+}
+
+std::vector<LayoutItem*> LayoutEditor::update()
+{
+    std::vector<LayoutItem*> moved;
+
+    double mean = getMeanFlexSpaceSize();
+    if (mean != m_mean)
+    {
+        m_mean = mean;
+        m_dirtyAll = true;
+    }
+
+    size_t begin = m_dirtyBegin;
+    size_t end   = std::min(m_dirtyEnd, count(m_root));
+    if (m_dirtyAll)
+    {
+        begin = 0;
+        end   = count(m_root);
+    }
+
+    for(size_t idx = begin; idx < end; idx++)
+    {
+        LayoutItem *item = itemNode(idx)->m_item;
+        double pos = getItemPos(idx);
+
+        if (item->m_ltype == LayoutItem::TYPE_FLEXSPACE)
+        {
+            double   fixedSum;
+            uint32_t flexSum;
+            prefix(idx + 1, fixedSum, flexSum);
+            double flexFixedPos = m_base + fixedSum;
+            item->m_size = Layout::getFlexSpaceEnd(flexFixedPos, flexSum, m_mean) - pos;
+        }
+        else if ((item->m_ltype == LayoutItem::TYPE_CELL) && 
+            (std::fabs(m_layout.getItemPos(item) - pos) > 1e-9))
+        {
+            moved.push_back(item);
+        }
+
+        m_layout.setItemPos(item, pos);
+    }
+
+    m_dirtyAll   = false;
+    m_dirtyBegin = 0;
+    m_dirtyEnd   = 0;
+    return moved;
+}
+
+void LayoutEditor::commit()
+{
+    m_layout.m_items.clear();
+
+    // in-order traversal without recursion
+    std::vector<Node*> stack;
+    Node *n = m_root;
+    while((n != nullptr) || !stack.empty())
+    {
+        while(n != nullptr)
+        {
+            stack.push_back(n);
+            n = n->m_left;
+        }
+        n = stack.back();
+        stack.pop_back();
+        m_layout.m_items.push_back(n->m_item);
+        n = n->m_right;
+    }
+
+    for(auto item : m_removed)
+    {
+        delete item;
+    }
+    m_removed.clear();
+}
@@ -0,0 +1,148 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef layouteditor_h
+#define layouteditor_h
+
+#include <stdint.h>
+#include <vector>
+
+#include "layout.h"
+
+/** Edits the cells of a laid out edge and updates the
+    positions incrementally.
+
+    The items of the edge are kept in a balanced tree
+    (a treap) that holds the number of items, cells and
+    FLEXSPACE items and the total size of the fixed-size
+    items of every subtree. This allows the position of
+    any item to be computed in O(log n), using the same
+    FLEXSPACE placement rule as Layout::doLayout.
+
+    Edits take O(log n). After a series of edits, update()
+    recomputes the positions of the items that can have moved
+    and returns the cells whose position changed. Swaps only
+    affect the items between the two swapped cells. Inserting
+    or removing a cell changes the size of every FLEXSPACE,
+    so the whole edge is updated.
+
+    The item list of the Layout itself is only updated 
+    by commit().
+*/
+class LayoutEditor
+{
+public:
+    /** create an editor for an edge on which
+        Layout::doLayout has been performed. */
+    LayoutEditor(Layout &layout);
+
+    virtual ~LayoutEditor();
+
+    /** return the number of cells, excluding corners */
+    size_t getCellCount() const;
+
+    /** return the cell with the given index */
+    LayoutItem* getCell(size_t cellIndex) const;
+
+    /** insert a cell before the cell with the given index,
+        or at the end when the index equals the number of
+        cells. the editor takes ownership of the cell.
+    */
+    void insertCell(size_t cellIndex, LayoutItem *cell);
+
+    /** remove the cell with the given index. ownership of 
+        the cell is transferred to the caller, who must not
+        delete it before commit() has been called.
+    */
+    LayoutItem* removeCell(size_t cellIndex);
+
+    /** swap two cells */
+    void swapCells(size_t cellIndex1, size_t cellIndex2);
+
+    /** update the positions of all the items that can have
+        moved since the last update and return the cells
+        whose position changed.
+    */
+    std::vector<LayoutItem*> update();
+
+    /** write the edited item sequence back into the layout */
+    void commit();
+
+protected:
+    struct Node
+    {
+        LayoutItem  *m_item;
+        uint32_t    m_priority;
+        Node        *m_left;
+        Node        *m_right;
+
+        // subtree aggregates
+        size_t      m_count;        ///< number of items
+        size_t      m_cellCount;    ///< number of cells
+        uint32_t    m_flexCount;    ///< number of FLEXSPACE items
+        double      m_fixedSize;    ///< total size of all non-FLEXSPACE items
+    };
+
+    static size_t count(const Node *n) { return (n != nullptr) ? n->m_count : 0; }
+    static size_t cellCount(const Node *n) { return (n != nullptr) ? n->m_cellCount : 0; }
+    static uint32_t flexCount(const Node *n) { return (n != nullptr) ? n->m_flexCount : 0; }
+    static double fixedSize(const Node *n) { return (n != nullptr) ? n->m_fixedSize : 0.0; }
+
+    Node* createNode(LayoutItem *item);
+    static void updateNode(Node *n);
+    static void split(Node *n, size_t k, Node *&left, Node *&right);
+    static Node* merge(Node *left, Node *right);
+    static void destroy(Node *n);
+
+    /** get the node of the item with the given index */
+    Node* itemNode(size_t itemIndex) const;
+
+    /** get the item index of the cell with the given index */
+    size_t cellToItemIndex(size_t cellIndex) const;
+
+    /** total fixed size and FLEXSPACE count of the first k items */
+    void prefix(size_t k, double &fixedSum, uint32_t &flexSum) const;
+
+    /** fixed size before the n-th (1-based) FLEXSPACE */
+    double fixedSizeBeforeFlex(uint32_t n) const;
+
+    /** compute the position of an item */
+    double getItemPos(size_t itemIndex) const;
+
+    /** compute the FLEXSPACE size */
+    double getMeanFlexSpaceSize() const;
+
+    void markDirty(size_t begin, size_t end);
+
+    Layout      &m_layout;
+    Node        *m_root;
+    uint32_t    m_seed;
+
+    double      m_base;         ///< size of the first corner
+    double      m_cornerSize;   ///< size of both corners
+    double      m_mean;         ///< FLEXSPACE size of the last update
+
+    bool        m_dirtyAll;
+    size_t      m_dirtyBegin;
+    size_t      m_dirtyEnd;
+
+    std::vector<LayoutItem*> m_removed; ///< removed FLEXSPACE items, deleted by commit()
+};
+
+#endif
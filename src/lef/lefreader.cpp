@@ -17,6 +17,7 @@
     
 */
 
+#include "../logging.h"
 #include "lefreader.h"
 
 bool LEFReader::isWhitespace(char c) const
@@ -395,7 +396,7 @@ bool LEFReader::parsePin()
         return false;
     }
 
-    std::cout << "  PIN: " << name << "\n";
+    doLog(LOG_VERBOSE, "  PIN: %s\n", name.c_str());
 
     onPin(name);
 
@@ -185,7 +185,7 @@ class ChunkyLineReader
 {
 public:
     ChunkyLineReader(std::istream &is, const std::string separators = " \t") 
-        : m_is(is), m_chunkifier(separators)
+        : m_chunkifier(separators), m_is(is)
     {
         m_lineNum = 0;
         nextLine();
@@ -23,12 +23,43 @@
 #include "logging.h"
 
 static uint32_t gs_loglevel = LOG_INFO;
+static FILE*    gs_logfile  = stdout;
+static thread_local logbuffer_t *gs_threadlog = nullptr;
 
 void setLogLevel(uint32_t level)
 {
     gs_loglevel = level;
 }
 
+void setLogFile(FILE *f)
+{
+    gs_logfile = f;
+}
+
+const char *getLogPrefix(uint32_t t)
+{
+    switch(t)
+    {
+    case LOG_INFO:
+        return "[INFO] ";
+    case LOG_DEBUG:
+        return "[DBG ] ";
+    case LOG_WARN:
+        return "[WARN] ";
+    case LOG_ERROR:
+        return "[ERR ] ";
+    case LOG_VERBOSE:
+        return "[VERB] ";
+    default:
+        return "";
+    }
+}
+
+void setThreadLogBuffer(logbuffer_t *buffer)
+{
+    gs_threadlog = buffer;
+}
+
 void doLog(uint32_t t, const std::string &txt)
 {
     doLog(t, txt.c_str());
@@ -41,29 +72,31 @@ void doLog(uint32_t t, const char *format, ...)
         return;
     }
 
-    FILE *sout = stdout;
+    if (gs_threadlog != nullptr)
+    {
+        va_list argptr;
+        va_start(argptr, format);
+        va_list argcopy;
+        va_copy(argcopy, argptr);
+        int len = vsnprintf(nullptr, 0, format, argcopy);
+        va_end(argcopy);
+        std::string txt(len > 0 ? len : 0, '\0');
+        if (len > 0)
+        {
+            vsnprintf(&txt[0], len+1, format, argptr);
+        }
+        va_end(argptr);
+        gs_threadlog->emplace_back(t, txt);
+        return;
+    }
 
-    switch(t)
+    FILE *sout = gs_logfile;
+
+    if (t == LOG_ERROR)
     {
-    case LOG_INFO:
-        fprintf(sout, "[INFO] ");
-        break;
-    case LOG_DEBUG:
-        fprintf(sout, "[DBG ] ");
-        break;
-    case LOG_WARN:
-        fprintf(sout, "[WARN] ");
-        break;
-    case LOG_ERROR:
         sout = stderr;
-        fprintf(sout, "[ERR ] ");
-        break;
-    case LOG_VERBOSE:
-        fprintf(stdout, "[VERB] ");
-        break;
-    default:
-        break;
     }
+    fprintf(sout, "%s", getLogPrefix(t));
 
     //FIXME: change to C++ style
     va_list argptr;
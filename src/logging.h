@@ -20,7 +20,10 @@
 #ifndef logging_h
 #define logging_h
 
+#include <stdio.h>
 #include <string>
+#include <vector>
+#include <utility>
 
 typedef enum {LOG_VERBOSE = 1, LOG_DEBUG = 2, LOG_INFO = 3, LOG_WARN = 4, 
     LOG_ERROR = 8, LOG_QUIET = 255} logtype_t;
@@ -34,4 +37,21 @@ void doLog(uint32_t t, const std::string &txt);
 /** set the log level ... */
 void setLogLevel(uint32_t level);
 
+/** set the file for all messages except errors, 
+    which always go to stderr. the default is stdout. */
+void setLogFile(FILE *f);
+
+/** return the tag that is written in front of
+    a message of the given type, e.g. "[INFO] " */
+const char *getLogPrefix(uint32_t t);
+
+/** messages captured for one thread: log type and text */
+typedef std::vector<std::pair<uint32_t, std::string> > logbuffer_t;
+
+/** capture the messages of the calling thread in a buffer
+    instead of writing them to the log file. messages below
+    the log level are dropped as usual. pass nullptr to
+    stop capturing. */
+void setThreadLogBuffer(logbuffer_t *buffer);
+
 #endif
@@ -24,9 +24,16 @@
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <memory>
 
 #define __PGMVERSION__ "0.02d"
 
+// set by the build, see CMakeLists.txt
+#ifndef __BUILDID__
+#define __BUILDID__ "unknown"
+#endif
+
 #include "logging.h"
 
 #include "cxxopts.h"
@@ -34,11 +41,152 @@
 #include "configreader.h"
 #include "layout.h"
 #include "padringdb.h"
-#include "svgwriter.h"
-#include "defwriter.h"
 #include "fillerhandler.h"
 #include "debugutils.h"
-#include "gds2/gds2writer.h"
+#include "diefitter.h"
+#include "sweeper.h"
+#include "padringwriter.h"
+#include "padorderoptimizer.h"
+#include "configwriter.h"
+#include "batch.h"
+#include "server.h"
+#include "watcher.h"
+#include "outputcache.h"
+#include "snapshot.h"
+#include "layoutdiff.h"
+#include "textwriter.h"
+
+/** return the job with the output and layout
+    options given on the command line.
+*/
+static PadringJob getJob(const cxxopts::ParseResult &cmdresult)
+{
+    PadringJob job;
+    job.m_gds2Filename   = (cmdresult.count("output") > 0) ? cmdresult["output"].as<std::string>() : "";
+    job.m_svgFilename    = (cmdresult.count("svg") > 0) ? cmdresult["svg"].as<std::string>() : "";
+    job.m_defFilename    = (cmdresult.count("def") > 0) ? cmdresult["def"].as<std::string>() : "";
+    job.m_oasisFilename  = (cmdresult.count("oasis") > 0) ? cmdresult["oasis"].as<std::string>() : "";
+    job.m_htmlFilename   = (cmdresult.count("html") > 0) ? cmdresult["html"].as<std::string>() : "";
+    job.m_pngFilename    = (cmdresult.count("png") > 0) ? cmdresult["png"].as<std::string>() : "";
+    job.m_reportFilename = (cmdresult.count("report") > 0) ? cmdresult["report"].as<std::string>() : "";
+    job.m_pngSize        = (cmdresult.count("png-size") > 0) ? cmdresult["png-size"].as<uint32_t>() : 0;
+    job.m_fillerPrefix   = (cmdresult.count("filler") > 0) ? cmdresult["filler"].as<std::string>() : "";
+    job.m_fit            = (cmdresult.count("fit") > 0);
+    job.m_useAREF        = (cmdresult.count("no-aref") == 0);
+    job.m_gds2Hierarchy  = (cmdresult.count("gds-hierarchy") > 0);
+    job.m_verify         = (cmdresult.count("verify") > 0);
+    return job;
+}
+
+/** write the laid out padring to the output files
+    given on the command line. returns false on an error.
+*/
+static bool writeOutputs(const cxxopts::ParseResult &cmdresult, PadringDB &padring, 
+    FillerHandler &fillerHandler, double LEFDatabaseUnits)
+{
+    PadringWriter padringWriter(padring, fillerHandler);
+    getJob(cmdresult).setupWriter(padringWriter, LEFDatabaseUnits);
+    if (cmdresult.count("merge-gds") > 0)
+    {
+        for(auto const &filename : cmdresult["merge-gds"].as<std::vector<std::string>>())
+        {
+            if (!padringWriter.addGDS2Library(filename))
+            {
+                doLog(LOG_ERROR, "Cannot read GDS2 library -- aborting\n");
+                return false;
+            }
+        }
+    }
+
+    return padringWriter.write();
+}
+
+/** compare the laid out padring with the layout of 
+    the --diff file, a snapshot or a configuration file,
+    and write the changes. a configuration file is read 
+    with the cells of lefreader, which must not be nullptr.
+    returns false on an error.
+*/
+static bool writeDiff(const cxxopts::ParseResult &cmdresult, PadringDB &padring, 
+    FillerHandler &fillerHandler, double LEFDatabaseUnits, const PRLEFReader *lefreader)
+{
+    std::string baseFileName = cmdresult["diff"].as<std::string>();
+    bool isSnapshot = Snapshot::isSnapshot(baseFileName);
+    if (!isSnapshot && (lefreader == nullptr))
+    {
+        doLog(LOG_ERROR, "The LEF files are needed to compare with configuration file %s\n", baseFileName.c_str());
+        return false;
+    }
+
+    doLog(LOG_INFO, "Reading the layout to compare with from %s\n", baseFileName.c_str());
+    PRLEFReader baseLEFReader;
+    PadringDB base(isSnapshot ? baseLEFReader : *lefreader);
+    FillerHandler baseFillers;
+    if (isSnapshot)
+    {
+        double baseDatabaseUnits;
+        if (!Snapshot::load(baseFileName, baseLEFReader, base, baseFillers, baseDatabaseUnits))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        // lay out the configuration with the same options
+        PadringJob job = getJob(cmdresult);
+        std::ifstream baseStream(baseFileName, std::ifstream::in);
+        if (!base.parse(baseStream) || !job.addFillers(*lefreader, base, baseFillers) || 
+            (job.fitDie(base, baseFillers) != "ok"))
+        {
+            doLog(LOG_ERROR, "Cannot lay out configuration file %s\n", baseFileName.c_str());
+            return false;
+        }
+        base.doLayout();
+    }
+
+    LayoutDiff diff(base, baseFillers, padring, fillerHandler);
+    diff.setDatabaseUnits(LEFDatabaseUnits);
+    if (!diff.compare())
+    {
+        return false;
+    }
+    diff.report();
+
+    if (cmdresult.count("diff-def") > 0)
+    {
+        std::string defFileName = cmdresult["diff-def"].as<std::string>();
+        std::ofstream defStream(defFileName, std::ofstream::out | std::ofstream::binary);
+        doLog(LOG_INFO, "Writing the ECO DEF file: %s\n", defFileName.c_str());
+        if (!defStream.is_open() || !diff.writeDEF(defStream))
+        {
+            doLog(LOG_ERROR, "Cannot write ECO DEF file %s\n", defFileName.c_str());
+            return false;
+        }
+    }
+
+    if (cmdresult.count("diff-out") > 0)
+    {
+        std::string resultFileName = cmdresult["diff-out"].as<std::string>();
+        std::ofstream resultStream(resultFileName, std::ofstream::out | std::ofstream::binary);
+        if (!resultStream.is_open())
+        {
+            doLog(LOG_ERROR, "Cannot open diff file %s\n", resultFileName.c_str());
+            return false;
+        }
+
+        doLog(LOG_INFO, "Writing the changes to %s\n", resultFileName.c_str());
+        if (TextWriter::isJSONFilename(resultFileName))
+        {
+            return diff.writeJSON(resultStream);
+        }
+        return diff.writeCSV(resultStream);
+    }
+    else if (cmdresult.count("diff-def") == 0)
+    {
+        return diff.writeCSV(std::cout);
+    }
+    return true;
+}
 
 int main(int argc, char *argv[])
 {
@@ -55,10 +203,34 @@ int main(int argc, char *argv[])
         ("L,lef", "LEF file", cxxopts::value<std::vector<std::string>>())
         ("o,output", "GDS2 output file", cxxopts::value<std::string>())
         ("svg", "SVG output file", cxxopts::value<std::string>())
+        ("html", "HTML viewer output file", cxxopts::value<std::string>())
+        ("png", "PNG thumbnail output file", cxxopts::value<std::string>())
+        ("png-size", "largest side of the PNG thumbnail in pixels", cxxopts::value<uint32_t>())
+        ("report", "placement report file (.csv or .json)", cxxopts::value<std::string>())
         ("def", "DEF output file", cxxopts::value<std::string>())
+        ("no-aref", "write every GDS2 filler cell as an SREF instead of using AREF arrays")
+        ("gds-hierarchy", "write a hierarchical GDS2 file with shared edge and filler structures")
+        ("oasis", "OASIS output file", cxxopts::value<std::string>())
+        ("verify", "read back the GDS2 file and check it against the layout")
+        ("merge-gds", "cell library GDS2 file to copy the placed cells from", cxxopts::value<std::vector<std::string>>())
         ("q,quiet", "produce no console output")
         ("v,verbose", "produce verbose output")
-        ("filler", "set the filler cell prefix", cxxopts::value<std::vector<std::string>>())
+        ("filler", "set the filler cell prefix", cxxopts::value<std::string>())
+        ("fit", "search for the smallest die area that fits the padring")
+        ("sweep", "evaluate the die sizes and spaces listed in a sweep file", cxxopts::value<std::string>())
+        ("sweep-out", "sweep results file (.csv or .json)", cxxopts::value<std::string>())
+        ("threads", "number of threads (default: all hardware threads)", cxxopts::value<uint32_t>())
+        ("optimize", "optimize the pad order and write the configuration file", cxxopts::value<std::string>())
+        ("opt-moves", "number of optimizer moves per thread (default: 1000000)", cxxopts::value<uint64_t>())
+        ("batch", "lay out all the padrings listed in a manifest file", cxxopts::value<std::string>())
+        ("watch", "keep running and update the outputs when the configuration or LEF files change")
+        ("save-snapshot", "write the laid out padring to a binary snapshot file", cxxopts::value<std::string>())
+        ("load-snapshot", "write the outputs of a snapshot file, without LEF and configuration files", cxxopts::value<std::string>())
+        ("diff", "compare the layout with that of a snapshot or configuration file", cxxopts::value<std::string>())
+        ("diff-def", "ECO DEF file with the added and moved components", cxxopts::value<std::string>())
+        ("diff-out", "list of changes (.csv or .json)", cxxopts::value<std::string>())
+        ("cache", "reuse the output files of earlier runs with the same inputs, kept in this directory", cxxopts::value<std::string>())
+        ("serve", "answer layout requests on a Unix domain socket, or - for stdin/stdout", cxxopts::value<std::string>())
         ("config_file", "set the configuration file", cxxopts::value<std::vector<std::string>>());
 
     options.parse_positional({"config_file"});
@@ -66,7 +238,8 @@ int main(int argc, char *argv[])
     auto cmdresult = options.parse(argc, argv);
 
     if ((cmdresult.count("help")>0) || 
-        (cmdresult.count("config_file")!=1))
+        ((cmdresult.count("config_file")!=1) && (cmdresult.count("batch")==0) && (cmdresult.count("serve")==0) && 
+         (cmdresult.count("load-snapshot")==0)))
     {
         std::cout << options.help({"", "Group"}) << std::endl;
         exit(0);
@@ -82,19 +255,66 @@ int main(int argc, char *argv[])
         setLogLevel(LOG_VERBOSE);
     }
 
+    // keep stdout clean when the DEF file or the
+    // server answers are written to it
+    if (((cmdresult.count("def") > 0) && (cmdresult["def"].as<std::string>() == "-")) ||
+        ((cmdresult.count("serve") > 0) && (cmdresult["serve"].as<std::string>() == "-")))
+    {
+        setLogFile(stderr);
+    }
+
     ////////////////////////////////////////////////////////////////////////////////
     // Program banner
     ////////////////////////////////////////////////////////////////////////////////
     doLog(LOG_INFO,"PADRING version " __PGMVERSION__ " - compiled on " __DATE__ "\n");
     doLog(LOG_INFO,"Symbiotic EDA GmbH\n\n");
 
+    // write the outputs of a laid out padring, without 
+    // reading the LEF and configuration files.
+    if (cmdresult.count("load-snapshot") > 0)
+    {
+        PRLEFReader lefreader;
+        PadringDB padring(lefreader);
+        FillerHandler fillerHandler;
+        double LEFDatabaseUnits = 0.0;
+        std::string snapshotFileName = cmdresult["load-snapshot"].as<std::string>();
+        doLog(LOG_INFO, "Reading snapshot %s\n", snapshotFileName.c_str());
+        if (!Snapshot::load(snapshotFileName, lefreader, padring, fillerHandler, LEFDatabaseUnits))
+        {
+            doLog(LOG_ERROR, "Cannot read snapshot -- aborting\n");
+            exit(1);
+        }
+
+        doLog(LOG_INFO,"Die area        : %f x %f microns\n", padring.m_dieWidth, padring.m_dieHeight);
+        if ((cmdresult.count("diff") > 0) && !writeDiff(cmdresult, padring, fillerHandler, LEFDatabaseUnits, nullptr))
+        {
+            exit(1);
+        }
+        return writeOutputs(cmdresult, padring, fillerHandler, LEFDatabaseUnits) ? 0 : 1;
+    }
+
     if (cmdresult.count("lef") < 1)
     {
         std::cout << "You must specify at least one LEF file containing the ASIC cells";
         exit(0);
     }
 
-    PadringDB padring;
+    // the watcher reads the LEF and configuration
+    // files itself, every time they change.
+    if (cmdresult.count("watch") > 0)
+    {
+        if ((cmdresult.count("merge-gds") > 0) || (cmdresult.count("sweep") > 0) || (cmdresult.count("optimize") > 0))
+        {
+            doLog(LOG_WARN, "--merge-gds, --sweep and --optimize are ignored by --watch\n");
+        }
+
+        Watcher watcher(cmdresult["lef"].as<std::vector<std::string> >(), 
+            cmdresult["config_file"].as<std::vector<std::string> >()[0], getJob(cmdresult));
+        return watcher.run() ? 0 : 1;
+    }
+
+    PRLEFReader lefreader;
+    PadringDB padring(lefreader);
 
     double LEFDatabaseUnits = 0.0;
 
@@ -105,14 +325,58 @@ int main(int argc, char *argv[])
     {
         std::ifstream lefstream(leffile, std::ifstream::in);
         doLog(LOG_INFO, "Reading LEF %s\n", leffile.c_str());
-        padring.m_lefreader.parse(lefstream);
-        if (padring.m_lefreader.m_lefDatabaseUnits > 0.0)
+        lefreader.parse(lefstream);
+        if (lefreader.m_lefDatabaseUnits > 0.0)
         {
-            LEFDatabaseUnits = padring.m_lefreader.m_lefDatabaseUnits;
+            LEFDatabaseUnits = lefreader.m_lefDatabaseUnits;
         }
     }
 
-    doLog(LOG_INFO,"%d cells read\n", padring.m_lefreader.m_cells.size());
+    doLog(LOG_INFO,"%d cells read\n", lefreader.m_cells.size());
+
+    // run the jobs of a batch manifest, if requested.
+    // the jobs share the LEF database read above.
+    if (cmdresult.count("batch") > 0)
+    {
+        Batch batch(lefreader);
+        std::string manifestFileName = cmdresult["batch"].as<std::string>();
+        std::ifstream manifestStream(manifestFileName, std::ifstream::in);
+        if (!manifestStream.is_open())
+        {
+            doLog(LOG_ERROR, "Cannot open manifest file %s\n", manifestFileName.c_str());
+            exit(1);
+        }
+
+        if (!batch.readManifest(manifestStream))
+        {
+            doLog(LOG_ERROR, "Cannot parse manifest file -- aborting\n");
+            exit(1);
+        }
+
+        batch.setDatabaseUnits(LEFDatabaseUnits);
+        batch.run((cmdresult.count("threads") > 0) ? cmdresult["threads"].as<uint32_t>() : 0);
+        batch.report();
+        return (batch.getFailedCount() > 0) ? 1 : 0;
+    }
+
+    // answer layout requests until the client
+    // shuts the server down.
+    if (cmdresult.count("serve") > 0)
+    {
+        Server server(lefreader);
+        server.setDatabaseUnits(LEFDatabaseUnits);
+        std::string socketName = cmdresult["serve"].as<std::string>();
+        bool ok;
+        if (socketName == "-")
+        {
+            ok = server.serve(fileno(stdin), fileno(stdout));
+        }
+        else
+        {
+            ok = server.listen(socketName);
+        }
+        return ok ? 0 : 1;
+    }
 
     auto& v = cmdresult["config_file"].as<std::vector<std::string> >();
     std::string configFileName = v[0];
@@ -124,38 +388,177 @@ int main(int argc, char *argv[])
         exit(1);
     }
 
-    // if an explicit filler cell prefix was not given,
-    // search the cell database for filler cells
+    // search the cell database for filler cells,
+    // or the cells matching the --filler prefix
     FillerHandler fillerHandler;
-    if (cmdresult.count("filler") == 0)
+    if (!getJob(cmdresult).addFillers(lefreader, padring, fillerHandler))
     {
-        for(auto lefCell : padring.m_lefreader.m_cells)
+        exit(1);
+    }
+
+    bool outputRequested = (cmdresult.count("output") > 0) || 
+        (cmdresult.count("oasis") > 0) || 
+        (cmdresult.count("svg") > 0) || 
+        (cmdresult.count("html") > 0) || 
+        (cmdresult.count("png") > 0) || 
+        (cmdresult.count("report") > 0) || 
+        (cmdresult.count("def") > 0) ||
+        (cmdresult.count("save-snapshot") > 0) ||
+        (cmdresult.count("diff") > 0);
+
+    // reuse the outputs of an earlier run with the same
+    // effective inputs. the key is computed before the
+    // die area is changed by --fit.
+    std::unique_ptr<OutputCache> outputCache;
+    if ((cmdresult.count("cache") > 0) && outputRequested)
+    {
+        if ((cmdresult.count("optimize") > 0) || (cmdresult.count("sweep") > 0) ||
+            (cmdresult.count("save-snapshot") > 0) || (cmdresult.count("diff") > 0) ||
+            ((cmdresult.count("def") > 0) && (cmdresult["def"].as<std::string>() == "-")))
+        {
+            doLog(LOG_WARN, "The output cache is not used with --optimize, --sweep, --save-snapshot, --diff or a DEF file on stdout\n");
+        }
+        else
         {
-            if (lefCell.second->m_isFiller) 
+            outputCache.reset(new OutputCache(cmdresult["cache"].as<std::string>()));
+            outputCache->addInput("version", "padring " __PGMVERSION__ " " __BUILDID__);
+            outputCache->addInput("units", std::to_string(LEFDatabaseUnits));
+            outputCache->addPadring(padring, fillerHandler);
+
+            std::ostringstream settings;
+            settings << "fit " << cmdresult.count("fit") 
+                << " no-aref " << cmdresult.count("no-aref")
+                << " gds-hierarchy " << cmdresult.count("gds-hierarchy")
+                << " verify " << cmdresult.count("verify")
+                << " png-size " << ((cmdresult.count("png-size") > 0) ? cmdresult["png-size"].as<uint32_t>() : 0);
+            outputCache->addInput("options", settings.str());
+
+            if (cmdresult.count("merge-gds") > 0)
             {
-                fillerHandler.addFillerCell(lefCell.first, lefCell.second->m_sx);
+                for(auto const &filename : cmdresult["merge-gds"].as<std::vector<std::string>>())
+                {
+                    if (!outputCache->addFileInput("merge-gds", filename))
+                    {
+                        doLog(LOG_ERROR, "Cannot read GDS2 library -- aborting\n");
+                        exit(1);
+                    }
+                }
+            }
+
+            // command line option and output kind
+            const char *outputOptions[][2] = {{"output", "gds2"}, {"oasis", "oasis"}, 
+                {"svg", "svg"}, {"html", "html"}, {"png", "png"}, {"def", "def"}};
+            for(auto option : outputOptions)
+            {
+                if (cmdresult.count(option[0]) > 0)
+                {
+                    outputCache->addOutput(option[1], cmdresult[option[0]].as<std::string>());
+                }
+            }
+            if (cmdresult.count("report") > 0)
+            {
+                std::string reportFileName = cmdresult["report"].as<std::string>();
+                outputCache->addOutput(TextWriter::isJSONFilename(reportFileName) ? "report.json" : "report.csv", reportFileName);
+            }
+
+            if (outputCache->restore())
+            {
+                return 0;
             }
         }
     }
-    else
+
+    // optimize the pad order, if requested
+    if (cmdresult.count("optimize") > 0)
     {
-        // use the provided filler cell prefix to search for filler cells
-        for(auto lefCell : padring.m_lefreader.m_cells)
+        PadOrderOptimizer optimizer(padring);
+        uint64_t moves = (cmdresult.count("opt-moves") > 0) ? cmdresult["opt-moves"].as<uint64_t>() : 1000000;
+        if (optimizer.run((cmdresult.count("threads") > 0) ? cmdresult["threads"].as<uint32_t>() : 0, moves))
+        {
+            optimizer.report();
+        }
+
+        std::string optConfigFileName = cmdresult["optimize"].as<std::string>();
+        std::ofstream optConfigStream(optConfigFileName, std::ofstream::out);
+        if (!optConfigStream.is_open())
         {
-            // match prefix
-            if (lefCell.first.rfind(padring.m_fillerPrefix, 0) == 0) 
+            doLog(LOG_ERROR, "Cannot open configuration file %s for writing\n", optConfigFileName.c_str());
+            exit(1);
+        }
+        doLog(LOG_INFO, "Writing optimized configuration to %s\n", optConfigFileName.c_str());
+        ConfigWriter::write(optConfigStream, padring);
+    }
+
+    // search for the smallest die area, if requested
+    if (cmdresult.count("fit") > 0)
+    {
+        DieFitter fitter(padring, fillerHandler);
+        if (!fitter.fit())
+        {
+            doLog(LOG_ERROR, "Cannot fit the padring -- aborting\n");
+            exit(1);
+        }
+        fitter.report();
+    }
+
+    // evaluate the sweep points, if requested
+    if (cmdresult.count("sweep") > 0)
+    {
+        Sweeper sweeper(padring, fillerHandler);
+        std::ifstream sweepStream(cmdresult["sweep"].as<std::string>(), std::ifstream::in);
+        if (!sweepStream.is_open())
+        {
+            doLog(LOG_ERROR, "Cannot open sweep file %s\n", cmdresult["sweep"].as<std::string>().c_str());
+            exit(1);
+        }
+
+        if (!sweeper.readPoints(sweepStream))
+        {
+            doLog(LOG_ERROR, "Cannot parse sweep file -- aborting\n");
+            exit(1);
+        }
+
+        sweeper.setDatabaseUnits(LEFDatabaseUnits);
+        sweeper.setOutputFilenames(
+            (cmdresult.count("output") > 0) ? cmdresult["output"].as<std::string>() : "",
+            (cmdresult.count("svg") > 0) ? cmdresult["svg"].as<std::string>() : "",
+            (cmdresult.count("def") > 0) ? cmdresult["def"].as<std::string>() : "");
+
+        sweeper.run((cmdresult.count("threads") > 0) ? cmdresult["threads"].as<uint32_t>() : 0);
+
+        if (cmdresult.count("sweep-out") > 0)
+        {
+            std::string resultFileName = cmdresult["sweep-out"].as<std::string>();
+            std::ofstream resultStream(resultFileName, std::ofstream::out);
+            if (!resultStream.is_open())
+            {
+                doLog(LOG_ERROR, "Cannot open sweep results file %s\n", resultFileName.c_str());
+                exit(1);
+            }
+
+            doLog(LOG_INFO, "Writing sweep results to %s\n", resultFileName.c_str());
+            if (TextWriter::isJSONFilename(resultFileName))
+            {
+                sweeper.writeJSON(resultStream);
+            }
+            else
             {
-                fillerHandler.addFillerCell(lefCell.first, lefCell.second->m_sx);
+                sweeper.writeCSV(resultStream);
             }
         }
-    }
+        else
+        {
+            sweeper.writeCSV(std::cout);
+        }
 
-    doLog(LOG_INFO, "Found %d filler cells\n", fillerHandler.getCellCount());
+        doLog(LOG_INFO, "%d of the sweep points failed\n", sweeper.getFailedCount());
+        return (sweeper.getFailedCount() > 0) ? 1 : 0;
+    }
 
-    if (fillerHandler.getCellCount() == 0)
+    // only continue when output files were requested
+    if (((cmdresult.count("fit") > 0) || (cmdresult.count("optimize") > 0)) && !outputRequested)
     {
-        doLog(LOG_ERROR, "Cannot proceed without filler cells. Please use the --filler option to explicitly specify a filler cell prefix\n");
-        exit(1);
+        return 0;
     }
 
     // check die size
@@ -173,238 +576,32 @@ int main(int argc, char *argv[])
     
     padring.doLayout();
 
-    // get corners
-    LayoutItem *topleft  = padring.m_north.getFirstCorner();
-    LayoutItem *topright = padring.m_north.getLastCorner();
-    LayoutItem *bottomleft  = padring.m_south.getFirstCorner();
-    LayoutItem *bottomright = padring.m_south.getLastCorner();
-
-    // write the padring to an SVG file
-    std::ofstream svgos;
-    if (cmdresult.count("svg") != 0)
+    if (cmdresult.count("save-snapshot") > 0)
     {
-        doLog(LOG_INFO,"Writing padring to SVG file: %s\n", cmdresult["svg"].as<std::string>().c_str());
-        svgos.open(cmdresult["svg"].as<std::string>(), std::ofstream::out);
-        if (!svgos.is_open())
+        std::string snapshotFileName = cmdresult["save-snapshot"].as<std::string>();
+        doLog(LOG_INFO, "Writing snapshot to %s\n", snapshotFileName.c_str());
+        if (!Snapshot::save(snapshotFileName, padring, fillerHandler, LEFDatabaseUnits))
         {
-            doLog(LOG_ERROR, "Cannot open SVG file for writing!\n");
             exit(1);
         }
     }
 
-    // write the padring to an DEF file
-    std::ofstream defos;
-    if (cmdresult.count("def") != 0)
+    if ((cmdresult.count("diff") > 0) && !writeDiff(cmdresult, padring, fillerHandler, LEFDatabaseUnits, &lefreader))
     {
-        doLog(LOG_INFO,"Writing padring to DEF file: %s\n", cmdresult["def"].as<std::string>().c_str());
-        defos.open(cmdresult["def"].as<std::string>(), std::ofstream::out);
-        if (!defos.is_open())
-        {
-            doLog(LOG_ERROR, "Cannot open DEF file for writing!\n");
-            exit(1);
-        }
-    }
-
-    SVGWriter svg(svgos, padring.m_dieWidth, padring.m_dieHeight);
-    DEFWriter def(defos, padring.m_dieWidth, padring.m_dieHeight);
-    def.setDatabaseUnits(LEFDatabaseUnits);
-    def.setDesignName(padring.m_designName);
-
-    // emit GDS2 and SVG
-    GDS2Writer *writer = nullptr;
-    
-    if (cmdresult.count("output")> 0)
-    {
-        doLog(LOG_INFO,"Writing padring to GDS2 file: %s\n", cmdresult["output"].as<std::string>().c_str());
-        writer = GDS2Writer::open(cmdresult["output"].as<std::string>(),
-            padring.m_designName);
-    }
-    
-    if (writer != nullptr) writer->writeCell(topleft);
-    if (writer != nullptr) writer->writeCell(topright);
-    if (writer != nullptr) writer->writeCell(bottomleft);
-    if (writer != nullptr) writer->writeCell(bottomright);
-
-    svg.writeCell(topleft);
-    svg.writeCell(topright);
-    svg.writeCell(bottomleft);
-    svg.writeCell(bottomright);
-
-    def.writeCell(topleft);
-    def.writeCell(topright);
-    def.writeCell(bottomleft);
-    def.writeCell(bottomright);
-
-    double north_y = padring.m_dieHeight;
-    for(auto item : padring.m_north)
-    {
-        if (item->m_ltype == LayoutItem::TYPE_CELL)
-        {
-            if (writer != nullptr) writer->writeCell(item);
-            svg.writeCell(item);
-            def.writeCell(item);
-        }
-        else if ((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
-        {
-            // do fillers
-            double space = item->m_size;
-            double pos = item->m_x;
-            while(space > 0)
-            {
-                std::string cellName;
-                double width = fillerHandler.getFillerCell(space, cellName);
-                if (width > 0.0)
-                {
-                    LayoutItem filler(LayoutItem::TYPE_FILLER);
-                    filler.m_cellname = cellName;
-                    filler.m_x = pos;
-                    filler.m_y = north_y;
-                    filler.m_size = width;
-                    filler.m_location = "N";
-                    filler.m_lefinfo = padring.m_lefreader.getCellByName(cellName);
-                    if (writer != nullptr) writer->writeCell(&filler);
-                    svg.writeCell(&filler);
-                    def.writeCell(&filler);
-                    space -= width;
-                    pos += width;
-                }
-                else
-                {
-                    doLog(LOG_ERROR, "Cannot find filler cell that fits remaining width %f\n", space);
-                    exit(1);
-                }
-            }
-        }        
-    }
-
-    double south_y = 0;
-    for(auto item : padring.m_south)
-    {
-        if (item->m_ltype == LayoutItem::TYPE_CELL)
-        {
-            if (writer != nullptr) writer->writeCell(item);
-            svg.writeCell(item);  
-            def.writeCell(item);          
-        }
-        else if ((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
-        {
-            // do fillers
-            double space = item->m_size;
-            double pos = item->m_x;
-            while(space > 0)
-            {
-                std::string cellName;
-                double width = fillerHandler.getFillerCell(space, cellName);
-                if (width > 0.0)
-                {
-                    LayoutItem filler(LayoutItem::TYPE_FILLER);
-                    filler.m_cellname = cellName;
-                    filler.m_x = pos;
-                    filler.m_y = south_y;
-                    filler.m_size = width;
-                    filler.m_location = "S";
-                    filler.m_lefinfo = padring.m_lefreader.getCellByName(cellName);
-                    if (writer != nullptr) writer->writeCell(&filler);
-                    svg.writeCell(&filler);
-                    def.writeCell(&filler);
-                    space -= width;
-                    pos += width;
-                }
-                else
-                {
-                    doLog(LOG_ERROR, "Cannot find filler cell that fits remaining width %f\n", space);
-                    exit(1);
-                }
-            }
-        }        
+        exit(1);
     }
 
-    double west_x = 0;
-    for(auto item : padring.m_west)
+    // emit GDS2, SVG and DEF
+    if (!writeOutputs(cmdresult, padring, fillerHandler, LEFDatabaseUnits))
     {
-        if (item->m_ltype == LayoutItem::TYPE_CELL)
-        {
-            if (writer != nullptr) writer->writeCell(item);
-            svg.writeCell(item);
-            def.writeCell(item);
-        }
-        else if ((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
-        {
-            // do fillers
-            double space = item->m_size;
-            double pos = item->m_y;
-            while(space > 0)
-            {
-                std::string cellName;
-                double width = fillerHandler.getFillerCell(space, cellName);
-                if (width > 0.0)
-                {
-                    LayoutItem filler(LayoutItem::TYPE_FILLER);
-                    filler.m_cellname = cellName;
-                    filler.m_x = west_x;
-                    filler.m_y = pos;
-                    filler.m_size = width;
-                    filler.m_location = "W";
-                    filler.m_lefinfo = padring.m_lefreader.getCellByName(cellName);
-                    if (writer != nullptr) writer->writeCell(&filler);
-                    svg.writeCell(&filler);
-                    def.writeCell(&filler);
-                    space -= width;
-                    pos += width;
-                }
-                else
-                {
-                    doLog(LOG_ERROR, "Cannot find filler cell that fits remaining width %f\n", space);
-                    exit(1);
-                }
-            }
-        }        
+        exit(1);
     }
 
-    double east_x = padring.m_dieWidth;
-    for(auto item : padring.m_east)
+    if (outputCache)
     {
-        if (item->m_ltype == LayoutItem::TYPE_CELL)
-        {
-            if (writer != nullptr) writer->writeCell(item);
-            svg.writeCell(item);
-            def.writeCell(item);
-        }
-        else if ((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
-        {
-            // do fillers
-            double space = item->m_size;
-            double pos = item->m_y;
-            while(space > 0)
-            {
-                std::string cellName;
-                double width = fillerHandler.getFillerCell(space, cellName);
-                if (width > 0.0)
-                {
-                    LayoutItem filler(LayoutItem::TYPE_FILLER);
-                    filler.m_cellname = cellName;
-                    filler.m_x = east_x;
-                    filler.m_y = pos;
-                    filler.m_size = width;
-                    filler.m_location = "E";
-                    filler.m_lefinfo = padring.m_lefreader.getCellByName(cellName);
-                    if (writer != nullptr) writer->writeCell(&filler);
-                    svg.writeCell(&filler);
-                    def.writeCell(&filler);
-                    space -= width;
-                    pos += width;
-                }
-                else
-                {
-                    doLog(LOG_ERROR, "Cannot find filler cell that fits remaining width %f\n", space);
-                    exit(1);
-                }
-            }
-        }        
+        outputCache->store();
     }
 
-    if (writer != nullptr) delete writer;
-
     for(auto cell : padring.m_lefreader.m_cells)
     {
         DebugUtils::dumpToConsole(cell.second);
@@ -0,0 +1,316 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include "../logging.h"
+#include "../gds2/gds2writer.h"
+#include "oasiswriter.h"
+
+// OASIS record ids
+enum oasisRecord_t
+{
+    OASIS_START       = 1,
+    OASIS_END         = 2,
+    OASIS_CELLNAME    = 3,
+    OASIS_CELL_REF    = 13,
+    OASIS_XYRELATIVE  = 16,
+    OASIS_PLACEMENT   = 17
+};
+
+// OASIS repetition types
+enum oasisRepetition_t
+{
+    OASIS_REP_REUSE   = 0,
+    OASIS_REP_ROW     = 2,      ///< uniform row along the x axis
+    OASIS_REP_COLUMN  = 3       ///< uniform column along the y axis
+};
+
+OASISWriter* OASISWriter::open(const std::string &filename, const std::string &designName)
+{
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (f == nullptr)
+    {
+        return nullptr;
+    }
+
+    return new OASISWriter(f, designName);
+}
+
+OASISWriter::OASISWriter(FILE *f, const std::string &designName) 
+    : m_fout(f), 
+      m_designName(designName)
+{
+    doLog(LOG_VERBOSE,"OASISWriter created\n");
+}
+
+OASISWriter::~OASISWriter()
+{
+    if (m_fout != nullptr)
+    {
+        fclose(m_fout);
+    }
+    doLog(LOG_VERBOSE,"OASISWriter destroyed\n");
+}
+
+bool OASISWriter::close()
+{
+    if (m_fout == nullptr)
+    {
+        return true;
+    }
+
+    bool ok = writeFile();
+    if (fclose(m_fout) != 0)
+    {
+        ok = false;
+    }
+    m_fout = nullptr;
+    return ok;
+}
+
+void OASISWriter::writeCell(const LayoutItem *item)
+{
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    if (!m_cells)
+    {
+        m_cells = std::make_shared<PlacementBlock>();
+        m_blocks.push_back(m_cells);
+    }
+    m_cells->push_back(*item);
+}
+
+void OASISWriter::writeBlock(const std::shared_ptr<const PlacementBlock> &block)
+{
+    m_cells.reset();
+    m_blocks.push_back(block);
+}
+
+void OASISWriter::putUnsigned(uint64_t v)
+{
+    // 7 bits per byte, least significant first
+    while(v >= 0x80)
+    {
+        m_data.push_back(static_cast<uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    m_data.push_back(static_cast<uint8_t>(v));
+}
+
+void OASISWriter::putSigned(int64_t v)
+{
+    // the sign is stored in the least significant bit
+    uint64_t magnitude = (v < 0) ? -static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+    putUnsigned((magnitude << 1) | ((v < 0) ? 1 : 0));
+}
+
+void OASISWriter::putString(const std::string &str)
+{
+    putUnsigned(str.size());
+    m_data.insert(m_data.end(), str.begin(), str.end());
+}
+
+uint64_t OASISWriter::getCellRef(const std::string &cellName)
+{
+    auto iter = m_nameRefs.find(cellName);
+    if (iter != m_nameRefs.end())
+    {
+        return iter->second;
+    }
+
+    uint64_t ref = m_names.size();
+    m_names.push_back(cellName);
+    m_nameRefs[cellName] = ref;
+    return ref;
+}
+
+OASISWriter::Placement OASISWriter::toPlacement(const LayoutItem *item)
+{
+    double px, py;
+    Placement p;
+    GDS2Writer::getTransform(item, px, py, p.m_rot, p.m_flip);
+
+    // same rounding as GDS2Writer
+    p.m_cellRef = getCellRef(item->m_cellname);
+    p.m_x = static_cast<int32_t>(static_cast<uint32_t>(px*1000.0));
+    p.m_y = static_cast<int32_t>(static_cast<uint32_t>(py*1000.0));
+    return p;
+}
+
+size_t OASISWriter::getRun(const LayoutItem *items, const Placement *placements, size_t count)
+{
+    if ((count < 2) || !GDS2Writer::isRunContinuation(&items[0], &items[1]))
+    {
+        return 1;
+    }
+
+    // the repetition needs a uniform spacing 
+    // in database units.
+    int64_t dx = placements[1].m_x - placements[0].m_x;
+    int64_t dy = placements[1].m_y - placements[0].m_y;
+    if (!(((dx > 0) && (dy == 0)) || ((dx == 0) && (dy > 0))))
+    {
+        return 1;
+    }
+
+    size_t run = 2;
+    while((run < count) && GDS2Writer::isRunContinuation(&items[run-1], &items[run]) &&
+        (placements[run].m_x == (placements[run-1].m_x + dx)) &&
+        (placements[run].m_y == (placements[run-1].m_y + dy)))
+    {
+        run++;
+    }
+    return run;
+}
+
+void OASISWriter::writePlacement(const Placement &p, uint64_t count, int64_t dx, int64_t dy)
+{
+    bool writeCellRef = !m_hasCell || (m_cellRef != p.m_cellRef);
+    int64_t relx = p.m_x - m_x;
+    int64_t rely = p.m_y - m_y;
+
+    // info byte: CNXYRAAF
+    uint8_t info = static_cast<uint8_t>(((p.m_rot / 90) & 3) << 1);
+    if (writeCellRef) info |= 0xC0;
+    if (relx != 0)    info |= 0x20;
+    if (rely != 0)    info |= 0x10;
+    if (count > 1)    info |= 0x08;
+    if (p.m_flip)     info |= 0x01;
+
+    putByte(OASIS_PLACEMENT);
+    putByte(info);
+    if (writeCellRef) putUnsigned(p.m_cellRef);
+    if (relx != 0) putSigned(relx);
+    if (rely != 0) putSigned(rely);
+
+    if (count > 1)
+    {
+        uint64_t repType  = (dx > 0) ? OASIS_REP_ROW : OASIS_REP_COLUMN;
+        int64_t  repSpace = (dx > 0) ? dx : dy;
+        if (m_hasRepetition && (m_repType == repType) && 
+            (m_repCount == count) && (m_repSpace == repSpace))
+        {
+            putUnsigned(OASIS_REP_REUSE);
+        }
+        else
+        {
+            putUnsigned(repType);
+            putUnsigned(count - 2);
+            putUnsigned(repSpace);
+        }
+        m_hasRepetition = true;
+        m_repType  = repType;
+        m_repCount = count;
+        m_repSpace = repSpace;
+    }
+
+    m_hasCell = true;
+    m_cellRef = p.m_cellRef;
+    m_x = p.m_x;
+    m_y = p.m_y;
+}
+
+bool OASISWriter::writeFile()
+{
+    // convert to database units and fill
+    // the name table, the design first.
+    uint64_t designRef = getCellRef(m_designName);
+    std::vector<std::vector<Placement> > placements(m_blocks.size());
+    for(size_t i=0; i<m_blocks.size(); i++)
+    {
+        placements[i].reserve(m_blocks[i]->size());
+        for(auto const &item : *m_blocks[i])
+        {
+            placements[i].push_back(toPlacement(&item));
+        }
+    }
+
+    // magic and START record: version 1.0, 1000 database 
+    // units per micron, table offsets in this record.
+    const std::string magic = "%SEMI-OASIS\r\n";
+    m_data.insert(m_data.end(), magic.begin(), magic.end());
+    putByte(OASIS_START);
+    putString("1.0");
+    putUnsigned(0);         // real: positive whole number
+    putUnsigned(1000);
+    putUnsigned(0);         // offset-flag
+    for(uint32_t i=0; i<12; i++)
+    {
+        putUnsigned(0);     // no strict name tables
+    }
+
+    // the name table
+    for(auto const &name : m_names)
+    {
+        putByte(OASIS_CELLNAME);
+        putString(name);
+    }
+
+    // the top cell resets all the modal variables
+    putByte(OASIS_CELL_REF);
+    putUnsigned(designRef);
+    putByte(OASIS_XYRELATIVE);
+    m_hasCell = false;
+    m_hasRepetition = false;
+    m_x = 0;
+    m_y = 0;
+
+    size_t records = 0;
+    size_t repetitions = 0;
+    for(size_t i=0; i<m_blocks.size(); i++)
+    {
+        if (m_blocks[i]->empty())
+        {
+            continue;
+        }
+
+        const LayoutItem *items = m_blocks[i]->data();
+        const Placement  *p = placements[i].data();
+        size_t count = placements[i].size();
+        size_t idx = 0;
+        while(idx < count)
+        {
+            size_t run = getRun(items + idx, p + idx, count - idx);
+            if (run > 1)
+            {
+                writePlacement(p[idx], run, p[idx+1].m_x - p[idx].m_x, p[idx+1].m_y - p[idx].m_y);
+                repetitions++;
+            }
+            else
+            {
+                writePlacement(p[idx], 1, 0, 0);
+            }
+            records++;
+            idx += run;
+        }
+    }
+
+    doLog(LOG_VERBOSE, "OASIS: %zu placement records, %zu with a repetition\n", records, repetitions);
+
+    // END record, padded to 256 bytes: 
+    // id + 2-byte length + padding + validation scheme.
+    putByte(OASIS_END);
+    putUnsigned(252);
+    m_data.insert(m_data.end(), 252, 0);
+    putUnsigned(0);         // no validation
+
+    return (fwrite(m_data.data(), 1, m_data.size(), m_fout) == m_data.size());
+}
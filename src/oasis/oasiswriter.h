@@ -0,0 +1,130 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef oasiswriter_h
+#define oasiswriter_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+
+#include "../outputsink.h"
+
+/** A minimal OASIS writer.
+
+    The placement records are collected and written as
+    a single top cell when the writer is closed:
+
+    - all the cell names are written to a name table of
+      CELLNAME records, so placements refer to a cell 
+      by number.
+    - coordinates are written in relative mode as signed
+      varints, so they are mostly small deltas.
+    - the cell, position and repetition are modal: they
+      are only written when they change.
+    - runs of fillers are written as a single placement
+      with a uniform row or column repetition.
+
+    Positions are rounded to database units the same way 
+    as GDS2Writer does, so both files hold the same 
+    placements.
+*/
+class OASISWriter : public OutputSink
+{
+public:
+    /** open an OASIS file for writing. returns nullptr
+        if the file cannot be created.
+    */
+    static OASISWriter* open(
+        const std::string &filename,
+        const std::string &designName);
+
+    /** closes the file, if the writer was not closed */
+    virtual ~OASISWriter();
+
+    void writeCell(const LayoutItem *item) override;
+    void writeBlock(const std::shared_ptr<const PlacementBlock> &block) override;
+
+    /** writes the file and closes it.
+        returns false on an I/O error. */
+    bool close() override;
+
+protected:
+    OASISWriter(FILE *f, const std::string &designName);
+
+    /** a placement in database units */
+    struct Placement
+    {
+        uint64_t    m_cellRef;  ///< cell name reference number
+        uint32_t    m_rot;      ///< rotation in degrees
+        bool        m_flip;     ///< reflection about the x axis
+        int64_t     m_x;
+        int64_t     m_y;
+    };
+
+    /** get the reference number of a cell name,
+        adding it to the name table if needed. */
+    uint64_t getCellRef(const std::string &cellName);
+
+    Placement toPlacement(const LayoutItem *item);
+
+    /** get the number of placements at the start of the
+        array that can be written as one placement with
+        a uniform repetition. */
+    size_t getRun(const LayoutItem *items, const Placement *placements, size_t count);
+
+    /** returns false on an I/O error */
+    bool writeFile();
+    void writePlacement(const Placement &p, uint64_t count, int64_t dx, int64_t dy);
+
+    void putByte(uint8_t v)
+    {
+        m_data.push_back(v);
+    }
+
+    void putUnsigned(uint64_t v);
+    void putSigned(int64_t v);
+    void putString(const std::string &str);
+
+    FILE        *m_fout;        ///< OASIS file handle
+    std::string m_designName;
+
+    std::vector<std::shared_ptr<const PlacementBlock> > m_blocks;
+    std::shared_ptr<PlacementBlock> m_cells;   ///< cells written one by one
+
+    std::vector<std::string> m_names;          ///< name table, in reference number order
+    std::unordered_map<std::string, uint64_t> m_nameRefs;
+
+    // modal variables
+    bool        m_hasCell;
+    uint64_t    m_cellRef;
+    int64_t     m_x;
+    int64_t     m_y;
+    bool        m_hasRepetition;
+    uint64_t    m_repType;
+    uint64_t    m_repCount;
+    int64_t     m_repSpace;
+
+    std::vector<uint8_t> m_data;    ///< encoded records
+};
+
+#endif
@@ -0,0 +1,319 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <stdio.h>
+#include <cerrno>
+#include <sstream>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "logging.h"
+#include "sha256.h"
+#include "configwriter.h"
+#include "gzipwriter.h"
+#include "outputcache.h"
+
+void OutputCache::addInput(const std::string &name, const std::string &value)
+{
+    // length-prefixed, so values can hold any text
+    m_inputs += name + " " + std::to_string(value.size()) + "\n";
+    m_inputs += value;
+    m_inputs += "\n";
+}
+
+bool OutputCache::addFileInput(const std::string &name, const std::string &filename)
+{
+    std::string digest;
+    uint64_t bytes;
+    if (!SHA256::hashFile(filename, digest, bytes))
+    {
+        doLog(LOG_ERROR, "Cannot read %s\n", filename.c_str());
+        return false;
+    }
+
+    addInput(name, digest);
+    return true;
+}
+
+void OutputCache::addPadring(PadringDB &padring, const FillerHandler &fillers)
+{
+    std::ostringstream config;
+    ConfigWriter::write(config, padring);
+    addInput("config", config.str());
+
+    // only the LEF records of the cells that are
+    // placed take part in the key.
+    std::set<std::string> cellNames;
+    Layout *edges[4] = {&padring.m_north, &padring.m_south, &padring.m_east, &padring.m_west};
+    for(auto edge : edges)
+    {
+        for(auto item : *edge)
+        {
+            if (item->m_lefinfo != nullptr)
+            {
+                cellNames.insert(item->m_cellname);
+            }
+        }
+
+        if (edge->getFirstCorner() != nullptr)
+        {
+            cellNames.insert(edge->getFirstCorner()->m_cellname);
+        }
+        if (edge->getLastCorner() != nullptr)
+        {
+            cellNames.insert(edge->getLastCorner()->m_cellname);
+        }
+    }
+
+    for(auto const &name : fillers.getCellNames())
+    {
+        cellNames.insert(name);
+    }
+
+    std::ostringstream cells;
+    cells.precision(std::numeric_limits<double>::max_digits10);
+    for(auto const &name : cellNames)
+    {
+        const PRLEFReader::LEFCellInfo_t *cell = padring.m_lefreader.getCellByName(name);
+        if (cell == nullptr)
+        {
+            cells << name << " missing\n";
+            continue;
+        }
+
+        cells << name << " " << cell->m_foreign << " " << cell->m_sx << " " << cell->m_sy 
+            << " " << cell->m_symmetry << " " << (cell->m_isFiller ? 1 : 0) << "\n";
+    }
+    addInput("cells", cells.str());
+}
+
+void OutputCache::addOutput(const std::string &kind, const std::string &filename)
+{
+    // compressed files are different outputs
+    Output output;
+    output.m_kind     = GzipWriter::isGzipFilename(filename) ? (kind + ".gz") : kind;
+    output.m_filename = filename;
+    m_outputs.push_back(output);
+    addInput("output", output.m_kind);
+}
+
+std::string OutputCache::getKey() const
+{
+    SHA256 sha;
+    sha.update(m_inputs);
+    return sha.hexDigest();
+}
+
+bool OutputCache::readManifest(const std::string &entry, Manifest &manifest)
+{
+    std::ifstream is(entry + "/outputs");
+    if (!is.is_open())
+    {
+        return false;
+    }
+
+    std::string line;
+    while(std::getline(is, line))
+    {
+        std::istringstream fields(line);
+        std::string kind;
+        ManifestItem item;
+        if (!(fields >> kind >> item.m_digest >> item.m_bytes))
+        {
+            return false;
+        }
+        manifest[kind] = item;
+    }
+    return true;
+}
+
+bool OutputCache::linkOrCopy(const std::string &from, const std::string &to)
+{
+    if ((unlink(to.c_str()) != 0) && (errno != ENOENT))
+    {
+        return false;
+    }
+
+    if (link(from.c_str(), to.c_str()) == 0)
+    {
+        return true;
+    }
+
+    // different file systems, or no hard 
+    // links at all: copy the file.
+    FILE *fin = fopen(from.c_str(), "rb");
+    if (fin == nullptr)
+    {
+        return false;
+    }
+
+    FILE *fout = fopen(to.c_str(), "wb");
+    if (fout == nullptr)
+    {
+        fclose(fin);
+        return false;
+    }
+
+    std::vector<char> buffer(1024*1024);
+    bool ok = true;
+    size_t n;
+    while(ok && ((n = fread(&buffer[0], 1, buffer.size(), fin)) > 0))
+    {
+        ok = (fwrite(&buffer[0], 1, n, fout) == n);
+    }
+
+    ok = ok && (ferror(fin) == 0);
+    fclose(fin);
+    return (fclose(fout) == 0) && ok;
+}
+
+void OutputCache::removeEntry(const std::string &entry)
+{
+    DIR *dir = opendir(entry.c_str());
+    if (dir != nullptr)
+    {
+        struct dirent *file;
+        while((file = readdir(dir)) != nullptr)
+        {
+            std::string name = file->d_name;
+            if ((name != ".") && (name != ".."))
+            {
+                unlink((entry + "/" + name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+    rmdir(entry.c_str());
+}
+
+bool OutputCache::restore()
+{
+    std::string key = getKey();
+    std::string entry = m_directory + "/" + key;
+
+    Manifest manifest;
+    if (!readManifest(entry, manifest))
+    {
+        doLog(LOG_INFO, "Output cache miss: %s\n", key.c_str());
+        return false;
+    }
+
+    // check the cached files against their digests
+    // before any output file is replaced.
+    for(auto const &output : m_outputs)
+    {
+        auto iter = manifest.find(output.m_kind);
+        std::string digest;
+        uint64_t bytes;
+        if ((iter == manifest.end()) || 
+            !SHA256::hashFile(entry + "/" + output.m_kind, digest, bytes) ||
+            (digest != iter->second.m_digest) || (bytes != iter->second.m_bytes))
+        {
+            doLog(LOG_WARN, "Output cache entry %s is damaged and will be replaced\n", key.c_str());
+            removeEntry(entry);
+            return false;
+        }
+    }
+
+    doLog(LOG_INFO, "Output cache hit: %s\n", key.c_str());
+    for(auto const &output : m_outputs)
+    {
+        doLog(LOG_INFO, "Restoring %s file: %s\n", output.m_kind.c_str(), output.m_filename.c_str());
+        if (!linkOrCopy(entry + "/" + output.m_kind, output.m_filename))
+        {
+            doLog(LOG_ERROR, "Cannot write %s\n", output.m_filename.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool OutputCache::store()
+{
+    if ((mkdir(m_directory.c_str(), 0777) != 0) && (errno != EEXIST))
+    {
+        doLog(LOG_WARN, "Cannot create the output cache directory %s\n", m_directory.c_str());
+        return false;
+    }
+
+    // fill a temporary directory and rename it, so other
+    // processes never see an incomplete entry.
+    std::string tempEntry = m_directory + "/tmp.XXXXXX";
+    if (mkdtemp(&tempEntry[0]) == nullptr)
+    {
+        doLog(LOG_WARN, "Cannot create an output cache entry in %s\n", m_directory.c_str());
+        return false;
+    }
+
+    std::ostringstream manifest;
+    bool ok = true;
+    for(auto const &output : m_outputs)
+    {
+        std::string digest;
+        uint64_t bytes;
+        if (!SHA256::hashFile(output.m_filename, digest, bytes) ||
+            !linkOrCopy(output.m_filename, tempEntry + "/" + output.m_kind))
+        {
+            ok = false;
+            break;
+        }
+        manifest << output.m_kind << " " << digest << " " << bytes << "\n";
+    }
+
+    if (ok)
+    {
+        std::ofstream inputsStream(tempEntry + "/inputs", std::ofstream::out | std::ofstream::binary);
+        inputsStream << m_inputs;
+        inputsStream.close();
+
+        std::ofstream manifestStream(tempEntry + "/outputs", std::ofstream::out | std::ofstream::binary);
+        manifestStream << manifest.str();
+        manifestStream.close();
+        ok = !inputsStream.fail() && !manifestStream.fail();
+    }
+
+    if (!ok)
+    {
+        doLog(LOG_WARN, "Cannot store the outputs in the output cache\n");
+        removeEntry(tempEntry);
+        return false;
+    }
+
+    // another process may have stored the 
+    // same entry in the meantime.
+    std::string key = getKey();
+    if (rename(tempEntry.c_str(), (m_directory + "/" + key).c_str()) != 0)
+    {
+        bool stored = (errno == EEXIST) || (errno == ENOTEMPTY);
+        removeEntry(tempEntry);
+        if (!stored)
+        {
+            doLog(LOG_WARN, "Cannot store the outputs in the output cache\n");
+            return false;
+        }
+        doLog(LOG_VERBOSE, "Output cache entry %s was stored by another process\n", key.c_str());
+        return true;
+    }
+
+    doLog(LOG_VERBOSE, "Stored the outputs in output cache entry %s\n", key.c_str());
+    return true;
+}
@@ -0,0 +1,114 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef outputcache_h
+#define outputcache_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "padringdb.h"
+#include "fillerhandler.h"
+
+/** A content-addressed cache of generated output files.
+
+    The key is the SHA-256 digest of the effective inputs:
+    the tool version, the normalised configuration, the LEF
+    records of the cells that are used, the options and the
+    requested output formats. Every entry is a directory named
+    after its key that holds the output files, the inputs the
+    key was computed from and a manifest with the SHA-256
+    digest and size of every output.
+
+    On a hit, the cached files are hard linked (or copied,
+    across file systems) to the requested output filenames
+    instead of laying out the padring again. PadringWriter
+    never writes into a file that has more than one link, 
+    so the cache entries are not changed by later runs.
+*/
+class OutputCache
+{
+public:
+    OutputCache(const std::string &directory) : m_directory(directory) {}
+
+    /** add a named input to the key */
+    void addInput(const std::string &name, const std::string &value);
+
+    /** add the digest of the contents of a file to the key.
+        returns false if the file cannot be read. */
+    bool addFileInput(const std::string &name, const std::string &filename);
+
+    /** add the normalised configuration and the LEF records
+        of the corners, pads and filler cells to the key. */
+    void addPadring(PadringDB &padring, const FillerHandler &fillers);
+
+    /** add an output file. the kind, e.g. "gds2", and whether
+        the file is compressed are part of the key, the 
+        filename is not. */
+    void addOutput(const std::string &kind, const std::string &filename);
+
+    /** return the key: the hex digest of the inputs */
+    std::string getKey() const;
+
+    /** link or copy the outputs of a matching cache entry
+        to the output files. returns false when there is no
+        valid entry; the outputs must be generated then.
+    */
+    bool restore();
+
+    /** store the generated output files in a new cache 
+        entry, with their digests.
+        returns false if the entry cannot be written. 
+    */
+    bool store();
+
+protected:
+    struct Output
+    {
+        std::string m_kind;
+        std::string m_filename;
+    };
+
+    /** an output of a cache entry, as listed in the manifest */
+    struct ManifestItem
+    {
+        std::string m_digest;
+        uint64_t    m_bytes;
+    };
+
+    typedef std::map<std::string, ManifestItem> Manifest;
+
+    /** read the manifest of a cache entry, keyed on the output kind */
+    static bool readManifest(const std::string &entry, Manifest &manifest);
+
+    /** hard link a file, or copy it when that fails. an existing
+        destination file is replaced. */
+    static bool linkOrCopy(const std::string &from, const std::string &to);
+
+    /** remove a cache entry directory and the files in it */
+    static void removeEntry(const std::string &entry);
+
+    std::string         m_directory;    ///< the cache directory
+    std::string         m_inputs;       ///< the text the key is computed from
+    std::vector<Output> m_outputs;
+};
+
+#endif
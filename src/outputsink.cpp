@@ -0,0 +1,138 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include "outputsink.h"
+
+OutputSink::orientation_t OutputSink::getPlacedBox(const LayoutItem *item, 
+    double &x, double &y, double &width, double &height)
+{
+    x = item->m_x;
+    y = item->m_y;
+    double sx = item->m_lefinfo->m_sx;
+    double sy = item->m_lefinfo->m_sy;
+    orientation_t orientation;
+
+    if (item->m_location == "NW")
+    {
+        y -= sx;
+        orientation = ORIENT_E;
+    }
+    else if (item->m_location == "SE")
+    {
+        orientation = ORIENT_W;
+    }
+    else if (item->m_location == "NE")
+    {
+        y -= sy;
+        orientation = ORIENT_S;
+    }
+    else if (item->m_location == "SW")
+    {
+        orientation = ORIENT_N;
+    }
+    else if (item->m_location == "E")
+    {
+        x -= sy;
+        orientation = item->m_flipped ? ORIENT_FE : ORIENT_W;
+    }
+    else if (item->m_location == "N")
+    {
+        y -= sy;
+        orientation = item->m_flipped ? ORIENT_FS : ORIENT_S;
+    }
+    else if (item->m_location == "S")
+    {
+        orientation = item->m_flipped ? ORIENT_FN : ORIENT_N;
+    }
+    else
+    {
+        orientation = item->m_flipped ? ORIENT_W : ORIENT_E;
+    }
+
+    // east and west orientations swap width and height
+    bool rotated = ((orientation & 3) >= 2);
+    width  = rotated ? sy : sx;
+    height = rotated ? sx : sy;
+    return orientation;
+}
+
+const char* OutputSink::getOrientationName(orientation_t orientation)
+{
+    static const char *names[] = {"N","S","E","W","FN","FS","FE","FW"};
+    return names[orientation];
+}
+
+OutputSinkThread::OutputSinkThread(OutputSink *sink, size_t maxBlocks) 
+    : m_sink(sink), 
+      m_maxBlocks(maxBlocks),
+      m_done(false)
+{
+    m_thread = std::thread([this]() { run(); });
+}
+
+OutputSinkThread::~OutputSinkThread()
+{
+    finish();
+}
+
+void OutputSinkThread::push(std::shared_ptr<const PlacementBlock> block)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notFull.wait(lock, [this]() { return m_queue.size() < m_maxBlocks; });
+        m_queue.push_back(std::move(block));
+    }
+    m_notEmpty.notify_one();
+}
+
+void OutputSinkThread::finish()
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done = true;
+    }
+    m_notEmpty.notify_one();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+void OutputSinkThread::run()
+{
+    while(true)
+    {
+        std::shared_ptr<const PlacementBlock> block;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this]() { return m_done || !m_queue.empty(); });
+            if (m_queue.empty())
+            {
+                // done and nothing left to write
+                return;
+            }
+            block = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        m_notFull.notify_one();
+
+        m_sink->writeBlock(block);
+    }
+}
@@ -0,0 +1,123 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef outputsink_h
+#define outputsink_h
+
+#include <stdint.h>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "layout.h"
+
+/** A block of placement records that is shared,
+    read-only, by all the sink threads. */
+typedef std::vector<LayoutItem> PlacementBlock;
+
+/** Common interface of all the padring output writers.
+    A sink receives the placed cells, corners and
+    fillers in emission order.
+*/
+class OutputSink
+{
+public:
+    virtual ~OutputSink() {}
+
+    /** write a placed cell, corner or filler */
+    virtual void writeCell(const LayoutItem *item) = 0;
+
+    /** write a block of placement records. 
+        sinks may keep a reference to the block.
+    */
+    virtual void writeBlock(const std::shared_ptr<const PlacementBlock> &block)
+    {
+        for(auto const &item : *block)
+        {
+            writeCell(&item);
+        }
+    }
+
+    /** finish the output after the last cell, e.g. write
+        the footer or encode the file, and close it.
+        returns false on an I/O error. a sink that is
+        destroyed without being closed leaves an 
+        incomplete output.
+    */
+    virtual bool close()
+    {
+        return true;
+    }
+
+    /** DEF orientations, as returned by getPlacedBox */
+    enum orientation_t
+    {
+        ORIENT_N = 0, ORIENT_S, ORIENT_E, ORIENT_W,
+        ORIENT_FN, ORIENT_FS, ORIENT_FE, ORIENT_FW
+    };
+
+    /** get the bounding box of a placed cell, in microns,
+        and its orientation, as written to the DEF file. 
+    */
+    static orientation_t getPlacedBox(const LayoutItem *item, double &x, double &y, 
+        double &width, double &height);
+
+    /** get the DEF name of an orientation, e.g. "FN" */
+    static const char* getOrientationName(orientation_t orientation);
+};
+
+/** Feeds placement blocks to an output sink on a
+    separate thread. The blocks are queued, so the
+    producer only blocks when the sink falls behind 
+    by more than maxBlocks blocks.
+*/
+class OutputSinkThread
+{
+public:
+    OutputSinkThread(OutputSink *sink, size_t maxBlocks = 16);
+
+    /** finishes the queued blocks and stops the thread.
+        the sink itself is not deleted.
+    */
+    virtual ~OutputSinkThread();
+
+    /** queue a block of placement records */
+    void push(std::shared_ptr<const PlacementBlock> block);
+
+    /** write all the queued blocks and stop the thread */
+    void finish();
+
+protected:
+    void run();
+
+    OutputSink  *m_sink;
+    size_t      m_maxBlocks;
+    bool        m_done;
+
+    std::deque<std::shared_ptr<const PlacementBlock> > m_queue;
+    std::mutex              m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+    std::thread             m_thread;
+};
+
+#endif
@@ -0,0 +1,362 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include "logging.h"
+#include "threadpool.h"
+#include "padorderoptimizer.h"
+
+PadOrderOptimizer::PadOrderOptimizer(PadringDB &padring) : m_padring(padring),
+    m_initialCost(0), m_initialBreaks(0),
+    m_finalCost(0), m_finalBreaks(0),
+    m_totalMoves(0), m_seconds(0.0)
+{
+    // map each instance to its group
+    std::unordered_map<std::string, int32_t> groupOf;
+    for(size_t i=0; i<padring.m_groups.size(); i++)
+    {
+        for(auto const &instance : padring.m_groups[i].second)
+        {
+            groupOf[instance] = static_cast<int32_t>(i);
+        }
+    }
+
+    std::unordered_map<int32_t, std::string> edgeOfGroup;
+    Layout *layouts[4] = {&padring.m_north, &padring.m_south, &padring.m_east, &padring.m_west};
+    for(auto layout : layouts)
+    {
+        Edge edge;
+        edge.m_layout = layout;
+
+        std::vector<bool> pinned;
+        bool pinNext = false;
+        for(auto item : *layout)
+        {
+            if (item->m_ltype == LayoutItem::TYPE_CELL)
+            {
+                edge.m_cells.push_back(item);
+                pinned.push_back(pinNext);
+                pinNext = false;
+            }
+            else if (item->m_ltype == LayoutItem::TYPE_FIXEDSPACE)
+            {
+                // keep the cells on both sides of an
+                // explicit space in place.
+                if (!pinned.empty())
+                {
+                    pinned.back() = true;
+                }
+                pinNext = true;
+            }
+        }
+
+        for(size_t i=0; i<edge.m_cells.size(); i++)
+        {
+            auto iter = groupOf.find(edge.m_cells[i]->m_instance);
+            int32_t group = (iter != groupOf.end()) ? iter->second : -1;
+            edge.m_group.push_back(group);
+
+            if (group >= 0)
+            {
+                auto edgeIter = edgeOfGroup.find(group);
+                if (edgeIter == edgeOfGroup.end())
+                {
+                    edgeOfGroup[group] = edge.m_cells[i]->m_location;
+                }
+                else if (edgeIter->second != edge.m_cells[i]->m_location)
+                {
+                    doLog(LOG_WARN, "Group %s has pads on more than one edge; pads are only moved within an edge\n",
+                        padring.m_groups[group].first.c_str());
+                    edgeIter->second = edge.m_cells[i]->m_location;
+                }
+            }
+
+            if (!pinned[i])
+            {
+                edge.m_movable.push_back(static_cast<uint32_t>(i));
+            }
+        }
+
+        m_edges.push_back(edge);
+    }
+}
+
+int64_t PadOrderOptimizer::slotCost(const Edge &edge, const std::vector<uint32_t> &order, size_t slot) const
+{
+    int32_t group = edge.m_group[order[slot]];
+    int64_t c = std::abs(static_cast<int64_t>(slot) - static_cast<int64_t>(order[slot]));
+
+    // a group run starts here
+    if ((group >= 0) && ((slot == 0) || (edge.m_group[order[slot-1]] != group)))
+    {
+        c += BREAK_WEIGHT;
+    }
+    return c;
+}
+
+int64_t PadOrderOptimizer::cost(const order_t &order) const
+{
+    int64_t total = 0;
+    for(size_t e=0; e<m_edges.size(); e++)
+    {
+        for(size_t slot=0; slot<order[e].size(); slot++)
+        {
+            total += slotCost(m_edges[e], order[e], slot);
+        }
+    }
+    return total;
+}
+
+int64_t PadOrderOptimizer::groupBreaks(const order_t &order) const
+{
+    int64_t breaks = 0;
+    for(size_t e=0; e<m_edges.size(); e++)
+    {
+        auto const &edge = m_edges[e];
+        std::unordered_set<int32_t> groups;
+        for(size_t slot=0; slot<order[e].size(); slot++)
+        {
+            int32_t group = edge.m_group[order[e][slot]];
+            if (group < 0)
+            {
+                continue;
+            }
+            groups.insert(group);
+            if ((slot == 0) || (edge.m_group[order[e][slot-1]] != group))
+            {
+                breaks++;
+            }
+        }
+        breaks -= groups.size();
+    }
+    return breaks;
+}
+
+PadOrderOptimizer::Result PadOrderOptimizer::anneal(uint64_t seed, uint64_t moves) const
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    Result best;
+    best.m_order.resize(m_edges.size());
+    std::vector<size_t> candidates;
+    for(size_t e=0; e<m_edges.size(); e++)
+    {
+        for(uint32_t i=0; i<m_edges[e].m_cells.size(); i++)
+        {
+            best.m_order[e].push_back(i);
+        }
+        if (m_edges[e].m_movable.size() >= 2)
+        {
+            candidates.push_back(e);
+        }
+    }
+    best.m_cost  = cost(best.m_order);
+    best.m_moves = 0;
+
+    if (candidates.empty())
+    {
+        return best;
+    }
+
+    order_t order = best.m_order;
+    int64_t current = best.m_cost;
+
+    // the best order is only copied when the chain
+    // moves uphill from it, or at the end.
+    bool atBest = true;
+
+    // geometric cooling from the cost of a group break
+    // to a temperature where only improvements are made.
+    const double startTemp = static_cast<double>(BREAK_WEIGHT);
+    const double endTemp = 0.1;
+    const double alpha = std::pow(endTemp / startTemp, 1.0 / static_cast<double>(moves));
+    double temp = startTemp;
+
+    size_t affected[4];
+    for(uint64_t m=0; m<moves; m++, temp *= alpha)
+    {
+        size_t e = candidates[rng() % candidates.size()];
+        auto const &edge = m_edges[e];
+        auto &edgeOrder = order[e];
+        size_t n = edgeOrder.size();
+
+        // every move swaps two different slots
+        size_t a = edge.m_movable[rng() % edge.m_movable.size()];
+        size_t b;
+        do
+        {
+            b = edge.m_movable[rng() % edge.m_movable.size()];
+        } while(a == b);
+
+        // only the swapped slots and the slots directly
+        // after them can change cost.
+        size_t count = 0;
+        size_t candidateSlots[4] = {a, a+1, b, b+1};
+        for(auto slot : candidateSlots)
+        {
+            if (slot >= n)
+            {
+                continue;
+            }
+            bool duplicate = false;
+            for(size_t i=0; i<count; i++)
+            {
+                duplicate |= (affected[i] == slot);
+            }
+            if (!duplicate)
+            {
+                affected[count++] = slot;
+            }
+        }
+
+        int64_t before = 0;
+        for(size_t i=0; i<count; i++)
+        {
+            before += slotCost(edge, edgeOrder, affected[i]);
+        }
+
+        std::swap(edgeOrder[a], edgeOrder[b]);
+
+        int64_t after = 0;
+        for(size_t i=0; i<count; i++)
+        {
+            after += slotCost(edge, edgeOrder, affected[i]);
+        }
+
+        int64_t delta = after - before;
+        if ((delta <= 0) || (uniform(rng) < std::exp(-static_cast<double>(delta) / temp)))
+        {
+            if ((delta > 0) && atBest)
+            {
+                // leaving the best order: copy it
+                // without the swap just made.
+                best.m_order = order;
+                std::swap(best.m_order[e][a], best.m_order[e][b]);
+                atBest = false;
+            }
+
+            current += delta;
+            if (current < best.m_cost)
+            {
+                best.m_cost = current;
+                atBest = true;
+            }
+        }
+        else
+        {
+            std::swap(edgeOrder[a], edgeOrder[b]);  // reject
+        }
+    }
+
+    if (atBest)
+    {
+        best.m_order = order;
+    }
+
+    best.m_moves = moves;
+    return best;
+}
+
+void PadOrderOptimizer::applyOrder(const order_t &order)
+{
+    for(size_t e=0; e<m_edges.size(); e++)
+    {
+        std::vector<LayoutItem*> cells;
+        for(auto idx : order[e])
+        {
+            cells.push_back(m_edges[e].m_cells[idx]);
+        }
+        m_edges[e].m_layout->setCells(cells);
+    }
+}
+
+bool PadOrderOptimizer::run(uint32_t threads, uint64_t movesPerThread)
+{
+    if (m_padring.m_groups.empty())
+    {
+        doLog(LOG_WARN, "No pad groups defined, the pad order is not changed\n");
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<Result> results;
+    {
+        ThreadPool pool(threads);
+        results.resize(pool.getThreadCount());
+        for(size_t i=0; i<results.size(); i++)
+        {
+            pool.submit([this, i, movesPerThread, &results]() 
+            { 
+                results[i] = anneal(0x5EED + i, movesPerThread); 
+            });
+        }
+        pool.wait();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    m_seconds = elapsed.count();
+
+    // pick the best chain
+    size_t bestIdx = 0;
+    m_totalMoves = 0;
+    for(size_t i=0; i<results.size(); i++)
+    {
+        m_totalMoves += results[i].m_moves;
+        if (results[i].m_cost < results[bestIdx].m_cost)
+        {
+            bestIdx = i;
+        }
+    }
+
+    order_t initial;
+    for(auto const &edge : m_edges)
+    {
+        std::vector<uint32_t> identity;
+        for(uint32_t i=0; i<edge.m_cells.size(); i++)
+        {
+            identity.push_back(i);
+        }
+        initial.push_back(identity);
+    }
+
+    m_initialCost   = cost(initial);
+    m_initialBreaks = groupBreaks(initial);
+    m_finalCost     = results[bestIdx].m_cost;
+    m_finalBreaks   = groupBreaks(results[bestIdx].m_order);
+
+    applyOrder(results[bestIdx].m_order);
+    return true;
+}
+
+void PadOrderOptimizer::report()
+{
+    doLog(LOG_INFO,"Pad order cost  : %lld -> %lld\n", 
+        static_cast<long long>(m_initialCost), static_cast<long long>(m_finalCost));
+    doLog(LOG_INFO,"Broken groups   : %lld -> %lld\n", 
+        static_cast<long long>(m_initialBreaks), static_cast<long long>(m_finalBreaks));
+    doLog(LOG_INFO,"Moves           : %llu in %f seconds (%.0f moves/s)\n", 
+        static_cast<unsigned long long>(m_totalMoves), m_seconds, 
+        (m_seconds > 0.0) ? m_totalMoves / m_seconds : 0.0);
+}
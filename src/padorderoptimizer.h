@@ -0,0 +1,106 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef padorderoptimizer_h
+#define padorderoptimizer_h
+
+#include <stdint.h>
+#include <vector>
+
+#include "padringdb.h"
+
+/** Reorders the pads within each edge so that the pads
+    of a GROUP end up next to each other, using parallel
+    simulated annealing.
+
+    The cost of an order is the number of times a group is
+    broken up by other pads, weighted by BREAK_WEIGHT, plus
+    the total distance (in pad slots) the pads moved away from
+    the order given in the configuration file. The second term
+    keeps the result close to the original order.
+
+    Pads next to a SPACE statement are never moved, so the 
+    explicitly specified spacing is kept. Pads only move
+    within their own edge.
+
+    Each move swaps two pads and updates the cost in constant
+    time by only looking at the slots around the two pads.
+*/
+class PadOrderOptimizer
+{
+public:
+    PadOrderOptimizer(PadringDB &padring);
+
+    /** run the optimizer using the given number of threads,
+        each performing the given number of moves. on return,
+        the best order has been applied to the padring database.
+        returns false if there is nothing to optimize.
+    */
+    bool run(uint32_t threads, uint64_t movesPerThread);
+
+    /** report the cost before and after optimization */
+    void report();
+
+    static const int64_t BREAK_WEIGHT = 1000;
+
+protected:
+    struct Edge
+    {
+        Layout                      *m_layout;
+        std::vector<LayoutItem*>    m_cells;    ///< cells in the original order
+        std::vector<int32_t>        m_group;    ///< group index for each original cell, -1 if none.
+        std::vector<uint32_t>       m_movable;  ///< slots that can be moved.
+    };
+
+    /** pad order: for each edge and slot, the index of the original cell */
+    typedef std::vector<std::vector<uint32_t> > order_t;
+
+    struct Result
+    {
+        order_t     m_order;
+        int64_t     m_cost;
+        uint64_t    m_moves;
+    };
+
+    /** run one annealing chain */
+    Result anneal(uint64_t seed, uint64_t moves) const;
+
+    /** cost of a complete order */
+    int64_t cost(const order_t &order) const;
+
+    /** cost contribution of a single slot */
+    int64_t slotCost(const Edge &edge, const std::vector<uint32_t> &order, size_t slot) const;
+
+    /** count the number of broken groups, for reporting */
+    int64_t groupBreaks(const order_t &order) const;
+
+    void applyOrder(const order_t &order);
+
+    PadringDB           &m_padring;
+    std::vector<Edge>   m_edges;
+
+    int64_t     m_initialCost;
+    int64_t     m_initialBreaks;
+    int64_t     m_finalCost;
+    int64_t     m_finalBreaks;
+    uint64_t    m_totalMoves;
+    double      m_seconds;
+};
+
+#endif
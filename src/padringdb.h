@@ -29,17 +29,44 @@ class PadringDB : public ConfigReader
 {
 public:
 
-    PadringDB() : m_north(Layout::DIR_HORIZONTAL),
+    /** create a padring database that uses the cells
+        of the given LEF database. the LEF database is
+        only read, so several padring databases can
+        share it.
+    */
+    PadringDB(const PRLEFReader &lefreader) : m_north(Layout::DIR_HORIZONTAL),
         m_south(Layout::DIR_HORIZONTAL),
         m_east(Layout::DIR_VERTICAL),
         m_west(Layout::DIR_VERTICAL),
-        m_grid(1.0) 
+        m_dieHeight(0.0),
+        m_dieWidth(0.0),
+        m_grid(1.0),
+        m_lefreader(lefreader)
     {
         m_south.setEdgePos(0.0);
         m_west.setEdgePos(0.0);
         m_designName = "PADRING";
     }
 
+    /** copy the padring database, including the layout
+        of each edge. the LEF database is shared.
+    */
+    PadringDB(const PadringDB &other) : ConfigReader(other),
+        m_north(other.m_north),
+        m_south(other.m_south),
+        m_east(other.m_east),
+        m_west(other.m_west),
+        m_dieHeight(other.m_dieHeight),
+        m_dieWidth(other.m_dieWidth),
+        m_grid(other.m_grid),
+        m_designName(other.m_designName),
+        m_fillerPrefix(other.m_fillerPrefix),
+        m_lastLocation(other.m_lastLocation),
+        m_groups(other.m_groups),
+        m_lefreader(other.m_lefreader)
+    {
+    }
+
     /** callback for a corner */
     virtual void onCorner(
         const std::string &instance,
@@ -205,6 +232,21 @@ public:
         m_designName = designName;
     }
 
+    /** callback for a group of pads */
+    virtual void onGroup(const std::string &groupName, const std::vector<std::string> &instances) override
+    {
+        m_groups.push_back(std::make_pair(groupName, instances));
+    }
+
+    /** set the size of all fixed spaces on all edges */
+    void setFixedSpaceSize(double space)
+    {
+        m_north.setFixedSpaceSize(space);
+        m_south.setFixedSpaceSize(space);
+        m_west.setFixedSpaceSize(space);
+        m_east.setFixedSpaceSize(space);
+    }
+
     void doLayout()
     {
         m_north.doLayout();
@@ -227,7 +269,10 @@ public:
     std::string m_fillerPrefix;
     std::string m_lastLocation;
 
-    PRLEFReader m_lefreader;
+    /** pad groups: group name and instance names */
+    std::vector<std::pair<std::string, std::vector<std::string> > > m_groups;
+
+    const PRLEFReader &m_lefreader;
 };
 
 #endif
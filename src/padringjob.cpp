@@ -0,0 +1,292 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <chrono>
+#include "logging.h"
+#include "padringdb.h"
+#include "fillerhandler.h"
+#include "diefitter.h"
+#include "padringwriter.h"
+#include "padringjob.h"
+
+PadringJob::PadringJob() : m_pngSize(0),
+    m_fit(false),
+    m_useAREF(true),
+    m_gds2Hierarchy(false),
+    m_verify(false),
+    m_parseTime(0.0),
+    m_layoutTime(0.0),
+    m_writeTime(0.0)
+{
+}
+
+std::vector<std::string*> PadringJob::getOutputs()
+{
+    return {&m_gds2Filename, &m_svgFilename, &m_defFilename, &m_oasisFilename, 
+        &m_htmlFilename, &m_pngFilename, &m_reportFilename};
+}
+
+std::vector<std::string> PadringJob::getOutputFilenames() const
+{
+    const std::string *outputs[] = {&m_gds2Filename, &m_svgFilename, &m_defFilename, 
+        &m_oasisFilename, &m_htmlFilename, &m_pngFilename, &m_reportFilename};
+
+    std::vector<std::string> filenames;
+    for(auto filename : outputs)
+    {
+        if (!filename->empty())
+        {
+            filenames.push_back(*filename);
+        }
+    }
+    return filenames;
+}
+
+void PadringJob::setOutputDirectory(const std::string &directory)
+{
+    for(auto filename : getOutputs())
+    {
+        if (!filename->empty())
+        {
+            *filename = directory + "/" + *filename;
+        }
+    }
+}
+
+bool PadringJob::parseOptions(std::istream &ss, const std::string &context)
+{
+    std::string option;
+    while(ss >> option)
+    {
+        std::string *filename = nullptr;
+        if ((option == "-o") || (option == "--output"))
+        {
+            filename = &m_gds2Filename;
+        }
+        else if (option == "--svg")
+        {
+            filename = &m_svgFilename;
+        }
+        else if (option == "--def")
+        {
+            filename = &m_defFilename;
+        }
+        else if (option == "--oasis")
+        {
+            filename = &m_oasisFilename;
+        }
+        else if (option == "--html")
+        {
+            filename = &m_htmlFilename;
+        }
+        else if (option == "--png")
+        {
+            filename = &m_pngFilename;
+        }
+        else if (option == "--report")
+        {
+            filename = &m_reportFilename;
+        }
+        else if (option == "--png-size")
+        {
+            if (!(ss >> m_pngSize) || (m_pngSize == 0))
+            {
+                doLog(LOG_ERROR, "%s : --png-size needs a positive number of pixels\n", context.c_str());
+                return false;
+            }
+            continue;
+        }
+        else if (option == "--fit")
+        {
+            m_fit = true;
+            continue;
+        }
+        else if (option == "--filler")
+        {
+            if (!(ss >> m_fillerPrefix))
+            {
+                doLog(LOG_ERROR, "%s : --filler needs a filler cell prefix\n", context.c_str());
+                return false;
+            }
+            continue;
+        }
+        else if (option == "--no-aref")
+        {
+            m_useAREF = false;
+            continue;
+        }
+        else if (option == "--gds-hierarchy")
+        {
+            m_gds2Hierarchy = true;
+            continue;
+        }
+        else if (option == "--verify")
+        {
+            m_verify = true;
+            continue;
+        }
+        else
+        {
+            doLog(LOG_ERROR, "%s : unknown option %s\n", context.c_str(), option.c_str());
+            return false;
+        }
+
+        if (!(ss >> *filename))
+        {
+            doLog(LOG_ERROR, "%s : %s needs a filename\n", context.c_str(), option.c_str());
+            return false;
+        }
+
+        // jobs can run in parallel, so they
+        // cannot share the standard output.
+        if (*filename == "-")
+        {
+            doLog(LOG_ERROR, "%s : %s cannot write to the standard output\n", context.c_str(), option.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PadringJob::addFillers(const PRLEFReader &lefreader, const PadringDB &padring, FillerHandler &fillers) const
+{
+    // use the cells matching the --filler prefix or, without
+    // it, the FILLER prefix of the configuration. when neither
+    // is given, use the filler cells of the LEF database.
+    const std::string &prefix = m_fillerPrefix.empty() ? padring.m_fillerPrefix : m_fillerPrefix;
+    for(auto const &lefCell : lefreader.m_cells)
+    {
+        bool isFiller = prefix.empty() ? lefCell.second->m_isFiller : (lefCell.first.rfind(prefix, 0) == 0);
+        if (isFiller)
+        {
+            fillers.addFillerCell(lefCell.first, lefCell.second->m_sx);
+        }
+    }
+
+    doLog(LOG_INFO, "Found %d filler cells\n", fillers.getCellCount());
+    if (fillers.getCellCount() == 0)
+    {
+        doLog(LOG_ERROR, "Cannot proceed without filler cells. Please use the --filler option to explicitly specify a filler cell prefix\n");
+        return false;
+    }
+    return true;
+}
+
+std::string PadringJob::fitDie(PadringDB &padring, FillerHandler &fillers) const
+{
+    if (m_fit)
+    {
+        DieFitter fitter(padring, fillers);
+        if (!fitter.fit())
+        {
+            doLog(LOG_ERROR, "Cannot fit the padring\n");
+            return "fit_error";
+        }
+        fitter.report();
+    }
+
+    if ((padring.m_dieWidth < 1.0e-6) || (padring.m_dieHeight < 1.0e-6))
+    {
+        doLog(LOG_ERROR, "Die area was not specified!\n");
+        return "no_area";
+    }
+
+    doLog(LOG_INFO,"Die area        : %f x %f microns\n", padring.m_dieWidth, padring.m_dieHeight);
+    doLog(LOG_INFO,"Padring cells   : %d\n", padring.getPadCellCount());
+    return "ok";
+}
+
+void PadringJob::setupWriter(PadringWriter &writer, double databaseUnits) const
+{
+    writer.setDatabaseUnits(databaseUnits);
+    writer.setUseAREF(m_useAREF);
+    writer.setGDS2Hierarchy(m_gds2Hierarchy);
+    writer.setVerify(m_verify);
+    if (m_pngSize > 0)
+    {
+        writer.setPNGSize(m_pngSize);
+    }
+    if (!m_gds2Filename.empty())
+    {
+        writer.setGDS2Filename(m_gds2Filename);
+    }
+    if (!m_svgFilename.empty())
+    {
+        writer.setSVGFilename(m_svgFilename);
+    }
+    if (!m_defFilename.empty())
+    {
+        writer.setDEFFilename(m_defFilename);
+    }
+    if (!m_oasisFilename.empty())
+    {
+        writer.setOASISFilename(m_oasisFilename);
+    }
+    if (!m_htmlFilename.empty())
+    {
+        writer.setHTMLFilename(m_htmlFilename);
+    }
+    if (!m_pngFilename.empty())
+    {
+        writer.setPNGFilename(m_pngFilename);
+    }
+    if (!m_reportFilename.empty())
+    {
+        writer.setReportFilename(m_reportFilename);
+    }
+}
+
+std::string PadringJob::process(const PRLEFReader &lefreader, std::istream &config, double databaseUnits)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    PadringDB padring(lefreader);
+    if (!padring.parse(config))
+    {
+        doLog(LOG_ERROR, "Cannot parse the configuration\n");
+        return "config_error";
+    }
+
+    FillerHandler fillers;
+    if (!addFillers(lefreader, padring, fillers))
+    {
+        return "no_fillers";
+    }
+
+    auto parsed = std::chrono::steady_clock::now();
+    m_parseTime = std::chrono::duration<double>(parsed - start).count();
+
+    std::string status = fitDie(padring, fillers);
+    if (status != "ok")
+    {
+        return status;
+    }
+
+    padring.doLayout();
+
+    auto laidOut = std::chrono::steady_clock::now();
+    m_layoutTime = std::chrono::duration<double>(laidOut - parsed).count();
+
+    PadringWriter writer(padring, fillers);
+    setupWriter(writer, databaseUnits);
+
+    bool ok = writer.write();
+    m_writeTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - laidOut).count();
+    return ok ? "ok" : "write_error";
+}
@@ -0,0 +1,106 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef padringjob_h
+#define padringjob_h
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "prlefreader.h"
+#include "padringdb.h"
+#include "fillerhandler.h"
+#include "padringwriter.h"
+
+/** The options and the processing of a single padring:
+    parse a configuration, search the die size if requested,
+    lay out the edges and write the output files.
+
+    A job has its own padring database and filler cells,
+    so jobs that share the (read-only) LEF database can
+    run in parallel.
+*/
+class PadringJob
+{
+public:
+    PadringJob();
+
+    /** parse output and layout options until the end of the
+        stream: -o/--output, --svg, --def, --oasis, --html,
+        --png, --png-size, --report, --fit, --filler, --no-aref,
+        --gds-hierarchy and --verify. errors are reported with
+        the given context. returns false on an unknown or
+        incomplete option.
+    */
+    bool parseOptions(std::istream &ss, const std::string &context);
+
+    /** return the names of all the requested output files */
+    std::vector<std::string> getOutputFilenames() const;
+
+    /** write all the output files to the given directory */
+    void setOutputDirectory(const std::string &directory);
+
+    /** add the cells whose names start with the --filler
+        prefix or, without it, with the FILLER prefix of the
+        configuration. without either prefix, add the filler
+        cells of the LEF database. returns false if there 
+        are none.
+    */
+    bool addFillers(const PRLEFReader &lefreader, const PadringDB &padring, FillerHandler &fillers) const;
+
+    /** search the die size when --fit was given and check
+        that the die area is set. returns ok, fit_error
+        or no_area.
+    */
+    std::string fitDie(PadringDB &padring, FillerHandler &fillers) const;
+
+    /** pass the output files and options to a writer */
+    void setupWriter(PadringWriter &writer, double databaseUnits) const;
+
+    /** lay out the padring of the configuration and write
+        the output files. returns the status: ok, config_error,
+        no_fillers, fit_error, no_area or write_error.
+    */
+    std::string process(const PRLEFReader &lefreader, std::istream &config, double databaseUnits);
+
+    std::string m_gds2Filename;
+    std::string m_svgFilename;
+    std::string m_defFilename;
+    std::string m_oasisFilename;
+    std::string m_htmlFilename;
+    std::string m_pngFilename;
+    std::string m_reportFilename;
+    uint32_t    m_pngSize;          ///< 0 to use the default size.
+    std::string m_fillerPrefix;     ///< empty to use the FILLER prefix of the configuration.
+    bool        m_fit;
+    bool        m_useAREF;
+    bool        m_gds2Hierarchy;
+    bool        m_verify;
+
+    double      m_parseTime;        ///< seconds spent reading the configuration.
+    double      m_layoutTime;       ///< seconds spent on fitting and layout.
+    double      m_writeTime;        ///< seconds spent writing the output files.
+
+protected:
+    /** the output filenames, in a fixed order */
+    std::vector<std::string*> getOutputs();
+};
+
+#endif
@@ -0,0 +1,482 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "logging.h"
+#include "gzipwriter.h"
+#include "textwriter.h"
+#include "padringwriter.h"
+
+void PadringWriter::writeItem(const LayoutItem *item)
+{
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    if (!m_block)
+    {
+        m_block = std::make_shared<PlacementBlock>();
+        m_block->reserve(m_blockSize);
+    }
+
+    m_block->push_back(*item);
+    if (m_block->size() >= m_blockSize)
+    {
+        flushBlock();
+    }
+}
+
+void PadringWriter::flushBlock()
+{
+    if (!m_block)
+    {
+        return;
+    }
+
+    std::shared_ptr<const PlacementBlock> block = std::move(m_block);
+    for(auto &sinkThread : m_sinkThreads)
+    {
+        sinkThread->push(block);
+    }
+    if (m_edgeBlocks != nullptr)
+    {
+        m_edgeBlocks->push_back(block);
+    }
+    m_block.reset();
+}
+
+bool PadringWriter::writeEdge(Layout &edge, const std::string &location, double edgePos)
+{
+    flushBlock();
+
+    // an unchanged edge sends its previous blocks again
+    std::string signature;
+    PlacementCache::BlockList blocks;
+    if (m_cache != nullptr)
+    {
+        signature = edge.getSignature();
+        const PlacementCache::BlockList *cached = m_cache->getEdge(location, signature);
+        if (cached != nullptr)
+        {
+            for(auto const &block : *cached)
+            {
+                for(auto &sinkThread : m_sinkThreads)
+                {
+                    sinkThread->push(block);
+                }
+            }
+            return true;
+        }
+        m_edgeBlocks = &blocks;
+    }
+
+    bool horizontal = (location == "N") || (location == "S");
+
+    for(auto item : edge)
+    {
+        if (item->m_ltype == LayoutItem::TYPE_CELL)
+        {
+            writeItem(item);
+        }
+        else if ((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
+        {
+            // do fillers
+            double space = item->m_size;
+            double pos = horizontal ? item->m_x : item->m_y;
+            bool filled = m_fillers.fill(space, [&](const std::string &cellName, double width)
+                {
+                    LayoutItem filler(LayoutItem::TYPE_FILLER);
+                    filler.m_cellname = cellName;
+                    filler.m_x = horizontal ? pos : edgePos;
+                    filler.m_y = horizontal ? edgePos : pos;
+                    filler.m_size = width;
+                    filler.m_location = location;
+                    filler.m_lefinfo = m_padring.m_lefreader.getCellByName(cellName);
+                    writeItem(&filler);
+                    pos += width;
+                });
+
+            if (!filled)
+            {
+                doLog(LOG_ERROR, "Cannot find filler cell that fits remaining width %f\n", space);
+                m_edgeBlocks = nullptr;
+                return false;
+            }
+        }
+    }
+
+    // every edge gets its own blocks so the 
+    // sinks can process the edges independently.
+    flushBlock();
+    if (m_cache != nullptr)
+    {
+        m_cache->setEdge(location, signature, blocks);
+        m_edgeBlocks = nullptr;
+    }
+    return true;
+}
+
+uint32_t PadringWriter::getComponentCount()
+{
+    uint32_t count = 0;
+    const LayoutItem *corners[] = {
+        m_padring.m_north.getFirstCorner(), m_padring.m_north.getLastCorner(),
+        m_padring.m_south.getFirstCorner(), m_padring.m_south.getLastCorner()};
+
+    for(auto corner : corners)
+    {
+        if (corner != nullptr)
+        {
+            count++;
+        }
+    }
+
+    for(Layout *edge : {&m_padring.m_north, &m_padring.m_south, &m_padring.m_west, &m_padring.m_east})
+    {
+        for(auto item : *edge)
+        {
+            if (item->m_ltype == LayoutItem::TYPE_CELL)
+            {
+                count++;
+            }
+            else if ((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
+            {
+                int32_t fillers = m_fillers.getFillerCount(item->m_size);
+                if (fillers > 0)
+                {
+                    count += fillers;
+                }
+            }
+        }
+    }
+    return count;
+}
+
+bool PadringWriter::addGDS2Library(const std::string &filename)
+{
+    if (!m_gds2Library)
+    {
+        m_gds2Library.reset(new GDS2Library());
+    }
+    return m_gds2Library->addFile(filename);
+}
+
+void PadringWriter::unshareFile(const std::string &filename)
+{
+    struct stat info;
+    if ((stat(filename.c_str(), &info) == 0) && S_ISREG(info.st_mode) && (info.st_nlink > 1))
+    {
+        unlink(filename.c_str());
+    }
+}
+
+bool PadringWriter::write()
+{
+    const std::string *filenames[] = {&m_gds2Filename, &m_svgFilename, &m_defFilename, 
+        &m_oasisFilename, &m_htmlFilename, &m_pngFilename, &m_reportFilename};
+    for(auto filename : filenames)
+    {
+        if (!filename->empty() && (*filename != "-"))
+        {
+            unshareFile(*filename);
+        }
+    }
+
+    // the output files that were created, which
+    // are removed again when writing fails.
+    std::vector<std::string> created;
+
+    // write the padring to an SVG file,
+    // compressed when it ends in .gz
+    std::ofstream svgos;
+    std::unique_ptr<GzipOStream> svggz;
+    std::unique_ptr<SVGWriter> svg;
+    if (!m_svgFilename.empty())
+    {
+        doLog(LOG_INFO,"Writing padring to SVG file: %s\n", m_svgFilename.c_str());
+        svgos.open(m_svgFilename, std::ofstream::out | std::ofstream::binary);
+        if (!svgos.is_open())
+        {
+            doLog(LOG_ERROR, "Cannot open SVG file for writing!\n");
+            removeFiles(created);
+            return false;
+        }
+        created.push_back(m_svgFilename);
+        std::ostream *os = &svgos;
+        if (GzipWriter::isGzipFilename(m_svgFilename))
+        {
+            svggz.reset(new GzipOStream(svgos));
+            os = svggz.get();
+        }
+        svg.reset(new SVGWriter(*os, m_padring.m_dieWidth, m_padring.m_dieHeight));
+    }
+
+    // write the padring to an DEF file, 
+    // or to stdout when the name is '-'.
+    std::ofstream defos;
+    std::unique_ptr<GzipOStream> defgz;
+    std::unique_ptr<DEFWriter> def;
+    if (!m_defFilename.empty())
+    {
+        doLog(LOG_INFO,"Writing padring to DEF file: %s\n", m_defFilename.c_str());
+        std::ostream *os = &std::cout;
+        if (m_defFilename != "-")
+        {
+            defos.open(m_defFilename, std::ofstream::out | std::ofstream::binary);
+            if (!defos.is_open())
+            {
+                doLog(LOG_ERROR, "Cannot open DEF file for writing!\n");
+                removeFiles(created);
+                return false;
+            }
+            created.push_back(m_defFilename);
+            os = &defos;
+            if (GzipWriter::isGzipFilename(m_defFilename))
+            {
+                defgz.reset(new GzipOStream(defos));
+                os = defgz.get();
+            }
+        }
+        def.reset(new DEFWriter(*os, m_padring.m_dieWidth, m_padring.m_dieHeight));
+        def->setDatabaseUnits(m_databaseUnits);
+        def->setDesignName(m_padring.m_designName);
+        def->setComponentCount(getComponentCount());
+    }
+
+    // write the padring to a GDS2 file
+    std::unique_ptr<OutputSink> gds2;
+    if (!m_gds2Filename.empty())
+    {
+        doLog(LOG_INFO,"Writing padring to GDS2 file: %s\n", m_gds2Filename.c_str());
+        if (m_gds2Hierarchy)
+        {
+            GDS2HierWriter *writer = GDS2HierWriter::open(m_gds2Filename, m_padring.m_designName, 
+                m_padring.m_dieWidth, m_padring.m_dieHeight);
+            if (writer != nullptr)
+            {
+                writer->setLibrary(m_gds2Library.get());
+            }
+            gds2.reset(writer);
+        }
+        else
+        {
+            GDS2MappedWriter *writer = GDS2MappedWriter::open(m_gds2Filename, m_padring.m_designName);
+            if (writer != nullptr)
+            {
+                writer->setUseAREF(m_useAREF);
+                writer->setLibrary(m_gds2Library.get());
+                writer->setCache(m_cache);
+            }
+            gds2.reset(writer);
+        }
+
+        if (!gds2)
+        {
+            doLog(LOG_ERROR, "Cannot open GDS2 file for writing!\n");
+            removeFiles(created);
+            return false;
+        }
+        created.push_back(m_gds2Filename);
+    }
+
+    // write the padring to an OASIS file
+    std::unique_ptr<OASISWriter> oasis;
+    if (!m_oasisFilename.empty())
+    {
+        doLog(LOG_INFO,"Writing padring to OASIS file: %s\n", m_oasisFilename.c_str());
+        oasis.reset(OASISWriter::open(m_oasisFilename, m_padring.m_designName));
+        if (!oasis)
+        {
+            doLog(LOG_ERROR, "Cannot open OASIS file for writing!\n");
+            removeFiles(created);
+            return false;
+        }
+        created.push_back(m_oasisFilename);
+    }
+
+    // write the padring viewer to an HTML file
+    std::ofstream htmlos;
+    std::unique_ptr<HTMLWriter> html;
+    if (!m_htmlFilename.empty())
+    {
+        doLog(LOG_INFO,"Writing padring to HTML file: %s\n", m_htmlFilename.c_str());
+        htmlos.open(m_htmlFilename, std::ofstream::out | std::ofstream::binary);
+        if (!htmlos.is_open())
+        {
+            doLog(LOG_ERROR, "Cannot open HTML file for writing!\n");
+            removeFiles(created);
+            return false;
+        }
+        created.push_back(m_htmlFilename);
+        html.reset(new HTMLWriter(htmlos, m_padring.m_dieWidth, m_padring.m_dieHeight));
+        html->setDesignName(m_padring.m_designName);
+    }
+
+    // render a thumbnail to a PNG file
+    std::ofstream pngos;
+    std::unique_ptr<PNGWriter> png;
+    if (!m_pngFilename.empty())
+    {
+        doLog(LOG_INFO,"Writing padring to PNG file: %s\n", m_pngFilename.c_str());
+        pngos.open(m_pngFilename, std::ofstream::out | std::ofstream::binary);
+        if (!pngos.is_open())
+        {
+            doLog(LOG_ERROR, "Cannot open PNG file for writing!\n");
+            removeFiles(created);
+            return false;
+        }
+        created.push_back(m_pngFilename);
+        png.reset(new PNGWriter(pngos, m_padring.m_dieWidth, m_padring.m_dieHeight, m_pngSize));
+    }
+
+    // check the GDS2 file against the placements
+    std::unique_ptr<GDS2Verifier> verifier;
+    if (gds2 && m_verify)
+    {
+        if (GzipWriter::isGzipFilename(m_gds2Filename))
+        {
+            doLog(LOG_WARN, "Compressed GDS2 files cannot be verified, skipping --verify\n");
+        }
+        else
+        {
+            verifier.reset(new GDS2Verifier());
+        }
+    }
+
+    // start a thread for each sink
+    std::vector<OutputSink*> sinks = {gds2.get(), oasis.get(), svg.get(), def.get(), html.get(), png.get(), verifier.get()};
+    for(auto sink : sinks)
+    {
+        if (sink != nullptr)
+        {
+            m_sinkThreads.emplace_back(new OutputSinkThread(sink));
+        }
+    }
+
+    // corners first, then the edges
+    writeItem(m_padring.m_north.getFirstCorner());
+    writeItem(m_padring.m_north.getLastCorner());
+    writeItem(m_padring.m_south.getFirstCorner());
+    writeItem(m_padring.m_south.getLastCorner());
+    flushBlock();
+
+    bool ok = writeEdge(m_padring.m_north, "N", m_padring.m_dieHeight) &&
+        writeEdge(m_padring.m_south, "S", 0.0) &&
+        writeEdge(m_padring.m_west, "W", 0.0) &&
+        writeEdge(m_padring.m_east, "E", m_padring.m_dieWidth);
+
+    // wait for the sinks to write all the 
+    // records before closing them.
+    flushBlock();
+    m_sinkThreads.clear();
+
+    // the outputs are only finished when all the 
+    // cells were written, otherwise they are removed.
+    ok = ok && closeOutput(gds2.get(), m_gds2Filename) &&
+        closeOutput(oasis.get(), m_oasisFilename) &&
+        closeOutput(svg.get(), m_svgFilename, svggz.get(), &svgos) &&
+        closeOutput(def.get(), m_defFilename, defgz.get(), &defos) &&
+        closeOutput(html.get(), m_htmlFilename, nullptr, &htmlos) &&
+        closeOutput(png.get(), m_pngFilename, nullptr, &pngos);
+
+    if (!ok)
+    {
+        removeFiles(created);
+        return false;
+    }
+
+    // a GDS2 file that does not match the layout
+    // is removed, with the other outputs.
+    if (verifier && !verifier->verify(m_gds2Filename, m_padring.m_designName))
+    {
+        removeFiles(created);
+        return false;
+    }
+
+    if (!m_reportFilename.empty() && !writeReport())
+    {
+        unlink(m_reportFilename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool PadringWriter::closeOutput(OutputSink *sink, const std::string &filename, 
+    GzipOStream *gz, std::ofstream *os)
+{
+    if (sink == nullptr)
+    {
+        return true;
+    }
+
+    bool ok = sink->close();
+    if ((gz != nullptr) && !gz->finish())
+    {
+        ok = false;
+    }
+
+    if ((os != nullptr) && os->is_open())
+    {
+        os->close();
+        if (os->fail())
+        {
+            ok = false;
+        }
+    }
+
+    if (!ok)
+    {
+        doLog(LOG_ERROR, "Cannot write %s\n", filename.c_str());
+    }
+    return ok;
+}
+
+void PadringWriter::removeFiles(const std::vector<std::string> &filenames)
+{
+    for(auto const &filename : filenames)
+    {
+        unlink(filename.c_str());
+    }
+}
+
+bool PadringWriter::writeReport()
+{
+    doLog(LOG_INFO,"Writing placement report: %s\n", m_reportFilename.c_str());
+    std::ofstream os(m_reportFilename, std::ofstream::out | std::ofstream::binary);
+    if (!os.is_open())
+    {
+        doLog(LOG_ERROR, "Cannot open report file for writing!\n");
+        return false;
+    }
+
+    ReportWriter report(m_padring, m_fillers);
+    report.setDatabaseUnits(m_databaseUnits);
+
+    if (TextWriter::isJSONFilename(m_reportFilename))
+    {
+        return report.writeJSON(os);
+    }
+    return report.writeCSV(os);
+}
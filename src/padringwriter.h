@@ -0,0 +1,221 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef padringwriter_h
+#define padringwriter_h
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <fstream>
+
+#include "padringdb.h"
+#include "fillerhandler.h"
+#include "svgwriter.h"
+#include "defwriter.h"
+#include "htmlwriter.h"
+#include "pngwriter.h"
+#include "reportwriter.h"
+#include "gds2/gds2mappedwriter.h"
+#include "gds2/gds2hierwriter.h"
+#include "gds2/gds2verifier.h"
+#include "oasis/oasiswriter.h"
+#include "outputsink.h"
+#include "placementcache.h"
+#include "gzipwriter.h"
+
+/** Writes a laid out padring, including the filler
+    cells, to the requested GDS2, OASIS, SVG, DEF, HTML 
+    and PNG files.
+    Formats without a filename are not written.
+
+    The placement records are generated once, in blocks,
+    and every output sink consumes the blocks on its own
+    thread, so the formats are serialised concurrently.
+    The GDS2 file is encoded in parallel, one block per 
+    worker thread.
+*/
+class PadringWriter
+{
+public:
+    PadringWriter(PadringDB &padring, FillerHandler &fillers) 
+        : m_padring(padring), 
+          m_fillers(fillers),
+          m_databaseUnits(0.0),
+          m_useAREF(true),
+          m_gds2Hierarchy(false),
+          m_verify(false),
+          m_pngSize(2048),
+          m_cache(nullptr),
+          m_edgeBlocks(nullptr),
+          m_blockSize(4096) {}
+
+    void setGDS2Filename(const std::string &filename)
+    {
+        m_gds2Filename = filename;
+    }
+
+    void setSVGFilename(const std::string &filename)
+    {
+        m_svgFilename = filename;
+    }
+
+    void setDEFFilename(const std::string &filename)
+    {
+        m_defFilename = filename;
+    }
+
+    void setOASISFilename(const std::string &filename)
+    {
+        m_oasisFilename = filename;
+    }
+
+    /** write a self-contained HTML viewer. see HTMLWriter. */
+    void setHTMLFilename(const std::string &filename)
+    {
+        m_htmlFilename = filename;
+    }
+
+    /** write a PNG thumbnail. see PNGWriter. */
+    void setPNGFilename(const std::string &filename)
+    {
+        m_pngFilename = filename;
+    }
+
+    /** write a placement report. the report is JSON when
+        the filename ends in .json, CSV otherwise.
+        see ReportWriter. */
+    void setReportFilename(const std::string &filename)
+    {
+        m_reportFilename = filename;
+    }
+
+    /** set the largest side of the PNG thumbnail in pixels */
+    void setPNGSize(uint32_t size)
+    {
+        m_pngSize = size;
+    }
+
+    void setDatabaseUnits(double databaseUnits)
+    {
+        m_databaseUnits = databaseUnits;
+    }
+
+    /** write runs of fillers as GDS2 arrays (AREF).
+        when disabled, every filler gets its own SREF. */
+    void setUseAREF(bool useAREF)
+    {
+        m_useAREF = useAREF;
+    }
+
+    /** write a hierarchical GDS2 file with shared edge
+        and filler run structures. see GDS2HierWriter. */
+    void setGDS2Hierarchy(bool hierarchy)
+    {
+        m_gds2Hierarchy = hierarchy;
+    }
+
+    /** read back the GDS2 file after writing it and 
+        check it against the layout. see GDS2Verifier. */
+    void setVerify(bool verify)
+    {
+        m_verify = verify;
+    }
+
+    /** add a cell library GDS2 file. the structures of 
+        the placed cells are copied into the GDS2 output.
+        returns false if the file cannot be read.
+    */
+    bool addGDS2Library(const std::string &filename);
+
+    /** reuse the placement blocks, and their GDS2 encoding,
+        of edges that have not changed since the last write
+        with the same cache. see PlacementCache. 
+    */
+    void setCache(PlacementCache *cache)
+    {
+        m_cache = cache;
+    }
+
+    /** write the padring to all the requested files.
+        returns false if a file could not be opened or
+        written, or a space could not be filled with 
+        filler cells. the incomplete files are removed.
+    */
+    bool write();
+
+protected:
+    /** write all the cells and fillers of an edge.
+        edgePos is the position of the fixed axis of 
+        the edge. 
+    */
+    bool writeEdge(Layout &edge, const std::string &location, double edgePos);
+
+    /** get the number of corners, cells and fillers 
+        that will be written */
+    uint32_t getComponentCount();
+
+    /** add a single cell to the current placement block */
+    void writeItem(const LayoutItem *item);
+
+    /** send the current placement block to all the sinks */
+    void flushBlock();
+
+    /** write the placement report */
+    bool writeReport();
+
+    /** close a sink and the gzip stream and file it
+        writes to, if any. returns false on an error. */
+    static bool closeOutput(OutputSink *sink, const std::string &filename,
+        GzipOStream *gz = nullptr, std::ofstream *os = nullptr);
+
+    /** remove the files of an incomplete output */
+    static void removeFiles(const std::vector<std::string> &filenames);
+
+    /** remove an output file that has other hard links, 
+        such as an output cache entry, so that it is
+        written as a new file instead of in place. */
+    static void unshareFile(const std::string &filename);
+
+    PadringDB       &m_padring;
+    FillerHandler   &m_fillers;
+
+    std::string m_gds2Filename;
+    std::string m_svgFilename;
+    std::string m_defFilename;
+    std::string m_oasisFilename;
+    std::string m_htmlFilename;
+    std::string m_pngFilename;
+    std::string m_reportFilename;
+    double      m_databaseUnits;
+    bool        m_useAREF;
+    bool        m_gds2Hierarchy;
+    bool        m_verify;
+    uint32_t    m_pngSize;      ///< largest side of the PNG thumbnail
+    std::unique_ptr<GDS2Library> m_gds2Library;
+    PlacementCache *m_cache;    ///< edge cache, or nullptr
+    PlacementCache::BlockList *m_edgeBlocks;    ///< collects the blocks of the current edge
+
+    size_t      m_blockSize;    ///< maximum number of records in a block
+
+    std::shared_ptr<PlacementBlock> m_block;
+    std::vector<std::unique_ptr<OutputSinkThread> > m_sinkThreads;
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include "placementcache.h"
+
+const PlacementCache::BlockList* PlacementCache::getEdge(const std::string &location, const std::string &signature)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_edges.find(location);
+    if ((iter == m_edges.end()) || (iter->second.m_signature != signature))
+    {
+        m_edgeMisses++;
+        return nullptr;
+    }
+    m_edgeHits++;
+    return &iter->second.m_blocks;
+}
+
+void PlacementCache::setEdge(const std::string &location, const std::string &signature, const BlockList &blocks)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Edge &edge = m_edges[location];
+
+    // the encodings of the old blocks can
+    // never be used again.
+    for(auto const &block : edge.m_blocks)
+    {
+        m_gds2.erase(EncodingKey(block.get(), false));
+        m_gds2.erase(EncodingKey(block.get(), true));
+        m_blocks.erase(block.get());
+    }
+
+    edge.m_signature = signature;
+    edge.m_blocks = blocks;
+    for(auto const &block : blocks)
+    {
+        m_blocks.insert(block.get());
+    }
+}
+
+std::shared_ptr<const std::vector<uint8_t> > PlacementCache::getGDS2(const PlacementBlock *block, bool useAREF)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto iter = m_gds2.find(EncodingKey(block, useAREF));
+    if (iter == m_gds2.end())
+    {
+        return nullptr;
+    }
+    return iter->second;
+}
+
+void PlacementCache::setGDS2(const PlacementBlock *block, bool useAREF, const uint8_t *data, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // only blocks that are kept alive by an edge have 
+    // a stable address, so only those can be cached.
+    if (m_blocks.count(block) > 0)
+    {
+        m_gds2[EncodingKey(block, useAREF)] = std::make_shared<const std::vector<uint8_t> >(data, data + bytes);
+    }
+}
+
+void PlacementCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_edges.clear();
+    m_gds2.clear();
+    m_blocks.clear();
+}
+
+void PlacementCache::getEdgeCounts(uint32_t &hits, uint32_t &misses)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    hits   = m_edgeHits;
+    misses = m_edgeMisses;
+    m_edgeHits   = 0;
+    m_edgeMisses = 0;
+}
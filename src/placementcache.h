@@ -0,0 +1,91 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef placementcache_h
+#define placementcache_h
+
+#include <stdint.h>
+#include <string>
+#include <memory>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+
+#include "outputsink.h"
+
+/** Keeps the placement blocks of each edge between runs
+    of PadringWriter, together with their GDS2 encoding.
+    When an edge has not changed, its filler cells are not
+    expanded again and its blocks are not encoded again;
+    the cached blocks and bytes are reused.
+
+    An edge is identified by its location and its layout
+    signature (see Layout::getSignature). The cache must be
+    cleared when the filler cells or the LEF database change.
+*/
+class PlacementCache
+{
+public:
+    typedef std::vector<std::shared_ptr<const PlacementBlock> > BlockList;
+
+    PlacementCache() : m_edgeHits(0), m_edgeMisses(0) {}
+
+    /** return the cached blocks of an edge, or nullptr when
+        the edge is not cached or its signature differs. */
+    const BlockList* getEdge(const std::string &location, const std::string &signature);
+
+    /** store the blocks of an edge, replacing the previous
+        blocks of that location and their GDS2 encoding. */
+    void setEdge(const std::string &location, const std::string &signature, const BlockList &blocks);
+
+    /** return the GDS2 encoding of a cached block,
+        or nullptr if it has not been encoded yet. */
+    std::shared_ptr<const std::vector<uint8_t> > getGDS2(const PlacementBlock *block, bool useAREF);
+
+    /** store the GDS2 encoding of a cached block. 
+        blocks that are not cached are ignored. */
+    void setGDS2(const PlacementBlock *block, bool useAREF, const uint8_t *data, size_t bytes);
+
+    /** remove all the edges and encodings */
+    void clear();
+
+    /** return the number of edges that were reused or
+        generated since the last call, and reset the counters. */
+    void getEdgeCounts(uint32_t &hits, uint32_t &misses);
+
+protected:
+    struct Edge
+    {
+        std::string m_signature;
+        BlockList   m_blocks;
+    };
+
+    typedef std::pair<const PlacementBlock*, bool> EncodingKey;
+
+    std::mutex  m_mutex;
+    std::map<std::string, Edge> m_edges;
+    std::map<EncodingKey, std::shared_ptr<const std::vector<uint8_t> > > m_gds2;
+    std::set<const PlacementBlock*> m_blocks;  ///< the blocks of all the edges.
+
+    uint32_t    m_edgeHits;
+    uint32_t    m_edgeMisses;
+};
+
+#endif
@@ -0,0 +1,208 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <zlib.h>
+#include "logging.h"
+#include "pngwriter.h"
+
+/** RGB palette, in colour_t order, as in the SVG file */
+static const uint8_t c_palette[] = 
+{
+    0xFF, 0xFF, 0xFF,   // background
+    0x80, 0x80, 0x80,   // die outline
+    0xBF, 0xE1, 0xF3,   // filler
+    0xFA, 0xAD, 0x35,   // pad
+    0x17, 0x9A, 0xA9,   // corner
+    0xF2, 0x58, 0x44    // pad and corner outline
+};
+
+PNGWriter::PNGWriter(std::ostream &os, double width, double height, uint32_t size)
+    : m_png(os)
+{
+    size = std::max(size, 16u);
+    double largest = std::max(std::max(width, height), 1.0);
+    m_scale = (size - 1) / largest;
+    m_imageWidth  = std::max(static_cast<uint32_t>(lround(width * m_scale)) + 1, 1u);
+    m_imageHeight = std::max(static_cast<uint32_t>(lround(height * m_scale)) + 1, 1u);
+
+    m_pixels.assign(static_cast<size_t>(m_imageWidth) * m_imageHeight, COLOUR_BACKGROUND);
+    outline(0, 0, m_imageWidth-1, m_imageHeight-1, COLOUR_DIE);
+}
+
+bool PNGWriter::close()
+{
+    if (!writeFile())
+    {
+        return false;
+    }
+    m_png.flush();
+    return m_png.good();
+}
+
+void PNGWriter::fill(int32_t x1, int32_t y1, int32_t x2, int32_t y2, colour_t colour)
+{
+    x1 = std::max(x1, 0);
+    y1 = std::max(y1, 0);
+    x2 = std::min(x2, static_cast<int32_t>(m_imageWidth) - 1);
+    y2 = std::min(y2, static_cast<int32_t>(m_imageHeight) - 1);
+    if ((x1 > x2) || (y1 > y2))
+    {
+        return;
+    }
+
+    uint8_t *p = &m_pixels[static_cast<size_t>(y1) * m_imageWidth + x1];
+    for(int32_t y=y1; y<=y2; y++)
+    {
+        memset(p, colour, x2 - x1 + 1);
+        p += m_imageWidth;
+    }
+}
+
+void PNGWriter::outline(int32_t x1, int32_t y1, int32_t x2, int32_t y2, colour_t colour)
+{
+    fill(x1, y1, x2, y1, colour);
+    fill(x1, y2, x2, y2, colour);
+    fill(x1, y1, x1, y2, colour);
+    fill(x2, y1, x2, y2, colour);
+}
+
+void PNGWriter::writeCell(const LayoutItem *item)
+{
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    double x,y,w,h;
+    getPlacedBox(item, x, y, w, h);
+
+    // pixel rows run from the top of the die down,
+    // and every cell covers at least one pixel.
+    int32_t x1 = static_cast<int32_t>(floor(x * m_scale));
+    int32_t x2 = std::max(x1, static_cast<int32_t>(ceil((x + w) * m_scale)) - 1);
+    int32_t top    = static_cast<int32_t>(m_imageHeight) - 1;
+    int32_t y2 = top - static_cast<int32_t>(floor(y * m_scale));
+    int32_t y1 = std::min(y2, top - static_cast<int32_t>(ceil((y + h) * m_scale)) + 1);
+
+    switch(item->m_ltype)
+    {
+    case LayoutItem::TYPE_FILLER:
+        fill(x1, y1, x2, y2, COLOUR_FILLER);
+        return;
+    case LayoutItem::TYPE_CORNER:
+        fill(x1, y1, x2, y2, COLOUR_CORNER);
+        break;
+    default:
+        fill(x1, y1, x2, y2, COLOUR_PAD);
+        break;
+    }
+
+    // pads and corners that are large enough
+    // get an outline, so neighbours stand apart.
+    if ((x2 - x1 >= 3) && (y2 - y1 >= 3))
+    {
+        outline(x1, y1, x2, y2, COLOUR_OUTLINE);
+    }
+}
+
+void PNGWriter::writeChunk(const char *type, const uint8_t *data, size_t bytes)
+{
+    uint8_t header[8] = 
+    {
+        static_cast<uint8_t>(bytes >> 24), static_cast<uint8_t>(bytes >> 16), 
+        static_cast<uint8_t>(bytes >> 8), static_cast<uint8_t>(bytes),
+        static_cast<uint8_t>(type[0]), static_cast<uint8_t>(type[1]), 
+        static_cast<uint8_t>(type[2]), static_cast<uint8_t>(type[3])
+    };
+    uint32_t crc = crc32(0, header + 4, 4);
+    m_png.write(reinterpret_cast<const char*>(header), sizeof(header));
+    if (bytes > 0)
+    {
+        crc = crc32(crc, data, bytes);
+        m_png.write(reinterpret_cast<const char*>(data), bytes);
+    }
+    uint8_t trailer[4] = 
+    {
+        static_cast<uint8_t>(crc >> 24), static_cast<uint8_t>(crc >> 16),
+        static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc)
+    };
+
+    m_png.write(reinterpret_cast<const char*>(trailer), sizeof(trailer));
+}
+
+bool PNGWriter::writeFile()
+{
+    static const uint8_t c_signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    m_png.write(reinterpret_cast<const char*>(c_signature), sizeof(c_signature));
+
+    // 8 bit palette, no interlacing
+    uint8_t ihdr[13] = 
+    {
+        static_cast<uint8_t>(m_imageWidth >> 24), static_cast<uint8_t>(m_imageWidth >> 16),
+        static_cast<uint8_t>(m_imageWidth >> 8), static_cast<uint8_t>(m_imageWidth),
+        static_cast<uint8_t>(m_imageHeight >> 24), static_cast<uint8_t>(m_imageHeight >> 16),
+        static_cast<uint8_t>(m_imageHeight >> 8), static_cast<uint8_t>(m_imageHeight),
+        8, 3, 0, 0, 0
+    };
+    writeChunk("IHDR", ihdr, sizeof(ihdr));
+    writeChunk("PLTE", c_palette, sizeof(c_palette));
+
+    // the rows are not filtered: they consist of long runs
+    // of the same colour, which the fast run-length strategy
+    // of zlib compresses well. this is faster than the 'up'
+    // filter, for a slightly larger file.
+    size_t rowBytes = m_imageWidth;
+    z_stream zs = {};
+    if (deflateInit2(&zs, 1, Z_DEFLATED, 15, 8, Z_RLE) != Z_OK)
+    {
+        doLog(LOG_ERROR, "Cannot initialise the PNG compression\n");
+        return false;
+    }
+
+    std::vector<uint8_t> row(rowBytes + 1, 0);
+    std::vector<uint8_t> compressed(deflateBound(&zs, (rowBytes + 1) * m_imageHeight));
+    zs.next_out  = compressed.data();
+    zs.avail_out = compressed.size();
+    for(uint32_t y=0; y<m_imageHeight; y++)
+    {
+        memcpy(&row[1], &m_pixels[y * rowBytes], rowBytes);
+        zs.next_in  = row.data();
+        zs.avail_in = row.size();
+        bool last = (y + 1 == m_imageHeight);
+        if (deflate(&zs, last ? Z_FINISH : Z_NO_FLUSH) != (last ? Z_STREAM_END : Z_OK))
+        {
+            doLog(LOG_ERROR, "Cannot compress the PNG image data\n");
+            deflateEnd(&zs);
+            return false;
+        }
+    }
+    size_t bytes = zs.total_out;
+    deflateEnd(&zs);
+
+    writeChunk("IDAT", compressed.data(), bytes);
+    writeChunk("IEND", nullptr, 0);
+    m_png.flush();
+
+    doLog(LOG_VERBOSE, "PNG thumbnail: %u x %u pixels, %zu bytes of image data\n", 
+        m_imageWidth, m_imageHeight, bytes);
+    return true;
+}
@@ -0,0 +1,90 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef pngwriter_h
+#define pngwriter_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "layout.h"
+#include "outputsink.h"
+
+/** Renders a thumbnail of the padring into a pixel buffer
+    and writes it as a PNG image.
+
+    Every placed cell is scan-converted as a rectangle, 
+    with fillers, pads and corners in different colours.
+    Cells smaller than a pixel still cover one pixel. As
+    there are only a few colours, the pixels are palette
+    indices, which makes the buffer and the image data 
+    three times smaller than RGB. The image is written 
+    when the writer is closed.
+*/
+class PNGWriter : public OutputSink
+{
+public:
+    /** the largest side of the image is size pixels, 
+        the other side follows the aspect ratio of the die. */
+    PNGWriter(std::ostream &os, double width, double height, uint32_t size = 2048);
+
+    void writeCell(const LayoutItem *item) override;
+
+    /** writes the PNG file. returns false on an I/O error. */
+    bool close() override;
+
+    uint32_t getImageWidth() const { return m_imageWidth; }
+    uint32_t getImageHeight() const { return m_imageHeight; }
+
+protected:
+    /** palette indices */
+    enum colour_t
+    {
+        COLOUR_BACKGROUND = 0,
+        COLOUR_DIE,
+        COLOUR_FILLER,
+        COLOUR_PAD,
+        COLOUR_CORNER,
+        COLOUR_OUTLINE,
+        COLOUR_COUNT
+    };
+
+    /** fill a rectangle of pixels, the coordinates are inclusive */
+    void fill(int32_t x1, int32_t y1, int32_t x2, int32_t y2, colour_t colour);
+
+    /** draw the outline of a rectangle of pixels */
+    void outline(int32_t x1, int32_t y1, int32_t x2, int32_t y2, colour_t colour);
+
+    /** encode the image and write the PNG file.
+        returns false if the image cannot be compressed. */
+    bool writeFile();
+
+    /** write a PNG chunk with its length and CRC */
+    void writeChunk(const char *type, const uint8_t *data, size_t bytes);
+
+    std::ostream    &m_png;
+    double          m_scale;            ///< pixels per micron
+    uint32_t        m_imageWidth;
+    uint32_t        m_imageHeight;
+    std::vector<uint8_t> m_pixels;      ///< palette indices, top row first
+};
+
+#endif
@@ -0,0 +1,294 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <math.h>
+#include "logging.h"
+#include "outputsink.h"
+#include "reportwriter.h"
+
+ReportWriter::ReportWriter(PadringDB &padring, FillerHandler &fillers)
+    : m_padring(padring),
+      m_fillers(fillers),
+      m_databaseUnits(0.0)
+{
+}
+
+int64_t ReportWriter::toDBU(double v) const
+{
+    return std::llround(v * m_databaseUnits);
+}
+
+bool ReportWriter::addSpace(Gap &gap, double space, uint32_t &fillerCount)
+{
+    gap.m_size += space;
+    int32_t count = m_fillers.fillList(space, gap.m_fillers);
+    if (count < 0)
+    {
+        doLog(LOG_ERROR, "Cannot find filler cell that fits remaining width %f\n", space);
+        return false;
+    }
+    fillerCount += count;
+    return true;
+}
+
+bool ReportWriter::collect()
+{
+    m_entries.clear();
+
+    const char *cornerEdges[4] = {"N", "N", "S", "S"};
+    const LayoutItem *corners[4] = {
+        m_padring.m_north.getFirstCorner(), m_padring.m_north.getLastCorner(),
+        m_padring.m_south.getFirstCorner(), m_padring.m_south.getLastCorner()};
+
+    for(uint32_t i=0; i<4; i++)
+    {
+        if (corners[i] != nullptr)
+        {
+            Entry entry;
+            entry.m_item   = corners[i];
+            entry.m_edge   = cornerEdges[i];
+            entry.m_corner = true;
+            m_entries.push_back(entry);
+        }
+    }
+
+    const char *edgeNames[4] = {"north", "south", "east", "west"};
+    const char *locations[4] = {"N", "S", "E", "W"};
+    Layout *edges[4] = {&m_padring.m_north, &m_padring.m_south, &m_padring.m_east, &m_padring.m_west};
+    double dieSizes[4] = {m_padring.m_dieWidth, m_padring.m_dieWidth, 
+        m_padring.m_dieHeight, m_padring.m_dieHeight};
+
+    for(uint32_t e=0; e<4; e++)
+    {
+        EdgeSummary &summary = m_summary[e];
+        summary.m_name    = edgeNames[e];
+        summary.m_size    = dieSizes[e];
+        summary.m_minSize = edges[e]->getMinSize();
+        summary.m_pads    = 0;
+        summary.m_fillers = 0;
+
+        // the gap before a pad is the gap after the
+        // previous pad, or the gap after the corner.
+        Gap gap;
+        size_t previous = 0;
+        bool havePrevious = false;
+        for(auto item : *edges[e])
+        {
+            if (item->m_ltype == LayoutItem::TYPE_CELL)
+            {
+                if (havePrevious)
+                {
+                    m_entries[previous].m_after = gap;
+                }
+
+                Entry entry;
+                entry.m_item   = item;
+                entry.m_edge   = locations[e];
+                entry.m_corner = false;
+                entry.m_before = gap;
+                previous = m_entries.size();
+                havePrevious = true;
+                m_entries.push_back(entry);
+                summary.m_pads++;
+                gap = Gap();
+            }
+            else if ((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
+            {
+                if (!addSpace(gap, item->m_size, summary.m_fillers))
+                {
+                    return false;
+                }
+            }
+        }
+
+        if (havePrevious)
+        {
+            m_entries[previous].m_after = gap;
+        }
+    }
+
+    if (m_databaseUnits < 1e-12)
+    {
+        doLog(LOG_WARN, "Report: database units not set, using 100 units per micron\n");
+        m_databaseUnits = 100.0;
+    }
+    return true;
+}
+
+void ReportWriter::putGapJSON(const Gap &gap)
+{
+    m_out.put("{\"gap\": ");
+    m_out.putInt(toDBU(gap.m_size));
+    m_out.put(", \"fillers\": [");
+    for(size_t i=0; i<gap.m_fillers.size(); i++)
+    {
+        m_out.put((i > 0) ? ", {\"cell\": " : "{\"cell\": ");
+        m_out.putJSONString(gap.m_fillers[i].first);
+        m_out.put(", \"count\": ");
+        m_out.putInt(gap.m_fillers[i].second);
+        m_out.put("}");
+    }
+    m_out.put("]}");
+}
+
+bool ReportWriter::writeJSON(std::ostream &os)
+{
+    if (!collect())
+    {
+        return false;
+    }
+
+    m_out.setStream(&os);
+    m_out.put("{\n  \"design\": ");
+    m_out.putJSONString(m_padring.m_designName);
+    m_out.put(",\n  \"units\": ");
+    m_out.putInt(llround(m_databaseUnits));
+    m_out.put(",\n  \"die\": {\"width\": ");
+    m_out.putInt(toDBU(m_padring.m_dieWidth));
+    m_out.put(", \"height\": ");
+    m_out.putInt(toDBU(m_padring.m_dieHeight));
+    m_out.put("},\n  \"edges\": {\n");
+    for(uint32_t e=0; e<4; e++)
+    {
+        const EdgeSummary &summary = m_summary[e];
+        m_out.put("    \"");
+        m_out.put(summary.m_name);
+        m_out.put("\": {\"size\": ");
+        m_out.putInt(toDBU(summary.m_size));
+        m_out.put(", \"min_size\": ");
+        m_out.putInt(toDBU(summary.m_minSize));
+        m_out.put(", \"slack\": ");
+        m_out.putInt(toDBU(summary.m_size) - toDBU(summary.m_minSize));
+        m_out.put(", \"pads\": ");
+        m_out.putInt(summary.m_pads);
+        m_out.put(", \"fillers\": ");
+        m_out.putInt(summary.m_fillers);
+        m_out.put((e < 3) ? "},\n" : "}\n");
+    }
+    m_out.put("  },\n  \"cells\": [\n");
+
+    for(size_t i=0; i<m_entries.size(); i++)
+    {
+        const Entry &entry = m_entries[i];
+        double x,y,w,h;
+        OutputSink::orientation_t orientation = OutputSink::getPlacedBox(entry.m_item, x, y, w, h);
+
+        m_out.put("    {\"instance\": ");
+        m_out.putJSONString(entry.m_item->m_instance);
+        m_out.put(", \"cell\": ");
+        m_out.putJSONString(entry.m_item->m_cellname);
+        m_out.put(", \"type\": ");
+        m_out.put(entry.m_corner ? "\"corner\"" : "\"pad\"");
+        m_out.put(", \"edge\": \"");
+        m_out.put(entry.m_corner ? entry.m_item->m_location : std::string(entry.m_edge));
+        m_out.put("\", \"x\": ");
+        m_out.putInt(toDBU(x));
+        m_out.put(", \"y\": ");
+        m_out.putInt(toDBU(y));
+        m_out.put(", \"orientation\": \"");
+        m_out.put(OutputSink::getOrientationName(orientation));
+        m_out.put(entry.m_item->m_flipped ? "\", \"flip\": true" : "\", \"flip\": false");
+        if (!entry.m_corner)
+        {
+            m_out.put(", \"before\": ");
+            putGapJSON(entry.m_before);
+            m_out.put(", \"after\": ");
+            putGapJSON(entry.m_after);
+        }
+        m_out.put((i + 1 < m_entries.size()) ? "},\n" : "}\n");
+    }
+    m_out.put("  ]\n}\n");
+    m_out.flush();
+    os.flush();
+    return os.good();
+}
+
+void ReportWriter::putGapCSV(const Gap &gap)
+{
+    m_out.putInt(toDBU(gap.m_size));
+    m_out.put(",");
+    m_out.put(FillerHandler::toString(gap.m_fillers));
+}
+
+bool ReportWriter::writeCSV(std::ostream &os)
+{
+    if (!collect())
+    {
+        return false;
+    }
+
+    m_out.setStream(&os);
+    m_out.put("# design,units,die_width,die_height\n# ");
+    m_out.putCSVField(m_padring.m_designName);
+    m_out.put(",");
+    m_out.putInt(llround(m_databaseUnits));
+    m_out.put(",");
+    m_out.putInt(toDBU(m_padring.m_dieWidth));
+    m_out.put(",");
+    m_out.putInt(toDBU(m_padring.m_dieHeight));
+    m_out.put("\n# edge,size,min_size,slack,pads,fillers\n");
+    for(auto const &summary : m_summary)
+    {
+        m_out.put("# ");
+        m_out.put(summary.m_name);
+        m_out.put(",");
+        m_out.putInt(toDBU(summary.m_size));
+        m_out.put(",");
+        m_out.putInt(toDBU(summary.m_minSize));
+        m_out.put(",");
+        m_out.putInt(toDBU(summary.m_size) - toDBU(summary.m_minSize));
+        m_out.put(",");
+        m_out.putInt(summary.m_pads);
+        m_out.put(",");
+        m_out.putInt(summary.m_fillers);
+        m_out.put("\n");
+    }
+
+    m_out.put("instance,cell,type,edge,x,y,orientation,flip,gap_before,fillers_before,gap_after,fillers_after\n");
+    for(auto const &entry : m_entries)
+    {
+        double x,y,w,h;
+        OutputSink::orientation_t orientation = OutputSink::getPlacedBox(entry.m_item, x, y, w, h);
+
+        m_out.putCSVField(entry.m_item->m_instance);
+        m_out.put(",");
+        m_out.putCSVField(entry.m_item->m_cellname);
+        m_out.put(entry.m_corner ? ",corner," : ",pad,");
+        m_out.put(entry.m_corner ? entry.m_item->m_location : std::string(entry.m_edge));
+        m_out.put(",");
+        m_out.putInt(toDBU(x));
+        m_out.put(",");
+        m_out.putInt(toDBU(y));
+        m_out.put(",");
+        m_out.put(OutputSink::getOrientationName(orientation));
+        m_out.put(entry.m_item->m_flipped ? ",1," : ",0,");
+        if (entry.m_corner)
+        {
+            m_out.put(",,,\n");
+            continue;
+        }
+        putGapCSV(entry.m_before);
+        m_out.put(",");
+        putGapCSV(entry.m_after);
+        m_out.put("\n");
+    }
+    m_out.flush();
+    os.flush();
+    return os.good();
+}
@@ -0,0 +1,116 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef reportwriter_h
+#define reportwriter_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include "padringdb.h"
+#include "fillerhandler.h"
+#include "textwriter.h"
+
+/** Writes a machine-readable placement report of a laid
+    out padring, as JSON or as CSV.
+
+    Every pad and corner is listed with its instance, cell,
+    edge, position in database units, DEF orientation and 
+    flip. For pads, the gap to the previous and the next 
+    cell on the edge is given, together with the filler 
+    cells that fill it. A summary gives the size, minimum
+    size and slack of each edge.
+
+    The report is generated from the Layout edges and 
+    streamed through the block buffer of a TextWriter.
+
+    In the CSV format, the summary is written as comment
+    lines starting with '#' in front of the table.
+*/
+class ReportWriter
+{
+public:
+    ReportWriter(PadringDB &padring, FillerHandler &fillers);
+
+    void setDatabaseUnits(double databaseUnits)
+    {
+        m_databaseUnits = databaseUnits;
+    }
+
+    /** write the report as JSON */
+    bool writeJSON(std::ostream &os);
+
+    /** write the report as comma separated values */
+    bool writeCSV(std::ostream &os);
+
+protected:
+    /** the gap on one side of a pad */
+    struct Gap
+    {
+        Gap() : m_size(0.0) {}
+
+        double m_size;     ///< in microns
+        FillerHandler::fillerList_t m_fillers;
+    };
+
+    /** a pad or corner in the report */
+    struct Entry
+    {
+        const LayoutItem *m_item;
+        const char  *m_edge;
+        bool        m_corner;
+        Gap         m_before;
+        Gap         m_after;
+    };
+
+    /** per edge summary */
+    struct EdgeSummary
+    {
+        const char  *m_name;
+        double      m_size;
+        double      m_minSize;
+        uint32_t    m_pads;
+        uint32_t    m_fillers;
+    };
+
+    /** collect the corners, the pads and their gaps.
+        returns false if a space cannot be filled. */
+    bool collect();
+
+    /** add the fillers of a space to a gap */
+    bool addSpace(Gap &gap, double space, uint32_t &fillerCount);
+
+    int64_t toDBU(double v) const;
+
+    void putGapJSON(const Gap &gap);
+    void putGapCSV(const Gap &gap);
+
+    PadringDB       &m_padring;
+    FillerHandler   &m_fillers;
+    double          m_databaseUnits;
+
+    std::vector<Entry>  m_entries;
+    EdgeSummary         m_summary[4];
+
+    TextWriter          m_out;
+};
+
+#endif
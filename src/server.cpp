@@ -0,0 +1,376 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <thread>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "padringjob.h"
+#include "server.h"
+
+/** largest configuration accepted in a request */
+static const size_t c_maxConfigSize = 64*1024*1024;
+
+bool Server::Connection::fill()
+{
+    while(true)
+    {
+        ssize_t bytes = ::read(m_in, &m_buffer[0], m_buffer.size());
+        if (bytes > 0)
+        {
+            m_pos = 0;
+            m_len = bytes;
+            return true;
+        }
+        if ((bytes < 0) && (errno == EINTR))
+        {
+            continue;
+        }
+        return false;
+    }
+}
+
+bool Server::Connection::readLine(std::string &line)
+{
+    line.clear();
+    while(true)
+    {
+        if ((m_pos == m_len) && !fill())
+        {
+            return false;
+        }
+
+        const char *start = &m_buffer[m_pos];
+        const char *newline = static_cast<const char*>(memchr(start, '\n', m_len - m_pos));
+        if (newline != nullptr)
+        {
+            line.append(start, newline - start);
+            m_pos += (newline - start) + 1;
+            return true;
+        }
+        line.append(start, m_len - m_pos);
+        m_pos = m_len;
+    }
+}
+
+bool Server::Connection::read(std::string &data, size_t bytes)
+{
+    data.clear();
+    data.reserve(bytes);
+    while(data.size() < bytes)
+    {
+        if ((m_pos == m_len) && !fill())
+        {
+            return false;
+        }
+        size_t n = std::min(bytes - data.size(), m_len - m_pos);
+        data.append(&m_buffer[m_pos], n);
+        m_pos += n;
+    }
+    return true;
+}
+
+bool Server::Connection::write(const std::string &data)
+{
+    size_t pos = 0;
+    while(pos < data.size())
+    {
+        ssize_t bytes = ::write(m_out, data.data() + pos, data.size() - pos);
+        if (bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        pos += bytes;
+    }
+    return true;
+}
+
+std::string Server::result(const std::string &status, size_t files, const logbuffer_t &log)
+{
+    std::string text;
+    for(auto const &msg : log)
+    {
+        text += getLogPrefix(msg.first);
+        text += msg.second;
+    }
+
+    return "RESULT " + status + " " + std::to_string(files) + " " + 
+        std::to_string(text.size()) + "\n" + text;
+}
+
+std::string Server::layout(const std::string &config, std::istream &options)
+{
+    logbuffer_t log;
+    setThreadLogBuffer(&log);
+
+    PadringJob job;
+    bool ok = job.parseOptions(options, "Request");
+
+    // the files are written to a private directory,
+    // so only plain names are allowed.
+    std::vector<std::string> names = job.getOutputFilenames();
+    std::set<std::string> unique;
+    for(auto const &name : names)
+    {
+        if (!ok)
+        {
+            break;
+        }
+        if ((name.find('/') != std::string::npos) || (name == ".") || (name == ".."))
+        {
+            doLog(LOG_ERROR, "Request : output file %s must not contain a directory\n", name.c_str());
+            ok = false;
+        }
+        else if (!unique.insert(name).second)
+        {
+            doLog(LOG_ERROR, "Request : output file %s is requested more than once\n", name.c_str());
+            ok = false;
+        }
+    }
+
+    if (!ok)
+    {
+        setThreadLogBuffer(nullptr);
+        return result("option_error", 0, log);
+    }
+
+    const char *tmpdir = getenv("TMPDIR");
+    std::string directory = std::string((tmpdir != nullptr) ? tmpdir : "/tmp") + "/padring.XXXXXX";
+    if (mkdtemp(&directory[0]) == nullptr)
+    {
+        doLog(LOG_ERROR, "Cannot create a directory for the output files: %s\n", strerror(errno));
+        setThreadLogBuffer(nullptr);
+        return result("write_error", 0, log);
+    }
+    job.setOutputDirectory(directory);
+
+    std::istringstream configStream(config);
+    std::string status = job.process(m_lefreader, configStream, m_databaseUnits);
+
+    // read the files back and remove them,
+    // whether the job succeeded or not.
+    std::string files;
+    for(auto const &name : names)
+    {
+        std::string filename = directory + "/" + name;
+        if (status == "ok")
+        {
+            std::ifstream fileStream(filename, std::ifstream::in | std::ifstream::binary);
+            std::stringstream data;
+            data << fileStream.rdbuf();
+            std::string contents = data.str();
+            files += "FILE " + name + " " + std::to_string(contents.size()) + "\n";
+            files += contents;
+        }
+        unlink(filename.c_str());
+    }
+
+    if (rmdir(directory.c_str()) != 0)
+    {
+        doLog(LOG_WARN, "Cannot remove directory %s: %s\n", directory.c_str(), strerror(errno));
+    }
+
+    setThreadLogBuffer(nullptr);
+    return result(status, (status == "ok") ? names.size() : 0, log) + files;
+}
+
+bool Server::protocolError(Connection &conn, const std::string &message)
+{
+    // the rest of the input cannot be interpreted,
+    // so the connection is closed after the answer.
+    doLog(LOG_ERROR, "%s", message.c_str());
+    logbuffer_t log;
+    log.emplace_back(LOG_ERROR, message);
+    conn.write(result("protocol_error", 0, log));
+    return false;
+}
+
+bool Server::serve(int inFd, int outFd)
+{
+    Connection conn(inFd, outFd);
+    std::string line;
+    while(!m_stop && conn.readLine(line))
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        std::istringstream ss(line);
+        std::string command;
+        if (!(ss >> command))
+        {
+            continue;   // empty line
+        }
+
+        std::string answer;
+        if (command == "LAYOUT")
+        {
+            size_t bytes;
+            std::string config;
+            if (!(ss >> bytes) || (bytes > c_maxConfigSize) || !conn.read(config, bytes))
+            {
+                return protocolError(conn, "Malformed LAYOUT request\n");
+            }
+            answer = layout(config, ss);
+        }
+        else if (command == "PING")
+        {
+            answer = result("ok", 0, logbuffer_t());
+        }
+        else if (command == "QUIT")
+        {
+            return true;
+        }
+        else if (command == "SHUTDOWN")
+        {
+            m_stop = true;
+            conn.write(result("ok", 0, logbuffer_t()));
+
+            // stop accepting connections and end the
+            // other connections after their current request.
+            std::lock_guard<std::mutex> lock(m_clientMutex);
+            if (m_listenFd >= 0)
+            {
+                shutdown(m_listenFd, SHUT_RDWR);
+            }
+            for(auto client : m_clients)
+            {
+                shutdown(client, SHUT_RD);
+            }
+            return true;
+        }
+        else
+        {
+            return protocolError(conn, "Unknown request " + command + "\n");
+        }
+
+        if (!conn.write(answer))
+        {
+            return false;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        doLog(LOG_VERBOSE, "%s request answered in %f ms\n", command.c_str(), elapsed.count()*1000.0);
+    }
+    return true;
+}
+
+bool Server::listen(const std::string &path)
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path))
+    {
+        doLog(LOG_ERROR, "Socket path %s is too long\n", path.c_str());
+        return false;
+    }
+    strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+
+    // remove a socket left behind by an earlier server,
+    // but never a regular file.
+    struct stat info;
+    if ((stat(path.c_str(), &info) == 0) && S_ISSOCK(info.st_mode))
+    {
+        unlink(path.c_str());
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        doLog(LOG_ERROR, "Cannot create socket: %s\n", strerror(errno));
+        return false;
+    }
+
+    if ((bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) || (::listen(fd, 16) != 0))
+    {
+        doLog(LOG_ERROR, "Cannot listen on socket %s: %s\n", path.c_str(), strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    // a client that disconnects early must not
+    // terminate the server.
+    signal(SIGPIPE, SIG_IGN);
+
+    {
+        std::lock_guard<std::mutex> lock(m_clientMutex);
+        m_listenFd = fd;
+    }
+
+    doLog(LOG_INFO, "Listening on %s\n", path.c_str());
+
+    // every connection gets its own thread, so an idle
+    // client cannot hold up the others.
+    while(!m_stop)
+    {
+        int client = accept(fd, nullptr, nullptr);
+        if (client < 0)
+        {
+            if ((errno == EINTR) && !m_stop)
+            {
+                continue;
+            }
+            break;
+        }
+
+        std::lock_guard<std::mutex> lock(m_clientMutex);
+        if (m_stop)
+        {
+            close(client);
+            break;
+        }
+        m_clients.insert(client);
+
+        std::thread([this, client]()
+        {
+            serve(client, client);
+            std::lock_guard<std::mutex> lock(m_clientMutex);
+            m_clients.erase(client);
+            close(client);
+            m_clientsDone.notify_all();
+        }).detach();
+    }
+
+    // wait for the requests that are still running
+    {
+        std::unique_lock<std::mutex> lock(m_clientMutex);
+        m_clientsDone.wait(lock, [this]() { return m_clients.empty(); });
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_clientMutex);
+        m_listenFd = -1;
+    }
+    close(fd);
+    unlink(path.c_str());
+
+    doLog(LOG_INFO, "Server stopped\n");
+    return true;
+}
@@ -0,0 +1,131 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef server_h
+#define server_h
+
+#include <string>
+#include <vector>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+
+#include "prlefreader.h"
+#include "logging.h"
+
+/** Keeps the LEF database in memory and lays out
+    padrings on request, so a client does not pay for
+    process startup and LEF parsing on every call.
+
+    Requests are read from a Unix domain socket or from
+    stdin, one after the other. Each request is a line,
+    optionally followed by data:
+
+    LAYOUT <config bytes> [options]\n<config text>
+    PING\n
+    QUIT\n          close the connection.
+    SHUTDOWN\n      stop the server.
+
+    The options of LAYOUT are the options of a batch
+    manifest line, e.g. "--def chip.def --svg chip.svg
+    --fit". Filenames must not contain a directory; the
+    files are written to a private directory and sent
+    back with the answer:
+
+    RESULT <status> <file count> <log bytes>\n<log text>
+    FILE <name> <bytes>\n<data>     (once for each file)
+
+    The status is ok, option_error, protocol_error or
+    one of the statuses of PadringJob::process. After a
+    protocol_error, the connection is closed. PING and SHUTDOWN
+    are answered with an ok RESULT without files.
+*/
+class Server
+{
+public:
+    Server(const PRLEFReader &lefreader)
+        : m_lefreader(lefreader), m_databaseUnits(0.0), 
+          m_listenFd(-1), m_stop(false) {}
+
+    void setDatabaseUnits(double databaseUnits)
+    {
+        m_databaseUnits = databaseUnits;
+    }
+
+    /** answer the requests read from inFd on outFd until
+        the end of the input, QUIT or SHUTDOWN.
+        returns false on a malformed request.
+    */
+    bool serve(int inFd, int outFd);
+
+    /** listen on a Unix domain socket and serve each
+        connection on its own thread, until a client sends
+        SHUTDOWN. returns false if the socket cannot be created.
+    */
+    bool listen(const std::string &path);
+
+protected:
+    /** buffered reading and writing of a file descriptor */
+    class Connection
+    {
+    public:
+        Connection(int inFd, int outFd) : m_in(inFd), m_out(outFd), 
+            m_buffer(65536), m_pos(0), m_len(0) {}
+
+        /** read a line without the newline.
+            returns false at the end of the input. */
+        bool readLine(std::string &line);
+
+        /** read exactly the given number of bytes */
+        bool read(std::string &data, size_t bytes);
+
+        /** write all the data */
+        bool write(const std::string &data);
+
+    protected:
+        bool fill();
+
+        int                 m_in;
+        int                 m_out;
+        std::vector<char>   m_buffer;
+        size_t              m_pos;
+        size_t              m_len;
+    };
+
+    /** lay out a padring. returns the answer to send. */
+    std::string layout(const std::string &config, std::istream &options);
+
+    /** answer a malformed request. always returns false. */
+    bool protocolError(Connection &conn, const std::string &message);
+
+    /** build the RESULT line and log text of an answer */
+    static std::string result(const std::string &status, size_t files, const logbuffer_t &log);
+
+    const PRLEFReader   &m_lefreader;
+    double              m_databaseUnits;
+
+    int                 m_listenFd;     ///< socket accepting connections, -1 when serving stdin.
+    std::atomic<bool>   m_stop;
+    std::mutex          m_clientMutex;
+    std::set<int>       m_clients;      ///< connected client sockets.
+    std::condition_variable m_clientsDone;
+};
+
+#endif
@@ -0,0 +1,192 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "sha256.h"
+
+static const uint32_t c_roundConstants[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotr(uint32_t x, uint32_t n)
+{
+    return (x >> n) | (x << (32-n));
+}
+
+SHA256::SHA256() : m_bufferBytes(0), m_totalBytes(0)
+{
+    m_state[0] = 0x6a09e667;
+    m_state[1] = 0xbb67ae85;
+    m_state[2] = 0x3c6ef372;
+    m_state[3] = 0xa54ff53a;
+    m_state[4] = 0x510e527f;
+    m_state[5] = 0x9b05688c;
+    m_state[6] = 0x1f83d9ab;
+    m_state[7] = 0x5be0cd19;
+}
+
+void SHA256::transform(const uint8_t *block)
+{
+    uint32_t w[64];
+    for(uint32_t i=0; i<16; i++)
+    {
+        w[i] = (static_cast<uint32_t>(block[i*4]) << 24) |
+            (static_cast<uint32_t>(block[i*4+1]) << 16) |
+            (static_cast<uint32_t>(block[i*4+2]) << 8) |
+            static_cast<uint32_t>(block[i*4+3]);
+    }
+
+    for(uint32_t i=16; i<64; i++)
+    {
+        uint32_t s0 = rotr(w[i-15], 7) ^ rotr(w[i-15], 18) ^ (w[i-15] >> 3);
+        uint32_t s1 = rotr(w[i-2], 17) ^ rotr(w[i-2], 19) ^ (w[i-2] >> 10);
+        w[i] = w[i-16] + s0 + w[i-7] + s1;
+    }
+
+    uint32_t a = m_state[0];
+    uint32_t b = m_state[1];
+    uint32_t c = m_state[2];
+    uint32_t d = m_state[3];
+    uint32_t e = m_state[4];
+    uint32_t f = m_state[5];
+    uint32_t g = m_state[6];
+    uint32_t h = m_state[7];
+
+    for(uint32_t i=0; i<64; i++)
+    {
+        uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + c_roundConstants[i] + w[i];
+        uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + t1;
+        d = c;
+        c = b;
+        b = a;
+        a = t1 + t2;
+    }
+
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+    m_state[4] += e;
+    m_state[5] += f;
+    m_state[6] += g;
+    m_state[7] += h;
+}
+
+void SHA256::update(const void *data, size_t bytes)
+{
+    const uint8_t *ptr = static_cast<const uint8_t*>(data);
+    m_totalBytes += bytes;
+
+    // complete a partially filled block first
+    if (m_bufferBytes > 0)
+    {
+        size_t n = std::min(bytes, sizeof(m_buffer) - m_bufferBytes);
+        memcpy(m_buffer + m_bufferBytes, ptr, n);
+        m_bufferBytes += n;
+        ptr += n;
+        bytes -= n;
+        if (m_bufferBytes < sizeof(m_buffer))
+        {
+            return;
+        }
+        transform(m_buffer);
+        m_bufferBytes = 0;
+    }
+
+    while(bytes >= sizeof(m_buffer))
+    {
+        transform(ptr);
+        ptr += sizeof(m_buffer);
+        bytes -= sizeof(m_buffer);
+    }
+
+    memcpy(m_buffer, ptr, bytes);
+    m_bufferBytes = bytes;
+}
+
+std::string SHA256::hexDigest()
+{
+    // pad with a one bit, zeros and the 
+    // message length in bits.
+    uint64_t bits = m_totalBytes * 8;
+    uint8_t padding[72];
+    size_t padBytes = ((m_bufferBytes < 56) ? 56 : 120) - m_bufferBytes;
+    memset(padding, 0, sizeof(padding));
+    padding[0] = 0x80;
+    for(uint32_t i=0; i<8; i++)
+    {
+        padding[padBytes+i] = static_cast<uint8_t>(bits >> (56 - i*8));
+    }
+    update(padding, padBytes + 8);
+
+    static const char c_hexDigits[] = "0123456789abcdef";
+    std::string result;
+    for(uint32_t i=0; i<8; i++)
+    {
+        for(int32_t shift=28; shift>=0; shift-=4)
+        {
+            result += c_hexDigits[(m_state[i] >> shift) & 0xf];
+        }
+    }
+    return result;
+}
+
+bool SHA256::hashFile(const std::string &filename, std::string &hexDigest, uint64_t &bytes)
+{
+    FILE *fin = fopen(filename.c_str(), "rb");
+    if (fin == nullptr)
+    {
+        return false;
+    }
+
+    SHA256 sha;
+    std::vector<uint8_t> buffer(1024*1024);
+    size_t n;
+    while((n = fread(&buffer[0], 1, buffer.size(), fin)) > 0)
+    {
+        sha.update(&buffer[0], n);
+    }
+
+    bool ok = (ferror(fin) == 0);
+    fclose(fin);
+
+    bytes = sha.m_totalBytes;
+    hexDigest = sha.hexDigest();
+    return ok;
+}
@@ -0,0 +1,64 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef sha256_h
+#define sha256_h
+
+#include <stdint.h>
+#include <string>
+
+/** Computes the SHA-256 digest (FIPS 180-4) of a
+    stream of bytes. Used to key the output cache and
+    to record the digests of the files it holds.
+*/
+class SHA256
+{
+public:
+    SHA256();
+
+    /** add data to the digest */
+    void update(const void *data, size_t bytes);
+
+    void update(const std::string &data)
+    {
+        update(data.data(), data.size());
+    }
+
+    /** finish the digest and return it as 64 lower
+        case hex digits. the object cannot be updated
+        afterwards.
+    */
+    std::string hexDigest();
+
+    /** compute the digest of a file. 
+        returns false if the file cannot be read. 
+    */
+    static bool hashFile(const std::string &filename, std::string &hexDigest, uint64_t &bytes);
+
+protected:
+    /** process one 64-byte block */
+    void transform(const uint8_t *block);
+
+    uint32_t m_state[8];
+    uint8_t  m_buffer[64];
+    size_t   m_bufferBytes;     ///< bytes waiting in m_buffer
+    uint64_t m_totalBytes;      ///< bytes added so far
+};
+
+#endif
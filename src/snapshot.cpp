@@ -0,0 +1,359 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "logging.h"
+#include "snapshot.h"
+
+const char     Snapshot::c_magic[8]      = {'P','R','S','N','A','P','\r','\n'};
+const uint32_t Snapshot::c_version       = 1;
+const uint32_t Snapshot::c_byteOrderMark = 0x01020304;
+
+void Snapshot::Encoder::putString(const std::string &str)
+{
+    put<uint32_t>(str.size());
+    m_data += str;
+}
+
+void Snapshot::Encoder::putItem(const LayoutItem *item, const CellIndex &cellIndex)
+{
+    auto iter = cellIndex.find(item->m_lefinfo);
+    put<uint8_t>(item->m_ltype);
+    put<uint8_t>(item->m_flipped ? 1 : 0);
+    put<int32_t>((iter != cellIndex.end()) ? iter->second : -1);
+    put<double>(item->m_size);
+    put<double>(item->m_x);
+    put<double>(item->m_y);
+    putString(item->m_instance);
+    putString(item->m_cellname);
+    putString(item->m_location);
+}
+
+void Snapshot::Encoder::putLayout(Layout &layout, const CellIndex &cellIndex)
+{
+    put<uint8_t>(layout.m_dir);
+    put<uint8_t>(layout.m_insertFlexSpacer ? 1 : 0);
+    put<double>(layout.m_edgePos);
+    put<double>(layout.m_dieSize);
+
+    for(auto corner : {layout.m_firstCorner, layout.m_lastCorner})
+    {
+        put<uint8_t>((corner != nullptr) ? 1 : 0);
+        if (corner != nullptr)
+        {
+            putItem(corner, cellIndex);
+        }
+    }
+
+    put<uint32_t>(layout.m_items.size());
+    for(auto item : layout.m_items)
+    {
+        putItem(item, cellIndex);
+    }
+}
+
+std::string Snapshot::Decoder::getString()
+{
+    uint32_t bytes = get<uint32_t>();
+    if (m_error || ((m_pos + bytes) > m_size))
+    {
+        m_error = true;
+        return std::string();
+    }
+
+    std::string str(reinterpret_cast<const char*>(m_data + m_pos), bytes);
+    m_pos += bytes;
+    return str;
+}
+
+LayoutItem* Snapshot::Decoder::getItem(const std::vector<PRLEFReader::LEFCellInfo_t*> &cells)
+{
+    uint8_t ltype = get<uint8_t>();
+    if (ltype > LayoutItem::TYPE_FILLER)
+    {
+        m_error = true;
+        ltype = LayoutItem::TYPE_FLEXSPACE;
+    }
+
+    LayoutItem *item = new LayoutItem(static_cast<LayoutItem::LayoutItemType>(ltype));
+    item->m_flipped = (get<uint8_t>() != 0);
+    int32_t cell = get<int32_t>();
+    if ((cell >= 0) && (static_cast<size_t>(cell) < cells.size()))
+    {
+        item->m_lefinfo = cells[cell];
+    }
+    else if (cell != -1)
+    {
+        m_error = true;
+    }
+    item->m_size     = get<double>();
+    item->m_x        = get<double>();
+    item->m_y        = get<double>();
+    item->m_instance = getString();
+    item->m_cellname = getString();
+    item->m_location = getString();
+    return item;
+}
+
+void Snapshot::Decoder::getLayout(Layout &layout, const std::vector<PRLEFReader::LEFCellInfo_t*> &cells)
+{
+    layout.m_dir = (get<uint8_t>() == Layout::DIR_HORIZONTAL) ? Layout::DIR_HORIZONTAL : Layout::DIR_VERTICAL;
+    layout.m_insertFlexSpacer = (get<uint8_t>() != 0);
+    layout.m_edgePos = get<double>();
+    layout.m_dieSize = get<double>();
+
+    for(auto corner : {&layout.m_firstCorner, &layout.m_lastCorner})
+    {
+        if (get<uint8_t>() != 0)
+        {
+            *corner = getItem(cells);
+        }
+    }
+
+    uint32_t count = get<uint32_t>();
+    for(uint32_t i=0; (i < count) && !m_error; i++)
+    {
+        layout.m_items.push_back(getItem(cells));
+    }
+}
+
+bool Snapshot::save(const std::string &filename, PadringDB &padring, 
+    const FillerHandler &fillers, double databaseUnits)
+{
+    // the cells that are placed and the filler cells, 
+    // in name order.
+    std::map<std::string, const PRLEFReader::LEFCellInfo_t*> cellMap;
+    Layout *edges[4] = {&padring.m_north, &padring.m_south, &padring.m_east, &padring.m_west};
+    for(auto edge : edges)
+    {
+        for(auto item : *edge)
+        {
+            if (item->m_lefinfo != nullptr)
+            {
+                cellMap[item->m_lefinfo->m_name] = item->m_lefinfo;
+            }
+        }
+        for(auto corner : {edge->getFirstCorner(), edge->getLastCorner()})
+        {
+            if ((corner != nullptr) && (corner->m_lefinfo != nullptr))
+            {
+                cellMap[corner->m_lefinfo->m_name] = corner->m_lefinfo;
+            }
+        }
+    }
+
+    std::vector<std::string> fillerNames = fillers.getCellNames();
+    for(auto const &name : fillerNames)
+    {
+        const PRLEFReader::LEFCellInfo_t *cell = padring.m_lefreader.getCellByName(name);
+        if (cell != nullptr)
+        {
+            cellMap[name] = cell;
+        }
+    }
+
+    Encoder encoder;
+    encoder.m_data.append(c_magic, sizeof(c_magic));
+    encoder.put<uint32_t>(c_version);
+    encoder.put<uint32_t>(c_byteOrderMark);
+
+    encoder.put<double>(databaseUnits);
+    encoder.put<double>(padring.m_dieWidth);
+    encoder.put<double>(padring.m_dieHeight);
+    encoder.put<double>(padring.m_grid);
+    encoder.putString(padring.m_designName);
+    encoder.putString(padring.m_fillerPrefix);
+
+    CellIndex cellIndex;
+    encoder.put<uint32_t>(cellMap.size());
+    for(auto const &cell : cellMap)
+    {
+        int32_t index = cellIndex.size();
+        cellIndex[cell.second] = index;
+        encoder.putString(cell.second->m_name);
+        encoder.putString(cell.second->m_foreign);
+        encoder.putString(cell.second->m_symmetry);
+        encoder.put<double>(cell.second->m_sx);
+        encoder.put<double>(cell.second->m_sy);
+        encoder.put<uint8_t>(cell.second->m_isFiller ? 1 : 0);
+    }
+
+    encoder.put<uint32_t>(fillerNames.size());
+    for(auto const &name : fillerNames)
+    {
+        auto iter = cellMap.find(name);
+        encoder.put<int32_t>((iter != cellMap.end()) ? cellIndex[iter->second] : -1);
+    }
+
+    encoder.put<uint32_t>(padring.m_groups.size());
+    for(auto const &group : padring.m_groups)
+    {
+        encoder.putString(group.first);
+        encoder.put<uint32_t>(group.second.size());
+        for(auto const &instance : group.second)
+        {
+            encoder.putString(instance);
+        }
+    }
+
+    for(auto edge : edges)
+    {
+        encoder.putLayout(*edge, cellIndex);
+    }
+
+    std::ofstream os(filename, std::ofstream::out | std::ofstream::binary);
+    if (!os.is_open())
+    {
+        doLog(LOG_ERROR, "Cannot open snapshot file %s for writing\n", filename.c_str());
+        return false;
+    }
+
+    os.write(encoder.m_data.data(), encoder.m_data.size());
+    os.close();
+    if (os.fail())
+    {
+        doLog(LOG_ERROR, "Cannot write snapshot file %s\n", filename.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool Snapshot::isSnapshot(const std::string &filename)
+{
+    char magic[sizeof(c_magic)];
+    std::ifstream is(filename, std::ifstream::in | std::ifstream::binary);
+    return is.read(magic, sizeof(magic)) && (memcmp(magic, c_magic, sizeof(c_magic)) == 0);
+}
+
+bool Snapshot::load(const std::string &filename, PRLEFReader &lefreader, 
+    PadringDB &padring, FillerHandler &fillers, double &databaseUnits)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        doLog(LOG_ERROR, "Cannot open snapshot file %s\n", filename.c_str());
+        return false;
+    }
+
+    struct stat st;
+    void *map = MAP_FAILED;
+    if ((fstat(fd, &st) == 0) && (st.st_size > 0))
+    {
+        map = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    }
+    ::close(fd);
+    if (map == MAP_FAILED)
+    {
+        doLog(LOG_ERROR, "Cannot read snapshot file %s\n", filename.c_str());
+        return false;
+    }
+
+    Decoder decoder(static_cast<const uint8_t*>(map), st.st_size);
+    char magic[sizeof(c_magic)];
+    for(auto &c : magic)
+    {
+        c = decoder.get<char>();
+    }
+    uint32_t version = decoder.get<uint32_t>();
+    uint32_t byteOrderMark = decoder.get<uint32_t>();
+    if ((memcmp(magic, c_magic, sizeof(c_magic)) != 0) || (version != c_version) || (byteOrderMark != c_byteOrderMark))
+    {
+        doLog(LOG_ERROR, "%s is not a snapshot file of this version and byte order\n", filename.c_str());
+        munmap(map, st.st_size);
+        return false;
+    }
+
+    databaseUnits        = decoder.get<double>();
+    padring.m_dieWidth   = decoder.get<double>();
+    padring.m_dieHeight  = decoder.get<double>();
+    padring.m_grid       = decoder.get<double>();
+    padring.m_designName = decoder.getString();
+    padring.m_fillerPrefix = decoder.getString();
+    lefreader.m_lefDatabaseUnits = databaseUnits;
+
+    std::vector<PRLEFReader::LEFCellInfo_t*> cells;
+    uint32_t cellCount = decoder.get<uint32_t>();
+    for(uint32_t i=0; (i < cellCount) && !decoder.m_error; i++)
+    {
+        // reuse a cell already in the LEF database, like the LEF
+        // reader does for a redefined macro, so it does not leak.
+        std::string name = decoder.getString();
+        PRLEFReader::LEFCellInfo_t *cell = nullptr;
+        auto iter = lefreader.m_cells.find(name);
+        if (iter != lefreader.m_cells.end())
+        {
+            cell = iter->second;
+            *cell = PRLEFReader::LEFCellInfo_t();
+        }
+        else
+        {
+            cell = new PRLEFReader::LEFCellInfo_t();
+            lefreader.m_cells[name] = cell;
+        }
+        cell->m_name     = name;
+        cell->m_foreign  = decoder.getString();
+        cell->m_symmetry = decoder.getString();
+        cell->m_sx       = decoder.get<double>();
+        cell->m_sy       = decoder.get<double>();
+        cell->m_isFiller = (decoder.get<uint8_t>() != 0);
+        cells.push_back(cell);
+    }
+
+    uint32_t fillerCount = decoder.get<uint32_t>();
+    for(uint32_t i=0; (i < fillerCount) && !decoder.m_error; i++)
+    {
+        int32_t index = decoder.get<int32_t>();
+        if ((index >= 0) && (static_cast<size_t>(index) < cells.size()))
+        {
+            fillers.addFillerCell(cells[index]->m_name, cells[index]->m_sx);
+        }
+    }
+
+    uint32_t groupCount = decoder.get<uint32_t>();
+    for(uint32_t i=0; (i < groupCount) && !decoder.m_error; i++)
+    {
+        std::pair<std::string, std::vector<std::string> > group;
+        group.first = decoder.getString();
+        uint32_t instanceCount = decoder.get<uint32_t>();
+        for(uint32_t j=0; (j < instanceCount) && !decoder.m_error; j++)
+        {
+            group.second.push_back(decoder.getString());
+        }
+        padring.m_groups.push_back(group);
+    }
+
+    decoder.getLayout(padring.m_north, cells);
+    decoder.getLayout(padring.m_south, cells);
+    decoder.getLayout(padring.m_east, cells);
+    decoder.getLayout(padring.m_west, cells);
+
+    munmap(map, st.st_size);
+    if (!decoder.isComplete())
+    {
+        doLog(LOG_ERROR, "Snapshot file %s is damaged\n", filename.c_str());
+        return false;
+    }
+    return true;
+}
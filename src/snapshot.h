@@ -0,0 +1,130 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef snapshot_h
+#define snapshot_h
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "prlefreader.h"
+#include "padringdb.h"
+#include "fillerhandler.h"
+
+/** Saves a laid out padring to a binary snapshot file and
+    loads it back, so the outputs can be written again
+    without reading the LEF and configuration files and
+    without laying out the padring.
+
+    The snapshot holds the LEF records of the cells that
+    are used, the filler cells, the die size, grid, design
+    name, LEF database units, pad groups and the four edges
+    with the positions and sizes of all their items. The
+    filler cells of a space are chosen again by PadringWriter,
+    which takes far less time than reading the inputs.
+
+    The file starts with a magic number, a format version
+    and a byte order mark; numbers are stored in the byte 
+    order of the machine. The file is memory-mapped when
+    it is loaded.
+*/
+class Snapshot
+{
+public:
+    /** save a laid out padring. 
+        returns false if the file cannot be written. */
+    static bool save(const std::string &filename, PadringDB &padring, 
+        const FillerHandler &fillers, double databaseUnits);
+
+    /** load a padring from a snapshot. the cell records are
+        added to lefreader, which padring must use. the padring
+        database must be empty. returns false if the file cannot
+        be read or is not a valid snapshot.
+    */
+    static bool load(const std::string &filename, PRLEFReader &lefreader, 
+        PadringDB &padring, FillerHandler &fillers, double &databaseUnits);
+
+    /** check if a file starts like a snapshot file */
+    static bool isSnapshot(const std::string &filename);
+
+protected:
+    /** cell record and its index in the snapshot */
+    typedef std::unordered_map<const PRLEFReader::LEFCellInfo_t*, int32_t> CellIndex;
+
+    /** builds the snapshot data */
+    class Encoder
+    {
+    public:
+        template<class T> void put(T value)
+        {
+            m_data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void putString(const std::string &str);
+        void putItem(const LayoutItem *item, const CellIndex &cellIndex);
+        void putLayout(Layout &layout, const CellIndex &cellIndex);
+
+        std::string m_data;
+    };
+
+    /** reads the mapped snapshot data, checking
+        every read against the end of the data. */
+    class Decoder
+    {
+    public:
+        Decoder(const uint8_t *data, size_t size) 
+            : m_data(data), m_size(size), m_pos(0), m_error(false) {}
+
+        template<class T> T get()
+        {
+            T value = T();
+            if ((m_pos + sizeof(T)) > m_size)
+            {
+                m_error = true;
+                return value;
+            }
+            memcpy(&value, m_data + m_pos, sizeof(T));
+            m_pos += sizeof(T);
+            return value;
+        }
+
+        std::string getString();
+        LayoutItem* getItem(const std::vector<PRLEFReader::LEFCellInfo_t*> &cells);
+        void getLayout(Layout &layout, const std::vector<PRLEFReader::LEFCellInfo_t*> &cells);
+
+        bool isComplete() const
+        {
+            return !m_error && (m_pos == m_size);
+        }
+
+        const uint8_t  *m_data;
+        size_t          m_size;
+        size_t          m_pos;
+        bool            m_error;
+    };
+
+    static const char     c_magic[8];
+    static const uint32_t c_version;
+    static const uint32_t c_byteOrderMark;
+};
+
+#endif
@@ -17,30 +17,47 @@
     
 */
 
+#include <stdarg.h>
 #include <sstream>
 #include <fstream>
 #include <complex>
 #include <math.h>
 #include "logging.h"
+#include "gds2/gds2writer.h"
 #include "svgwriter.h"
 
+//
+// colour palette
+//
+//  #BFE1F3 light blue
+//  #179AA9 blue
+//  #AAD355 green
+//  #F9C908 yellow
+//  #F25844 red
+// 
+
 SVGWriter::SVGWriter(std::ostream &os, uint32_t width, uint32_t height)
     : m_svg(os),
       m_width(width),
-      m_height(height)
+      m_height(height),
+      m_runFirst(LayoutItem::TYPE_FILLER),
+      m_runLast(LayoutItem::TYPE_FILLER),
+      m_runCount(0)
 {
     writeHeader();
 }
 
-SVGWriter::~SVGWriter()
+bool SVGWriter::close()
 {
-    m_svg.flush();    
+    flushRun();
     writeFooter();
+    m_svg.flush();
+    return m_svg.good();
 }
 
 void SVGWriter::writeHeader()
 {
-    m_svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"0 0 ";
+    m_svg << "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" viewBox=\"0 0 ";
     m_svg << m_width << " " << m_height << "\">\n"; 
 }
 
@@ -49,22 +66,29 @@ void SVGWriter::writeFooter()
     m_svg << "</svg>\n";
 }
 
+void SVGWriter::put(const char *format, ...)
+{
+    char buffer[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(buffer, sizeof(buffer), format, args);
+    va_end(args);
+    if (len > 0)
+    {
+        m_svg.write(buffer, std::min(static_cast<size_t>(len), sizeof(buffer)-1));
+    }
+}
 
 std::complex<double> SVGWriter::toSVGCoordinates(std::complex<double> &p) const
 {
     return std::complex<double>(p.real(), m_height - p.imag());
 }
 
-void SVGWriter::writeCell(const LayoutItem *item)
+void SVGWriter::getPlacement(const LayoutItem *item, double &x, double &y, double &rot) const
 {
-    if (item == nullptr)
-    {
-        return;
-    }
-
-    double rot = 0.0;
-    double x = item->m_x;
-    double y = item->m_y;
+    rot = 0.0;
+    x = item->m_x;
+    y = item->m_y;
 
     // regular cells have N,S,E,W,
     // corner cells have NE,NW,SE,SW
@@ -108,94 +132,191 @@ void SVGWriter::writeCell(const LayoutItem *item)
         x += item->m_lefinfo->m_sx;
         rot = 180.0;
     }
+}
 
-    std::complex<double> ll = {0.0,0.0};
-    std::complex<double> ul = {0.0,item->m_lefinfo->m_sy};
-    std::complex<double> ur = {item->m_lefinfo->m_sx,item->m_lefinfo->m_sy};
-    std::complex<double> lr = {item->m_lefinfo->m_sx,0.0};
+SVGWriter::Transform SVGWriter::getTransform(const LayoutItem *item) const
+{
+    double x,y,rot;
+    getPlacement(item, x, y, rot);
 
-    std::complex<double> rr = {cos(3.1415927*rot/180.0), sin(3.1415927*rot/180.0)};
+    // rotations are multiples of 90 degrees
+    double c = round(cos(3.1415927*rot/180.0));
+    double s = round(sin(3.1415927*rot/180.0));
 
-    ll *= rr;
-    ul *= rr;
-    ur *= rr;
-    lr *= rr;
+    // cell coordinates are rotated, moved to (x,y) 
+    // and mirrored vertically for SVG. a flipped cell
+    // is first mirrored around its vertical center line.
+    Transform t;
+    if (item->m_flipped)
+    {
+        double sx = item->m_lefinfo->m_sx;
+        t.m[0] = -c;
+        t.m[1] = s;
+        t.m[2] = -s;
+        t.m[3] = -c;
+        t.m[4] = x + c*sx;
+        t.m[5] = m_height - y - s*sx;
+    }
+    else
+    {
+        t.m[0] = c;
+        t.m[1] = -s;
+        t.m[2] = -s;
+        t.m[3] = -c;
+        t.m[4] = x;
+        t.m[5] = m_height - y;
+    }
 
-    ll += std::complex<double>(x,y);
-    ul += std::complex<double>(x,y);
-    ur += std::complex<double>(x,y);
-    lr += std::complex<double>(x,y);
+    // avoid writing -0
+    for(double &v : t.m)
+    {
+        v += 0.0;
+    }
+    return t;
+}
 
-    ll = toSVGCoordinates(ll);
-    ul = toSVGCoordinates(ul);
-    ur = toSVGCoordinates(ur);
-    lr = toSVGCoordinates(lr);
+void SVGWriter::writeShape(const LayoutItem *item)
+{
+    double sx = item->m_lefinfo->m_sx;
+    double sy = item->m_lefinfo->m_sy;
 
     // draw cell outline
-    m_svg << "<polyline points=\"";
-    m_svg << ll.real() << " " << ll.imag() << " ";
-    m_svg << ul.real() << " " << ul.imag() << " ";
-    m_svg << ur.real() << " " << ur.imag() << " ";
-    m_svg << lr.real() << " " << lr.imag() << " ";
-    m_svg << ll.real() << " " << ll.imag() << "\" ";
-
-    //
-    // colour palette
-    //
-    //  #BFE1F3 light blue
-    //  #179AA9 blue
-    //  #AAD355 green
-    //  #F9C908 yellow
-    //  #F25844 red
-    // 
-
-    //m_svg << "<rect x=\"" << x << "\" y=\"" << m_height-y << "\" ";
-    //m_svg << "width=\"" << sx << "\" height=\"" << sy << "\" ";
+    put("<rect width=\"%.10g\" height=\"%.10g\" ", sx, sy);
     if (item->m_ltype == LayoutItem::TYPE_FILLER)
     {
-        m_svg << "style=\"fill:#BFE1F3;stroke:#179AA9;stroke-width:0.25\" />\n";
+        put("style=\"fill:#BFE1F3;stroke:#179AA9;stroke-width:0.25\" />\n");
     }
     else
     {
-        m_svg << "style=\"fill:#FAAD35;stroke:#F25844;stroke-width:0.5\" />\n";
+        put("style=\"fill:#FAAD35;stroke:#F25844;stroke-width:0.5\" />\n");
     }
 
     // show cell orientation
+    double sw = sx * 0.2;
+    put("<polyline points=\"%.10g 0 0 %.10g\" style=\"stroke:#F25844;stroke-width:0.75\" />\n", sw, sw);
+}
+
+const std::string& SVGWriter::getSymbol(const LayoutItem *item)
+{
+    std::string key = (item->m_ltype == LayoutItem::TYPE_FILLER) ? "F" : "C";
+    key += item->m_cellname;
+
+    auto iter = m_symbols.find(key);
+    if (iter != m_symbols.end())
     {
-        double sw = item->m_lefinfo->m_sx * 0.2;
-        std::complex<double> p1 = {sw,0};
-        std::complex<double> p2 = {0.0,sw};
-        
-        if (item->m_flipped)
-        {
-            p1 = {item->m_lefinfo->m_sx - sw,0};
-            p2 = {item->m_lefinfo->m_sx, sw};
-        }
+        return iter->second;
+    }
 
-        p1 *= rr;
-        p2 *= rr;
-        
-        p1 += std::complex<double>(x,y);
-        p2 += std::complex<double>(x,y);
+    std::string id = "cell" + std::to_string(m_symbols.size());
+    m_svg << "<symbol id=\"" << id << "\" overflow=\"visible\">\n";
+    writeShape(item);
+    m_svg << "</symbol>\n";
 
-        p1 = toSVGCoordinates(p1);
-        p2 = toSVGCoordinates(p2);
+    return m_symbols[key] = id;
+}
 
-        m_svg << "<polyline points=\"";
-        m_svg << p1.real() << " " << p1.imag() << " ";
-        m_svg << p2.real() << " " << p2.imag() << "\" ";
-        m_svg << "style=\"stroke:#F25844;stroke-width:0.75\" />\n";
+const std::string& SVGWriter::getPattern(const LayoutItem *item)
+{
+    auto iter = m_patterns.find(item->m_cellname);
+    if (iter != m_patterns.end())
+    {
+        return iter->second;
     }
 
+    std::string id = "fill" + std::to_string(m_patterns.size());
+    m_svg << "<defs><pattern id=\"" << id << "\" patternUnits=\"userSpaceOnUse\" ";
+    put("width=\"%.10g\" height=\"%.10g\">\n", item->m_size, item->m_lefinfo->m_sy);
+    writeShape(item);
+    m_svg << "</pattern></defs>\n";
+
+    return m_patterns[item->m_cellname] = id;
+}
+
+void SVGWriter::writeUse(const LayoutItem *item)
+{
+    const std::string &id = getSymbol(item);
+    Transform t = getTransform(item);
+
+    m_svg << "<use xlink:href=\"#" << id << "\" ";
+    put("transform=\"matrix(%.10g %.10g %.10g %.10g %.10g %.10g)\" />\n", 
+        t.m[0], t.m[1], t.m[2], t.m[3], t.m[4], t.m[5]);
+
     if (item->m_ltype == LayoutItem::TYPE_CORNER)
     {
-        m_svg << "<circle cx=\"" << ll.real() << "\" cy=\"" << ll.imag() <<  "\" r=\"" << 5.0 << "\" style=\"fill:#000000\" />\n";
+        double x,y,rot;
+        getPlacement(item, x, y, rot);
+        put("<circle cx=\"%.10g\" cy=\"%.10g\" r=\"5\" style=\"fill:#000000\" />\n", x, m_height - y);
     }
 
-    std::complex<double> center = (ll + ur) / 2.0;
     if (item->m_ltype != LayoutItem::TYPE_FILLER)
     {
-        m_svg << "<text text-anchor=\"middle\" x=\"" << center.real() << "\" y=\"" << center.imag() << "\" class=\"small\">" << item->m_cellname << "</text>\n";
-        m_svg << "<text text-anchor=\"middle\" x=\"" << center.real() << "\" y=\"" << center.imag()+20 << "\" class=\"small\">" << item->m_instance << "</text>\n";
+        // the centre of the cell does not depend on the flip
+        double cx = item->m_lefinfo->m_sx / 2.0;
+        double cy = item->m_lefinfo->m_sy / 2.0;
+        double x = t.m[0]*cx + t.m[2]*cy + t.m[4];
+        double y = t.m[1]*cx + t.m[3]*cy + t.m[5];
+        put("<text text-anchor=\"middle\" x=\"%.10g\" y=\"%.10g\" class=\"small\">", x, y);
+        m_svg << item->m_cellname << "</text>\n";
+        put("<text text-anchor=\"middle\" x=\"%.10g\" y=\"%.10g\" class=\"small\">", x, y+20);
+        m_svg << item->m_instance << "</text>\n";
+    }
+}
+
+void SVGWriter::flushRun()
+{
+    if (m_runCount == 0)
+    {
+        return;
+    }
+
+    if (m_runCount == 1)
+    {
+        writeUse(&m_runFirst);
+        m_runCount = 0;
+        return;
     }
+
+    // the run is a rectangle along the x axis of the 
+    // first filler, which may point in either direction.
+    Transform first = getTransform(&m_runFirst);
+    Transform last  = getTransform(&m_runLast);
+    double dx = last.m[4] - first.m[4];
+    double dy = last.m[5] - first.m[5];
+    double offset = first.m[0]*dx + first.m[1]*dy;
+
+    const std::string &id = getPattern(&m_runFirst);
+    put("<rect x=\"%.10g\" width=\"%.10g\" height=\"%.10g\" ", 
+        std::min(offset, 0.0) + 0.0, fabs(offset) + m_runFirst.m_lefinfo->m_sx, 
+        m_runFirst.m_lefinfo->m_sy);
+    put("transform=\"matrix(%.10g %.10g %.10g %.10g %.10g %.10g)\" ",
+        first.m[0], first.m[1], first.m[2], first.m[3], first.m[4], first.m[5]);
+    m_svg << "style=\"fill:url(#" << id << ");stroke:#179AA9;stroke-width:0.25\" />\n";
+
+    m_runCount = 0;
+}
+
+void SVGWriter::writeCell(const LayoutItem *item)
+{
+    if (item == nullptr)
+    {
+        return;
+    }
+
+    if ((m_runCount > 0) && !GDS2Writer::isRunContinuation(&m_runLast, item))
+    {
+        flushRun();
+    }
+
+    if (item->m_ltype == LayoutItem::TYPE_FILLER)
+    {
+        if (m_runCount == 0)
+        {
+            m_runFirst = *item;
+        }
+        m_runLast = *item;
+        m_runCount++;
+        return;
+    }
+
+    writeUse(item);
 }
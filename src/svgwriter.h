@@ -24,27 +24,82 @@
 #include <stdint.h>
 #include <complex>
 #include <string>
+#include <unordered_map>
 
 #include "layout.h"
+#include "outputsink.h"
 
-/** a very minimal SVG writer */
-class SVGWriter
+/** a very minimal SVG writer.
+
+    Every cell master is defined once as an SVG symbol
+    and each placed cell is a <use> element with a
+    transform. Runs of identical filler cells are drawn
+    as a single rectangle filled with a pattern of the
+    filler cell.
+*/
+class SVGWriter : public OutputSink
 {
 public:
     SVGWriter(std::ostream &os, uint32_t width, uint32_t height);
-    virtual ~SVGWriter();
 
-    void writeCell(const LayoutItem *item);
+    void writeCell(const LayoutItem *item) override;
+
+    /** writes the pending fillers and the footer.
+        returns false on an I/O error. */
+    bool close() override;
 
 protected:
+    /** SVG transform matrix (a b c d e f) that maps 
+        cell coordinates to SVG coordinates. */
+    struct Transform
+    {
+        double m[6];
+    };
+
     std::complex<double> toSVGCoordinates(std::complex<double> &p) const;
 
+    /** get the position and rotation of a cell, 
+        as drawn in the SVG file. */
+    void getPlacement(const LayoutItem *item, double &x, double &y, double &rot) const;
+
+    /** get the transform of a cell, including the flip */
+    Transform getTransform(const LayoutItem *item) const;
+
+    /** return the id of the symbol of the cell master,
+        and write the symbol when it is used for the
+        first time. */
+    const std::string& getSymbol(const LayoutItem *item);
+
+    /** return the id of the pattern for runs of 
+        a filler cell, writing it when needed. */
+    const std::string& getPattern(const LayoutItem *item);
+
+    /** write the outline and the orientation marker 
+        of a cell in cell coordinates. */
+    void writeShape(const LayoutItem *item);
+
+    /** write a placed cell as a <use> element */
+    void writeUse(const LayoutItem *item);
+
+    /** write the pending run of filler cells */
+    void flushRun();
+
     void writeHeader();
     void writeFooter();
 
+    /** write a formatted string */
+    void put(const char *format, ...);
+
     std::ostream &m_svg;
     uint32_t m_width;
     uint32_t m_height;
+
+    std::unordered_map<std::string, std::string> m_symbols;     ///< master -> symbol id
+    std::unordered_map<std::string, std::string> m_patterns;    ///< filler master -> pattern id
+
+    LayoutItem  m_runFirst;     ///< first filler of the pending run
+    LayoutItem  m_runLast;      ///< last filler of the pending run
+    size_t      m_runCount;     ///< number of fillers in the pending run
 };
 
-#endif
\ No newline at end of file
+#endif
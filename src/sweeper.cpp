@@ -0,0 +1,258 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <sstream>
+#include <chrono>
+#include "logging.h"
+#include "threadpool.h"
+#include "padringwriter.h"
+#include "textwriter.h"
+#include "sweeper.h"
+
+bool Sweeper::readPoints(std::istream &is)
+{
+    std::string line;
+    uint32_t lineNum = 0;
+    while(std::getline(is, line))
+    {
+        lineNum++;
+
+        // strip comments
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+        {
+            line.erase(hash);
+        }
+
+        std::istringstream ss(line);
+        SweepPoint point;
+        if (!(ss >> point.m_name))
+        {
+            continue;   // empty line
+        }
+
+        if (!(ss >> point.m_width >> point.m_height))
+        {
+            doLog(LOG_ERROR, "Sweep file line %d : expected a name, width and height\n", lineNum);
+            return false;
+        }
+
+        point.m_space = -1.0;
+        if (!(ss >> point.m_space))
+        {
+            point.m_space = -1.0;
+        }
+
+        if ((point.m_width <= 0.0) || (point.m_height <= 0.0))
+        {
+            doLog(LOG_ERROR, "Sweep file line %d : width and height must be positive\n", lineNum);
+            return false;
+        }
+
+        point.m_status = "pending";
+        point.m_fillerCount = 0;
+        for(uint32_t i=0; i<4; i++)
+        {
+            point.m_slack[i] = 0.0;
+        }
+        m_points.push_back(point);
+    }
+
+    return true;
+}
+
+std::string Sweeper::addSuffix(const std::string &filename, const std::string &suffix)
+{
+    size_t dot   = filename.rfind('.');
+    size_t slash = filename.find_last_of("/\\");
+    if ((dot == std::string::npos) || ((slash != std::string::npos) && (dot < slash)))
+    {
+        return filename + "_" + suffix;
+    }
+    return filename.substr(0, dot) + "_" + suffix + filename.substr(dot);
+}
+
+void Sweeper::evaluate(SweepPoint &point)
+{
+    // each point gets its own copy of the layout
+    PadringDB padring(m_padring);
+    padring.onArea(point.m_width, point.m_height);
+    if (point.m_space >= 0.0)
+    {
+        padring.setFixedSpaceSize(point.m_space);
+    }
+
+    Layout *edges[4] = {&padring.m_north, &padring.m_south, &padring.m_east, &padring.m_west};
+
+    bool fits = true;
+    for(uint32_t i=0; i<4; i++)
+    {
+        point.m_slack[i] = edges[i]->getDieSize() - edges[i]->getMinSize();
+        if (point.m_slack[i] < -1e-9)
+        {
+            fits = false;
+        }
+    }
+
+    if (!fits)
+    {
+        point.m_status = "too_small";
+        return;
+    }
+
+    point.m_fillerCount = 0;
+    for(auto edge : edges)
+    {
+        if (!edge->doLayout())
+        {
+            point.m_status = "layout_error";
+            return;
+        }
+        for(auto item : *edge)
+        {
+            if ((item->m_ltype == LayoutItem::TYPE_FIXEDSPACE) || (item->m_ltype == LayoutItem::TYPE_FLEXSPACE))
+            {
+                int32_t count = m_fillers.getFillerCount(item->m_size);
+                if (count < 0)
+                {
+                    point.m_status = "unfillable";
+                    return;
+                }
+                point.m_fillerCount += count;
+            }
+        }
+    }
+
+    point.m_status = "ok";
+
+    if (m_gds2Filename.empty() && m_svgFilename.empty() && m_defFilename.empty())
+    {
+        return;
+    }
+
+    PadringWriter writer(padring, m_fillers);
+    writer.setDatabaseUnits(m_databaseUnits);
+    if (!m_gds2Filename.empty())
+    {
+        writer.setGDS2Filename(addSuffix(m_gds2Filename, point.m_name));
+    }
+    if (!m_svgFilename.empty())
+    {
+        writer.setSVGFilename(addSuffix(m_svgFilename, point.m_name));
+    }
+    if (!m_defFilename.empty())
+    {
+        writer.setDEFFilename(addSuffix(m_defFilename, point.m_name));
+    }
+
+    if (!writer.write())
+    {
+        point.m_status = "write_error";
+    }
+}
+
+void Sweeper::run(uint32_t threads)
+{
+    // the filler cells are sorted on first use,
+    // make sure this happens before the threads
+    // start sharing the filler handler.
+    m_fillers.getSmallestWidth();
+
+    auto start = std::chrono::steady_clock::now();
+
+    size_t threadCount;
+    {
+        ThreadPool pool(threads);
+        threadCount = pool.getThreadCount();
+        for(auto &point : m_points)
+        {
+            pool.submit([this, &point]() { evaluate(point); });
+        }
+        pool.wait();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    doLog(LOG_INFO, "Evaluated %d sweep points in %f seconds using %d threads\n",
+        m_points.size(), elapsed.count(), threadCount);
+}
+
+size_t Sweeper::getFailedCount() const
+{
+    size_t failed = 0;
+    for(auto const &point : m_points)
+    {
+        if (point.m_status != "ok")
+        {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+void Sweeper::writeCSV(std::ostream &os) const
+{
+    os << "name,width,height,space,status,slack_north,slack_south,slack_east,slack_west,fillers\n";
+    for(auto const &point : m_points)
+    {
+        os << TextWriter::toCSVField(point.m_name) << "," << point.m_width << "," << point.m_height << ",";
+        if (point.m_space >= 0.0)
+        {
+            os << point.m_space;
+        }
+        os << "," << point.m_status;
+        for(uint32_t i=0; i<4; i++)
+        {
+            os << "," << point.m_slack[i];
+        }
+        os << "," << point.m_fillerCount << "\n";
+    }
+}
+
+void Sweeper::writeJSON(std::ostream &os) const
+{
+    const char *edgeNames[4] = {"north", "south", "east", "west"};
+
+    os << "[\n";
+    for(size_t idx=0; idx<m_points.size(); idx++)
+    {
+        auto const &point = m_points[idx];
+
+        os << "  {\"name\": " << TextWriter::toJSONString(point.m_name) << ", ";
+        os << "\"width\": " << point.m_width << ", ";
+        os << "\"height\": " << point.m_height << ", ";
+        os << "\"space\": ";
+        if (point.m_space >= 0.0)
+        {
+            os << point.m_space;
+        }
+        else
+        {
+            os << "null";
+        }
+        os << ", \"status\": \"" << point.m_status << "\", \"slack\": {";
+        for(uint32_t i=0; i<4; i++)
+        {
+            os << "\"" << edgeNames[i] << "\": " << point.m_slack[i];
+            os << ((i < 3) ? ", " : "}, ");
+        }
+        os << "\"fillers\": " << point.m_fillerCount << "}";
+        os << ((idx+1 < m_points.size()) ? ",\n" : "\n");
+    }
+    os << "]\n";
+}
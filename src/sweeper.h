@@ -0,0 +1,110 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef sweeper_h
+#define sweeper_h
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "padringdb.h"
+#include "fillerhandler.h"
+
+/** Evaluates a padring for a list of die sizes and
+    fixed space settings. The LEF and configuration
+    files are parsed only once; each point is laid out
+    on its own copy of the padring database, in parallel.
+
+    Sweep file format, one point per line:
+
+    # name  width  height  [space]
+    small   1000   1000
+    wide    1200   1000    20
+
+    When space is given, all the SPACE statements in
+    the configuration are replaced by that value.
+*/
+class Sweeper
+{
+public:
+    Sweeper(PadringDB &padring, FillerHandler &fillers)
+        : m_padring(padring), m_fillers(fillers), m_databaseUnits(0.0) {}
+
+    /** read the sweep points. returns false on a syntax error. */
+    bool readPoints(std::istream &is);
+
+    /** evaluate all the points using the given number of
+        threads. 0 means one thread per hardware thread. */
+    void run(uint32_t threads);
+
+    /** write the results as a comma separated table */
+    void writeCSV(std::ostream &os) const;
+
+    /** write the results as a JSON array */
+    void writeJSON(std::ostream &os) const;
+
+    /** when set, each point writes its own GDS2, SVG and/or DEF
+        file. the name of the point is appended to the filename.
+    */
+    void setOutputFilenames(const std::string &gds2, const std::string &svg, const std::string &def)
+    {
+        m_gds2Filename = gds2;
+        m_svgFilename  = svg;
+        m_defFilename  = def;
+    }
+
+    void setDatabaseUnits(double databaseUnits)
+    {
+        m_databaseUnits = databaseUnits;
+    }
+
+    /** return the number of points that could not be laid out */
+    size_t getFailedCount() const;
+
+protected:
+    struct SweepPoint
+    {
+        std::string m_name;
+        double      m_width;
+        double      m_height;
+        double      m_space;        ///< fixed space size, -1 to use the configuration.
+
+        std::string m_status;       ///< ok, too_small, layout_error, unfillable or write_error.
+        double      m_slack[4];     ///< slack of the north, south, east and west edges.
+        int64_t     m_fillerCount;  ///< number of filler cells needed.
+    };
+
+    void evaluate(SweepPoint &point);
+
+    /** insert _suffix before the file extension */
+    static std::string addSuffix(const std::string &filename, const std::string &suffix);
+
+    PadringDB       &m_padring;
+    FillerHandler   &m_fillers;
+
+    std::vector<SweepPoint> m_points;
+
+    std::string m_gds2Filename;
+    std::string m_svgFilename;
+    std::string m_defFilename;
+    double      m_databaseUnits;
+};
+
+#endif
@@ -0,0 +1,139 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <stdio.h>
+#include <charconv>
+#include "textwriter.h"
+
+TextWriter::TextWriter(std::ostream *os, size_t bufferSize)
+    : m_os(os),
+      m_buffer(bufferSize),
+      m_bufferPos(0)
+{
+}
+
+void TextWriter::flush()
+{
+    if (m_bufferPos > 0)
+    {
+        m_os->write(&m_buffer[0], m_bufferPos);
+        m_bufferPos = 0;
+    }
+}
+
+void TextWriter::put(const char *str, size_t bytes)
+{
+    if ((m_bufferPos + bytes) > m_buffer.size())
+    {
+        flush();
+        if (bytes > m_buffer.size())
+        {
+            m_os->write(str, bytes);
+            return;
+        }
+    }
+    memcpy(&m_buffer[m_bufferPos], str, bytes);
+    m_bufferPos += bytes;
+}
+
+void TextWriter::putInt(int64_t v)
+{
+    const size_t maxDigits = 24;
+    if ((m_bufferPos + maxDigits) > m_buffer.size())
+    {
+        flush();
+    }
+    char *first = &m_buffer[m_bufferPos];
+    auto result = std::to_chars(first, first + maxDigits, v);
+    m_bufferPos += result.ptr - first;
+}
+
+void TextWriter::putJSONString(const std::string &str)
+{
+    // most names need no escaping
+    for(char c : str)
+    {
+        if ((c == '"') || (c == '\\') || (static_cast<unsigned char>(c) < 0x20))
+        {
+            put(toJSONString(str));
+            return;
+        }
+    }
+    put("\"");
+    put(str);
+    put("\"");
+}
+
+void TextWriter::putCSVField(const std::string &str)
+{
+    if (str.find_first_of(",\"\n") == std::string::npos)
+    {
+        put(str);
+        return;
+    }
+    put(toCSVField(str));
+}
+
+std::string TextWriter::toJSONString(const std::string &str, bool script)
+{
+    std::string result = "\"";
+    for(char c : str)
+    {
+        if ((c == '"') || (c == '\\'))
+        {
+            result += '\\';
+            result += c;
+        }
+        else if ((static_cast<unsigned char>(c) < 0x20) || (script && (c == '<')))
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            result += escaped;
+        }
+        else
+        {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+bool TextWriter::isJSONFilename(const std::string &filename)
+{
+    return (filename.size() > 5) && (filename.compare(filename.size() - 5, 5, ".json") == 0);
+}
+
+std::string TextWriter::toCSVField(const std::string &str)
+{
+    if (str.find_first_of(",\"\n") == std::string::npos)
+    {
+        return str;
+    }
+
+    std::string result = "\"";
+    for(char c : str)
+    {
+        if (c == '"')
+        {
+            result += '"';
+        }
+        result += c;
+    }
+    return result + "\"";
+}
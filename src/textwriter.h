@@ -0,0 +1,89 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef textwriter_h
+#define textwriter_h
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <ostream>
+
+/** Writes text through a block buffer. 
+
+    The text is assembled in a buffer that is written
+    to the output stream when it is full, and integers
+    are formatted by std::to_chars. The JSON and CSV 
+    escaping used by all the text outputs lives here.
+*/
+class TextWriter
+{
+public:
+    TextWriter(std::ostream *os = nullptr, size_t bufferSize = 64*1024);
+
+    /** set the output stream. the buffer must 
+        have been flushed. */
+    void setStream(std::ostream *os)
+    {
+        m_os = os;
+    }
+
+    void put(const char *str, size_t bytes);
+
+    void put(const std::string &str)
+    {
+        put(str.c_str(), str.size());
+    }
+
+    void put(const char *str)
+    {
+        put(str, strlen(str));
+    }
+
+    void putInt(int64_t v);
+
+    /** write a string as a JSON string literal */
+    void putJSONString(const std::string &str);
+
+    /** write a string as a CSV field, quoted when needed */
+    void putCSVField(const std::string &str);
+
+    /** write the buffer to the output stream */
+    void flush();
+
+    /** return a string as a JSON string literal. when 
+        script is set, '<' is escaped too, so the literal 
+        can be embedded in an HTML script element. */
+    static std::string toJSONString(const std::string &str, bool script = false);
+
+    /** return a string as a CSV field, quoted when it
+        contains a comma, a quote or a newline. */
+    static std::string toCSVField(const std::string &str);
+
+    /** check if a filename has a .json extension */
+    static bool isJSONFilename(const std::string &filename);
+
+protected:
+    std::ostream        *m_os;
+    std::vector<char>   m_buffer;
+    size_t              m_bufferPos;
+};
+
+#endif
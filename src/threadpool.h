@@ -0,0 +1,134 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef threadpool_h
+#define threadpool_h
+
+#include <stdint.h>
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/** A minimal thread pool that executes submitted
+    jobs on a fixed number of worker threads.
+*/
+class ThreadPool
+{
+public:
+    /** create a pool with the given number of threads.
+        when threads is 0, the number of hardware threads
+        is used.
+    */
+    ThreadPool(uint32_t threads = 0) : m_busy(0), m_stop(false)
+    {
+        if (threads == 0)
+        {
+            threads = std::thread::hardware_concurrency();
+        }
+
+        if (threads == 0)
+        {
+            threads = 1;
+        }
+
+        for(uint32_t i=0; i<threads; i++)
+        {
+            m_workers.emplace_back([this]() { workerLoop(); });
+        }
+    }
+
+    /** waits for all the jobs to finish and stops the threads */
+    virtual ~ThreadPool()
+    {
+        wait();
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_jobAvailable.notify_all();
+        for(auto &worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    /** submit a job for execution */
+    void submit(std::function<void()> job)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_jobs.push(std::move(job));
+        }
+        m_jobAvailable.notify_one();
+    }
+
+    /** wait until all submitted jobs have finished */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_jobsDone.wait(lock, [this]() { return m_jobs.empty() && (m_busy == 0); });
+    }
+
+    /** return the number of worker threads */
+    size_t getThreadCount() const
+    {
+        return m_workers.size();
+    }
+
+protected:
+    void workerLoop()
+    {
+        while(true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobAvailable.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+                if (m_jobs.empty())
+                {
+                    return; // stopped
+                }
+                job = std::move(m_jobs.front());
+                m_jobs.pop();
+                m_busy++;
+            }
+
+            job();
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_busy--;
+            }
+            m_jobsDone.notify_all();
+        }
+    }
+
+    std::vector<std::thread>            m_workers;
+    std::queue<std::function<void()> >  m_jobs;
+    std::mutex                          m_mutex;
+    std::condition_variable             m_jobAvailable;
+    std::condition_variable             m_jobsDone;
+    uint32_t                            m_busy;     ///< number of jobs being executed
+    bool                                m_stop;
+};
+
+#endif
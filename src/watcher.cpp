@@ -0,0 +1,308 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#include <fstream>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <ctime>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include "logging.h"
+#include "fillerhandler.h"
+#include "padringwriter.h"
+#include "watcher.h"
+
+/** time to wait for more changes after a change, in ms.
+    editors often write a file in several steps. */
+static const int c_settleTime = 50;
+
+static volatile sig_atomic_t gs_stop = 0;
+
+static void onStopSignal(int)
+{
+    gs_stop = 1;
+}
+
+Watcher::~Watcher()
+{
+    if (m_inotify >= 0)
+    {
+        close(m_inotify);
+    }
+}
+
+std::unique_ptr<PRLEFReader> Watcher::loadLEF()
+{
+    // a later LEF file can replace the cells of an
+    // earlier one, so all the files are read again.
+    std::unique_ptr<PRLEFReader> lefreader(new PRLEFReader());
+    for(auto const &leffile : m_lefFiles)
+    {
+        std::ifstream lefstream(leffile, std::ifstream::in);
+        if (!lefstream.is_open())
+        {
+            doLog(LOG_ERROR, "Cannot open LEF file %s\n", leffile.c_str());
+            return nullptr;
+        }
+        doLog(LOG_INFO, "Reading LEF %s\n", leffile.c_str());
+        lefreader->parse(lefstream);
+    }
+    doLog(LOG_INFO,"%d cells read\n", lefreader->m_cells.size());
+    return lefreader;
+}
+
+bool Watcher::update()
+{
+    // the LEF files stay dirty until an update
+    // with the new database succeeds.
+    std::unique_ptr<PRLEFReader> newReader;
+    if (m_lefDirty || !m_lefreader)
+    {
+        newReader = loadLEF();
+        if (!newReader)
+        {
+            return false;
+        }
+    }
+    const PRLEFReader &lefreader = newReader ? *newReader : *m_lefreader;
+
+    std::unique_ptr<PadringDB> padring(new PadringDB(lefreader));
+    std::ifstream configStream(m_configFile, std::ifstream::in);
+    if (!configStream.is_open())
+    {
+        doLog(LOG_ERROR, "Cannot open configuration file %s\n", m_configFile.c_str());
+        return false;
+    }
+
+    if (!padring->parse(configStream))
+    {
+        doLog(LOG_ERROR, "Cannot parse configuration file %s\n", m_configFile.c_str());
+        return false;
+    }
+
+    FillerHandler fillers;
+    if (!m_job.addFillers(lefreader, *padring, fillers) || (m_job.fitDie(*padring, fillers) != "ok"))
+    {
+        return false;
+    }
+
+    // edges and outputs can only be reused
+    // when the cells are the same.
+    bool reuse = !newReader && m_padring && (padring->m_fillerPrefix == m_fillerPrefix);
+    if (!reuse)
+    {
+        m_cache.clear();
+    }
+
+    // an edge with the same items as before gets the
+    // layout of the previous run instead of a new one.
+    Layout *edges[4] = {&padring->m_north, &padring->m_south, &padring->m_west, &padring->m_east};
+    uint32_t laidOut = 0;
+    for(uint32_t i=0; i<4; i++)
+    {
+        std::string signature = edges[i]->getSignature();
+        if (reuse && (signature == m_signatures[i]))
+        {
+            Layout *previous[4] = {&m_padring->m_north, &m_padring->m_south, &m_padring->m_west, &m_padring->m_east};
+            edges[i]->swap(*previous[i]);
+        }
+        else
+        {
+            edges[i]->doLayout();
+            laidOut++;
+        }
+        m_signatures[i] = signature;
+    }
+
+    // the previous padring gave up its edges,
+    // so the new one replaces it from here on.
+    m_fillerPrefix = padring->m_fillerPrefix;
+    m_padring = std::move(padring);
+    if (newReader)
+    {
+        m_lefreader = std::move(newReader);
+        m_databaseUnits = m_lefreader->m_lefDatabaseUnits;
+        m_lefDirty = false;
+    }
+
+    PadringWriter writer(*m_padring, fillers);
+    m_job.setupWriter(writer, m_databaseUnits);
+    writer.setCache(&m_cache);
+    bool ok = writer.write();
+
+    uint32_t reused, generated;
+    m_cache.getEdgeCounts(reused, generated);
+    doLog(LOG_INFO, "Laid out %d of 4 edges, reused the placements of %d edges\n", laidOut, reused);
+    return ok;
+}
+
+bool Watcher::addWatch(const std::string &filename, bool isLEF)
+{
+    // editors often replace a file instead of writing
+    // it, so the directory is watched.
+    size_t slash = filename.rfind('/');
+    std::string directory = (slash == std::string::npos) ? "." : filename.substr(0, slash+1);
+    std::string name = (slash == std::string::npos) ? filename : filename.substr(slash+1);
+
+    int wd = inotify_add_watch(m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0)
+    {
+        doLog(LOG_ERROR, "Cannot watch directory %s: %s\n", directory.c_str(), strerror(errno));
+        return false;
+    }
+
+    WatchedFile &file = m_watches[wd][name];
+    file.m_path  = filename;
+    file.m_isLEF = file.m_isLEF || isLEF;
+    return true;
+}
+
+bool Watcher::waitForChanges(bool &lefChanged)
+{
+    lefChanged = false;
+    m_changed.clear();
+
+    alignas(inotify_event) char buffer[16384];
+    int timeout = -1;
+    while(!gs_stop)
+    {
+        pollfd pfd;
+        pfd.fd = m_inotify;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ready = poll(&pfd, 1, timeout);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            doLog(LOG_ERROR, "Cannot wait for file changes: %s\n", strerror(errno));
+            return false;
+        }
+
+        if (ready == 0)
+        {
+            return true;    // no more changes
+        }
+
+        ssize_t bytes = read(m_inotify, buffer, sizeof(buffer));
+        for(ssize_t pos = 0; pos < bytes; )
+        {
+            const inotify_event *event = reinterpret_cast<const inotify_event*>(buffer + pos);
+            pos += sizeof(inotify_event) + event->len;
+            if (event->len == 0)
+            {
+                continue;
+            }
+
+            auto watch = m_watches.find(event->wd);
+            if (watch == m_watches.end())
+            {
+                continue;
+            }
+
+            auto file = watch->second.find(event->name);
+            if (file != watch->second.end())
+            {
+                lefChanged = lefChanged || file->second.m_isLEF;
+                m_changed.push_back(file->second.m_path);
+                timeout = c_settleTime;
+            }
+        }
+    }
+    return false;
+}
+
+bool Watcher::run()
+{
+    m_inotify = inotify_init1(IN_CLOEXEC);
+    if (m_inotify < 0)
+    {
+        doLog(LOG_ERROR, "Cannot use inotify: %s\n", strerror(errno));
+        return false;
+    }
+
+    for(auto const &leffile : m_lefFiles)
+    {
+        if (!addWatch(leffile, true))
+        {
+            return false;
+        }
+    }
+    if (!addWatch(m_configFile, false))
+    {
+        return false;
+    }
+
+    // stop between updates on Ctrl-C
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = onStopSignal;
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    if (!update())
+    {
+        doLog(LOG_ERROR, "Cannot write the outputs, waiting for a change\n");
+    }
+
+    doLog(LOG_INFO, "Watching %s and %d LEF files for changes\n", m_configFile.c_str(), m_lefFiles.size());
+
+    bool lefChanged;
+    while(waitForChanges(lefChanged))
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        // the latency is measured from the last 
+        // modification of the changed files.
+        timespec saved = {0, 0};
+        for(auto const &filename : m_changed)
+        {
+            struct stat info;
+            if ((stat(filename.c_str(), &info) == 0) && 
+                ((info.st_mtim.tv_sec > saved.tv_sec) || 
+                 ((info.st_mtim.tv_sec == saved.tv_sec) && (info.st_mtim.tv_nsec > saved.tv_nsec))))
+            {
+                saved = info.st_mtim;
+            }
+        }
+
+        m_lefDirty = m_lefDirty || lefChanged;
+        if (!update())
+        {
+            doLog(LOG_ERROR, "Cannot update the outputs, waiting for the next change\n");
+            continue;
+        }
+
+        timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        double latency = (now.tv_sec - saved.tv_sec)*1000.0 + (now.tv_nsec - saved.tv_nsec)*1.0e-6;
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        doLog(LOG_INFO, "Outputs updated %f ms after the save (%f ms to update)\n", latency, elapsed.count()*1000.0);
+    }
+
+    doLog(LOG_INFO, "Stopped watching\n");
+    return true;
+}
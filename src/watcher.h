@@ -0,0 +1,104 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+#ifndef watcher_h
+#define watcher_h
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+
+#include "prlefreader.h"
+#include "padringdb.h"
+#include "padringjob.h"
+#include "placementcache.h"
+
+/** Watches the configuration and LEF files with inotify
+    and writes the outputs again after every change.
+
+    Only what changed is read again: the LEF files are
+    kept when only the configuration changed. An edge is
+    laid out again only when its items differ from the
+    previous run, and the output writers reuse the blocks
+    and GDS2 encoding of edges that did not change (see
+    PlacementCache).
+
+    The latency from the save to the updated outputs is
+    logged after every update.
+*/
+class Watcher
+{
+public:
+    Watcher(const std::vector<std::string> &lefFiles, const std::string &configFile, const PadringJob &job)
+        : m_lefFiles(lefFiles), m_configFile(configFile), m_job(job),
+          m_lefDirty(true), m_databaseUnits(0.0), m_inotify(-1) {}
+
+    virtual ~Watcher();
+
+    /** write the outputs, then update them after every change
+        until SIGINT or SIGTERM. returns false if the files 
+        cannot be watched.
+    */
+    bool run();
+
+protected:
+    /** read all the LEF files into a new database */
+    std::unique_ptr<PRLEFReader> loadLEF();
+
+    /** read the changed files, lay out the changed edges
+        and write the outputs. returns false on an error; 
+        the previous state is then kept.
+    */
+    bool update();
+
+    /** add an inotify watch for the directory of a file */
+    bool addWatch(const std::string &filename, bool isLEF);
+
+    /** wait for changes of the watched files and collect
+        the changes that follow shortly after. returns false
+        when the watcher is stopped. 
+    */
+    bool waitForChanges(bool &lefChanged);
+
+    std::vector<std::string>        m_lefFiles;
+    std::string                     m_configFile;
+    PadringJob                      m_job;
+
+    std::unique_ptr<PRLEFReader>    m_lefreader;
+    bool                            m_lefDirty;     ///< the LEF files changed since m_lefreader was read
+    double                          m_databaseUnits;
+    std::unique_ptr<PadringDB>      m_padring;      ///< the padring of the last update
+    std::string                     m_signatures[4];///< edge signatures before layout: N, S, W, E.
+    std::string                     m_fillerPrefix; ///< filler prefix of the last update
+    PlacementCache                  m_cache;
+
+    struct WatchedFile
+    {
+        std::string m_path;
+        bool        m_isLEF;
+    };
+
+    int                             m_inotify;
+    /** watched files of each directory watch, by name */
+    std::map<int, std::map<std::string, WatchedFile> > m_watches;
+    std::vector<std::string>        m_changed;      ///< files changed since the last update
+};
+
+#endif
@@ -0,0 +1,234 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+/*
+    Checks that GDS2Library copies the structures of the
+    placed cells, and their children, verbatim into the
+    padring GDS2 file.
+*/
+
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "../src/gds2/gds2writer.h"
+#include "../src/gds2/gds2library.h"
+#include "../src/gds2/gds2mappedwriter.h"
+#include "../src/gds2/gds2hierwriter.h"
+
+static std::vector<uint8_t> readFile(const std::string &filename)
+{
+    std::ifstream is(filename, std::ios::binary);
+    return std::vector<uint8_t>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string &filename, const std::vector<uint8_t> &data)
+{
+    std::ofstream os(filename, std::ios::binary);
+    os.write(reinterpret_cast<const char*>(&data[0]), data.size());
+}
+
+static void putRecord(std::vector<uint8_t> &data, uint16_t recordType, const std::vector<uint16_t> &words)
+{
+    uint16_t bytes = 4 + 2*words.size();
+    data.push_back(bytes >> 8);
+    data.push_back(bytes & 0xFF);
+    data.push_back(recordType >> 8);
+    data.push_back(recordType & 0xFF);
+    for(auto w : words)
+    {
+        data.push_back(w >> 8);
+        data.push_back(w & 0xFF);
+    }
+}
+
+/** encode a structure with a box on the given layer
+    and references to the given children */
+static std::vector<uint8_t> makeStructure(const std::string &name, 
+    uint16_t layer, const std::vector<std::string> &children)
+{
+    std::vector<uint8_t> data(GDS2Writer::getBeginStructureSize(name));
+    GDS2Writer::encodeBeginStructure(&data[0], name);
+
+    putRecord(data, 0x0800, {});                // BOUNDARY
+    putRecord(data, 0x0D02, {layer});           // LAYER
+    putRecord(data, 0x0E02, {0});               // DATATYPE
+    putRecord(data, 0x1003, {0,0, 0,0, 0,1000, 0,1000, 0,1000, 0,0, 0,0, 0,0, 0,0, 0,0});
+    putRecord(data, 0x1100, {});                // ENDEL
+
+    for(auto const &child : children)
+    {
+        size_t pos = data.size();
+        data.resize(pos + GDS2Writer::getSREFSize(child, 0));
+        GDS2Writer::encodeSREF(&data[pos], child, 0, false, 0u, 0u);
+    }
+
+    size_t pos = data.size();
+    data.resize(pos + 4);
+    GDS2Writer::encodeEndStructure(&data[pos]);
+    return data;
+}
+
+/** get the names of the structures in a GDS2 file, in file order */
+static std::vector<std::string> getStructureNames(const std::vector<uint8_t> &data)
+{
+    std::vector<std::string> names;
+    size_t pos = 0;
+    while(pos + 4 <= data.size())
+    {
+        size_t bytes = (data[pos] << 8) | data[pos+1];
+        if (bytes < 4)
+        {
+            break;
+        }
+        if ((data[pos+2] == 0x06) && (data[pos+3] == 0x06))
+        {
+            std::string name(data.begin() + pos + 4, data.begin() + pos + bytes);
+            names.push_back(name.substr(0, name.find('\0')));
+        }
+        pos += bytes;
+    }
+    return names;
+}
+
+static bool contains(const std::vector<uint8_t> &data, const std::vector<uint8_t> &part)
+{
+    return std::search(data.begin(), data.end(), part.begin(), part.end()) != data.end();
+}
+
+static size_t indexOf(const std::vector<std::string> &names, const std::string &name)
+{
+    return std::find(names.begin(), names.end(), name) - names.begin();
+}
+
+int main()
+{
+    uint32_t failed = 0;
+
+    // a library where PAD uses VIA, which uses CONTACT,
+    // and UNUSED is never placed.
+    std::vector<uint8_t> contact = makeStructure("CONTACT", 3, {});
+    std::vector<uint8_t> via     = makeStructure("VIA", 2, {"CONTACT"});
+    std::vector<uint8_t> pad     = makeStructure("PAD", 1, {"VIA", "VIA"});
+    std::vector<uint8_t> filler  = makeStructure("FILLER", 4, {});
+    std::vector<uint8_t> unused  = makeStructure("UNUSED", 5, {"CONTACT"});
+
+    std::vector<uint8_t> lib(GDS2Writer::c_libHeaderSize);
+    GDS2Writer::encodeLibHeader(&lib[0]);
+    for(auto const *s : {&unused, &pad, &filler, &via, &contact})
+    {
+        lib.insert(lib.end(), s->begin(), s->end());
+    }
+    putRecord(lib, 0x0400, {});                 // ENDLIB
+    writeFile("gds2library_lib.gds", lib);
+
+    // a truncated library is rejected
+    std::vector<uint8_t> truncated(lib.begin(), lib.begin() + lib.size() - 10);
+    writeFile("gds2library_bad.gds", truncated);
+    {
+        GDS2Library bad;
+        if (bad.addFile("gds2library_bad.gds") || bad.addFile("gds2library_missing.gds"))
+        {
+            printf("Invalid libraries were accepted\n");
+            failed++;
+        }
+    }
+
+    GDS2Library library;
+    if (!library.addFile("gds2library_lib.gds") || (library.getStructureCount() != 5))
+    {
+        printf("Cannot index the library\n");
+        return 1;
+    }
+
+    PRLEFReader::LEFCellInfo_t padInfo;
+    padInfo.m_sx = 60.0;
+    padInfo.m_sy = 240.0;
+
+    auto block = std::make_shared<PlacementBlock>();
+    const char *cellnames[] = {"PAD", "FILLER", "FILLER", "MISSING", "PAD"};
+    for(uint32_t i=0; i<5; i++)
+    {
+        LayoutItem item(LayoutItem::TYPE_CELL);
+        item.m_lefinfo  = &padInfo;
+        item.m_cellname = cellnames[i];
+        item.m_location = "S";
+        item.m_x = 240.0 + i*60.0;
+        item.m_y = 0.0;
+        item.m_size = 60.0;
+        block->push_back(item);
+    }
+
+    for(uint32_t hier=0; hier<2; hier++)
+    {
+        if (hier == 0)
+        {
+            GDS2MappedWriter *writer = GDS2MappedWriter::open("gds2library_out.gds", "design", 2);
+            writer->setLibrary(&library);
+            writer->writeBlock(block);
+            writer->close();
+            delete writer;
+        }
+        else
+        {
+            GDS2HierWriter *writer = GDS2HierWriter::open("gds2library_out.gds", "design", 1000.0, 1000.0);
+            writer->setLibrary(&library);
+            writer->writeBlock(block);
+            writer->close();
+            delete writer;
+        }
+
+        auto data = readFile("gds2library_out.gds");
+        auto names = getStructureNames(data);
+
+        // only the placed cells and their children are copied,
+        // children first and each of them once.
+        std::vector<std::string> copied(names.begin(), names.begin() + std::min<size_t>(4, names.size()));
+        std::sort(copied.begin(), copied.end());
+        if ((names.size() < 5) || (copied != std::vector<std::string>{"CONTACT", "FILLER", "PAD", "VIA"}) ||
+            (indexOf(names, "CONTACT") > indexOf(names, "VIA")) || 
+            (indexOf(names, "VIA") > indexOf(names, "PAD")) ||
+            (indexOf(names, "UNUSED") != names.size()) ||
+            (names.back() != "design"))
+        {
+            printf("Writer %d: unexpected structures\n", hier);
+            failed++;
+        }
+
+        for(auto const *s : {&contact, &via, &pad, &filler})
+        {
+            if (!contains(data, *s))
+            {
+                printf("Writer %d: a structure was not copied verbatim\n", hier);
+                failed++;
+            }
+        }
+    }
+
+    remove("gds2library_lib.gds");
+    remove("gds2library_bad.gds");
+    remove("gds2library_out.gds");
+
+    printf("Failed checks: %d\n", failed);
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+/*
+    Reads back GDS2 files written by the flat and the
+    hierarchical writers with GDS2Reader, and checks them
+    with GDS2Verifier against the placement records.
+*/
+
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/gds2/gds2writer.h"
+#include "../src/gds2/gds2mappedwriter.h"
+#include "../src/gds2/gds2hierwriter.h"
+#include "../src/gds2/gds2reader.h"
+#include "../src/gds2/gds2verifier.h"
+
+static std::vector<char> readFile(const std::string &filename)
+{
+    std::ifstream is(filename, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+static void writeFile(const std::string &filename, const std::vector<char> &data)
+{
+    std::ofstream os(filename, std::ios::binary);
+    os.write(&data[0], data.size());
+}
+
+int main()
+{
+    std::mt19937 rng(0x5EED);
+
+    const char *locations[] = {"N","S","E","W","NE","NW","SE","SW"};
+    const char *cellnames[] = {"PAD", "IOPAD_IN", "FILLER5", "CORNER_CELL"};
+
+    PRLEFReader::LEFCellInfo_t pad;
+    pad.m_sx = 60.0;
+    pad.m_sy = 240.0;
+
+    uint32_t failed = 0;
+
+    // real decoding
+    const uint8_t angle90[8]  = {0x42, 0x5A, 0, 0, 0, 0, 0, 0};
+    const uint8_t minusHalf[8] = {0xC0, 0x80, 0, 0, 0, 0, 0, 0};
+    if ((GDS2Reader::decodeReal(angle90) != 90.0) || (GDS2Reader::decodeReal(minusHalf) != -0.5))
+    {
+        printf("GDS2 reals are not decoded correctly\n");
+        failed++;
+    }
+
+    for(uint32_t run=0; run<12; run++)
+    {
+        std::vector<std::shared_ptr<const PlacementBlock> > blocks;
+        uint32_t blockCount = 1 + rng() % 10;
+        for(uint32_t b=0; b<blockCount; b++)
+        {
+            auto block = std::make_shared<PlacementBlock>();
+            uint32_t items = 1 + rng() % 500;
+            for(uint32_t i=0; i<items; i++)
+            {
+                if ((i > 0) && ((rng() % 2) == 0))
+                {
+                    // continue a run of fillers
+                    LayoutItem item = block->back();
+                    item.m_ltype = LayoutItem::TYPE_FILLER;
+                    if ((item.m_location == "N") || (item.m_location == "S"))
+                    {
+                        item.m_x += item.m_size;
+                    }
+                    else
+                    {
+                        item.m_y += item.m_size;
+                    }
+                    block->push_back(item);
+                    continue;
+                }
+
+                LayoutItem item(LayoutItem::TYPE_CELL);
+                item.m_lefinfo  = &pad;
+                item.m_cellname = cellnames[rng() % 4];
+                item.m_location = locations[rng() % 8];
+                item.m_flipped  = (rng() % 2) == 1;
+                item.m_x = (rng() % 100000) / 10.0;
+                item.m_y = (rng() % 100000) / 10.0;
+                item.m_size = 1.0 + (rng() % 10);
+                block->push_back(item);
+            }
+            blocks.push_back(block);
+        }
+
+        // flat with and without arrays, and hierarchical
+        std::string design = "design" + std::to_string(run);
+        std::unique_ptr<OutputSink> writer;
+        if ((run % 3) == 2)
+        {
+            writer.reset(GDS2HierWriter::open("gds2reader.gds", design, 10000.0, 10000.0));
+        }
+        else
+        {
+            GDS2MappedWriter *mapped = GDS2MappedWriter::open("gds2reader.gds", design, 2);
+            mapped->setUseAREF((run % 3) == 1);
+            writer.reset(mapped);
+        }
+
+        GDS2Verifier verifier;
+        for(auto const &block : blocks)
+        {
+            writer->writeBlock(block);
+            verifier.writeBlock(block);
+        }
+        if (!writer->close())
+        {
+            printf("Run %d: cannot write the GDS2 file\n", run);
+            failed++;
+        }
+        writer.reset();
+
+        if (!verifier.verify("gds2reader.gds", design))
+        {
+            printf("Run %d: verification failed\n", run);
+            failed++;
+        }
+
+        // a damaged placement is detected: change the last
+        // byte of the first XY record.
+        auto data = readFile("gds2reader.gds");
+        size_t pos = 0;
+        while((pos + 4) <= data.size())
+        {
+            size_t bytes = (static_cast<uint8_t>(data[pos]) << 8) | static_cast<uint8_t>(data[pos+1]);
+            if ((data[pos+2] == 0x10) && (data[pos+3] == 0x03))
+            {
+                data[pos+bytes-1] ^= 0x01;
+                break;
+            }
+            pos += bytes;
+        }
+        writeFile("gds2reader.gds", data);
+
+        GDS2Verifier damaged;
+        for(auto const &block : blocks)
+        {
+            damaged.writeBlock(block);
+        }
+        if (damaged.verify("gds2reader.gds", design))
+        {
+            printf("Run %d: damaged file was not detected\n", run);
+            failed++;
+        }
+    }
+
+    remove("gds2reader.gds");
+
+    printf("Failed checks: %d\n", failed);
+    return (failed == 0) ? 0 : 1;
+}
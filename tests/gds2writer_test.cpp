@@ -0,0 +1,195 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+/*
+    Checks that GDS2MappedWriter writes the same bytes
+    as the serial GDS2Writer, and the same bytes again
+    when it reuses cached block encodings.
+*/
+
+#include <stdio.h>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/gds2/gds2writer.h"
+#include "../src/gds2/gds2mappedwriter.h"
+#include "../src/placementcache.h"
+
+static std::vector<char> readFile(const std::string &filename)
+{
+    std::ifstream is(filename, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+}
+
+int main()
+{
+    std::mt19937 rng(0x5EED);
+
+    const char *locations[] = {"N","S","E","W","NE","NW","SE","SW"};
+    const char *cellnames[] = {"PAD", "IOPAD_IN", "FILLER5", "CORNER_CELL"};
+
+    PRLEFReader::LEFCellInfo_t pad;
+    pad.m_sx = 60.0;
+    pad.m_sy = 240.0;
+
+    uint32_t failed = 0;
+    for(uint32_t run=0; run<10; run++)
+    {
+        std::vector<std::shared_ptr<const PlacementBlock> > blocks;
+        uint32_t blockCount = 1 + rng() % 20;
+        for(uint32_t b=0; b<blockCount; b++)
+        {
+            auto block = std::make_shared<PlacementBlock>();
+            uint32_t items = rng() % 1000;
+            bool fillerRuns = (rng() % 2) == 0;
+            for(uint32_t i=0; i<items; i++)
+            {
+                if (fillerRuns && (i > 0) && ((rng() % 8) != 0))
+                {
+                    // continue a run of fillers
+                    LayoutItem item = block->back();
+                    item.m_ltype = LayoutItem::TYPE_FILLER;
+                    if ((item.m_location == "N") || (item.m_location == "S"))
+                    {
+                        item.m_x += item.m_size;
+                    }
+                    else
+                    {
+                        item.m_y += item.m_size;
+                    }
+                    block->push_back(item);
+                    continue;
+                }
+
+                LayoutItem item(LayoutItem::TYPE_CELL);
+                item.m_lefinfo  = &pad;
+                item.m_cellname = cellnames[rng() % 4];
+                item.m_location = locations[rng() % 8];
+                item.m_flipped  = (rng() % 2) == 1;
+                item.m_x = (rng() % 100000) / 10.0;
+                item.m_y = (rng() % 100000) / 10.0;
+                item.m_size = 1.0 + (rng() % 10);
+                if ((rng() % 2) == 0)
+                {
+                    item.m_ltype = LayoutItem::TYPE_FILLER;
+                }
+                block->push_back(item);
+            }
+            blocks.push_back(block);
+        }
+
+        GDS2Writer *serial = GDS2Writer::open("gds2writer_serial.gds", "design" + std::to_string(run));
+        GDS2MappedWriter *mapped = GDS2MappedWriter::open("gds2writer_mapped.gds", "design" + std::to_string(run), 4);
+        if ((serial == nullptr) || (mapped == nullptr))
+        {
+            printf("Cannot open output files\n");
+            return 1;
+        }
+
+        bool useAREF = (run % 3) != 0;
+        serial->setUseAREF(useAREF);
+        mapped->setUseAREF(useAREF);
+
+        for(auto const &block : blocks)
+        {
+            // mix single cells and blocks
+            if ((rng() % 4) == 0)
+            {
+                for(auto const &item : *block)
+                {
+                    serial->writeCell(&item);
+                    mapped->writeCell(&item);
+                }
+            }
+            else
+            {
+                serial->writeBlock(block);
+                mapped->writeBlock(block);
+            }
+        }
+        if (!serial->close())
+        {
+            printf("Run %d: cannot write the serial GDS2 file\n", run);
+            failed++;
+        }
+        delete serial;
+        if (!mapped->close())
+        {
+            printf("Run %d: cannot write the mapped GDS2 file\n", run);
+            failed++;
+        }
+        delete mapped;
+
+        auto serialData = readFile("gds2writer_serial.gds");
+        auto mappedData = readFile("gds2writer_mapped.gds");
+        if (serialData.empty() || (serialData != mappedData))
+        {
+            printf("Run %d: GDS2 files differ (%d and %d bytes)\n", run, 
+                (int)serialData.size(), (int)mappedData.size());
+            failed++;
+        }
+
+        // the first pass encodes and caches the blocks,
+        // the second pass copies the cached encodings.
+        PlacementCache cache;
+        cache.setEdge("N", "edge", blocks);
+        std::vector<char> cachedData[2];
+        for(uint32_t pass=0; pass<2; pass++)
+        {
+            GDS2MappedWriter *cached = GDS2MappedWriter::open("gds2writer_cached.gds", "design" + std::to_string(run), 4);
+            if (cached == nullptr)
+            {
+                printf("Cannot open output files\n");
+                return 1;
+            }
+            cached->setUseAREF(useAREF);
+            cached->setCache(&cache);
+            for(auto const &block : blocks)
+            {
+                cached->writeBlock(block);
+            }
+            if (!cached->close())
+            {
+                printf("Run %d: cannot write the cached GDS2 file\n", run);
+                failed++;
+            }
+            delete cached;
+            cachedData[pass] = readFile("gds2writer_cached.gds");
+        }
+
+        if (cachedData[0].empty() || (cachedData[0] != cachedData[1]) || 
+            !cache.getGDS2(blocks[0].get(), useAREF))
+        {
+            printf("Run %d: cached GDS2 files differ (%d and %d bytes)\n", run, 
+                (int)cachedData[0].size(), (int)cachedData[1].size());
+            failed++;
+        }
+    }
+
+    remove("gds2writer_serial.gds");
+    remove("gds2writer_mapped.gds");
+    remove("gds2writer_cached.gds");
+
+    printf("Failed checks: %d\n", failed);
+    return (failed == 0) ? 0 : 1;
+}
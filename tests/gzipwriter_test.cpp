@@ -0,0 +1,142 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+/*
+    Checks that GzipWriter and GzipStreamBuf write 
+    gzip streams that zlib decompresses to the input.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "../src/gzipwriter.h"
+
+static bool gunzip(const std::vector<uint8_t> &compressed, std::vector<uint8_t> &out)
+{
+    z_stream strm;
+    memset(&strm, 0, sizeof(strm));
+    if (inflateInit2(&strm, 16 + 15) != Z_OK)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> buffer(65536);
+    strm.next_in  = const_cast<uint8_t*>(compressed.data());
+    strm.avail_in = compressed.size();
+    int result = Z_OK;
+    while(result == Z_OK)
+    {
+        strm.next_out  = buffer.data();
+        strm.avail_out = buffer.size();
+        result = inflate(&strm, Z_NO_FLUSH);
+        out.insert(out.end(), buffer.data(), buffer.data() + (buffer.size() - strm.avail_out));
+    }
+    inflateEnd(&strm);
+
+    // the whole stream must be used
+    return (result == Z_STREAM_END) && (strm.avail_in == 0);
+}
+
+int main()
+{
+    std::mt19937 rng(0x5EED);
+    uint32_t failed = 0;
+
+    const size_t sizes[] = {0, 1, 4095, 4096, 4097, 100000, 1000000};
+    for(auto size : sizes)
+    {
+        for(uint32_t threads=1; threads<=4; threads++)
+        {
+            // compressible data: repeated words and random bytes
+            std::vector<uint8_t> input;
+            while(input.size() < size)
+            {
+                if ((rng() % 4) == 0)
+                {
+                    input.push_back(rng() & 0xFF);
+                }
+                else
+                {
+                    std::string word = "  - FILLER_" + std::to_string(rng() % 1000) + " FILLER10\n";
+                    input.insert(input.end(), word.begin(), word.end());
+                }
+            }
+            input.resize(size);
+
+            std::vector<uint8_t> compressed;
+            GzipWriter writer([&compressed](const uint8_t *data, size_t bytes)
+                {
+                    compressed.insert(compressed.end(), data, data + bytes);
+                    return true;
+                }, threads, 6, 4096);
+
+            // write in pieces of random size
+            size_t pos = 0;
+            while(pos < input.size())
+            {
+                size_t n = std::min<size_t>(input.size() - pos, 1 + rng() % 10000);
+                writer.write(input.data() + pos, n);
+                pos += n;
+            }
+
+            std::vector<uint8_t> output;
+            if (!writer.finish() || !gunzip(compressed, output) || (output != input))
+            {
+                printf("GzipWriter: %zu bytes with %d threads failed\n", size, threads);
+                failed++;
+            }
+        }
+    }
+
+    // the stream buffer for the std::ostream writers
+    std::string text;
+    for(uint32_t i=0; i<50000; i++)
+    {
+        text += "<rect x=\"" + std::to_string(i) + "\" />\n";
+    }
+
+    std::ostringstream compressedStream;
+    {
+        GzipStreamBuf buf(compressedStream, 2);
+        std::ostream os(&buf);
+        for(size_t i=0; i<text.size(); i+=1000)
+        {
+            os << text.substr(i, 1000);
+        }
+        os.write(text.data(), text.size());
+    }
+
+    std::string compressed = compressedStream.str();
+    std::vector<uint8_t> output;
+    std::string expected = text + text;
+    if (!gunzip(std::vector<uint8_t>(compressed.begin(), compressed.end()), output) ||
+        (std::string(output.begin(), output.end()) != expected))
+    {
+        printf("GzipStreamBuf failed\n");
+        failed++;
+    }
+
+    printf("Failed checks: %d\n", failed);
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+/*
+    Checks the incremental LayoutEditor against a full
+    Layout::doLayout run using random edit sequences.
+*/
+
+#include <cstdio>
+#include <cmath>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "../src/layout.h"
+#include "../src/layouteditor.h"
+
+static LayoutItem* createCell(std::mt19937 &rng, uint32_t id)
+{
+    LayoutItem *cell = new LayoutItem(LayoutItem::TYPE_CELL);
+    cell->m_instance = "cell" + std::to_string(id);
+    cell->m_cellname = "PAD";
+    cell->m_size = static_cast<double>(10 + rng() % 90);
+    return cell;
+}
+
+static Layout* createLayout(std::mt19937 &rng, Layout::direction_t dir, uint32_t cells, uint32_t &id)
+{
+    Layout *layout = new Layout(dir);
+    layout->setEdgePos(123.0);
+
+    LayoutItem *corner = new LayoutItem(LayoutItem::TYPE_CORNER);
+    corner->m_size = 250.0;
+    layout->setFirstCorner(corner);
+    corner = new LayoutItem(LayoutItem::TYPE_CORNER);
+    corner->m_size = 250.0;
+    layout->setLastCorner(corner);
+
+    for(uint32_t i=0; i<cells; i++)
+    {
+        if ((rng() % 8) == 0)
+        {
+            LayoutItem *space = new LayoutItem(LayoutItem::TYPE_FIXEDSPACE);
+            space->m_size = static_cast<double>(rng() % 20);
+            layout->addItem(space);
+        }
+        layout->addItem(createCell(rng, id++));
+    }
+
+    layout->setDieSize(500.0 + cells*150.0);
+    layout->doLayout();
+    return layout;
+}
+
+static double getPos(const LayoutItem *item, Layout::direction_t dir)
+{
+    return (dir == Layout::DIR_HORIZONTAL) ? item->m_x : item->m_y;
+}
+
+/** compare the edited layout with a full layout of a copy */
+static bool check(Layout &layout, Layout::direction_t dir)
+{
+    Layout reference(layout);
+    reference.doLayout();
+
+    auto item = layout.begin();
+    auto ref  = reference.begin();
+    while((item != layout.end()) && (ref != reference.end()))
+    {
+        if (((*item)->m_ltype != (*ref)->m_ltype) || 
+            (std::fabs(getPos(*item, dir) - getPos(*ref, dir)) > 1e-9) ||
+            (std::fabs((*item)->m_size - (*ref)->m_size) > 1e-9) ||
+            ((*item)->m_x != (*ref)->m_x && dir == Layout::DIR_VERTICAL) ||
+            ((*item)->m_y != (*ref)->m_y && dir == Layout::DIR_HORIZONTAL))
+        {
+            printf("Item mismatch: %s pos %f size %f, expected pos %f size %f\n",
+                (*item)->m_instance.c_str(),
+                getPos(*item, dir), (*item)->m_size,
+                getPos(*ref, dir), (*ref)->m_size);
+            return false;
+        }
+
+        item++;
+        ref++;
+    }
+
+    if ((item != layout.end()) || (ref != reference.end()))
+    {
+        printf("Item count mismatch\n");
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    std::mt19937 rng(0x5EED);
+    uint32_t id = 0;
+    uint32_t failed = 0;
+
+    for(uint32_t run=0; run<20; run++)
+    {
+        Layout::direction_t dir = (run & 1) ? Layout::DIR_VERTICAL : Layout::DIR_HORIZONTAL;
+        Layout *layout = createLayout(rng, dir, 5 + rng() % 200, id);
+        LayoutEditor *editor = new LayoutEditor(*layout);
+
+        for(uint32_t step=0; step<200; step++)
+        {
+            // remember the position of every cell
+            std::vector<std::pair<LayoutItem*, double> > positions;
+            for(size_t i=0; i<editor->getCellCount(); i++)
+            {
+                LayoutItem *cell = editor->getCell(i);
+                positions.push_back(std::make_pair(cell, getPos(cell, dir)));
+            }
+
+            uint32_t op = rng() % 4;
+            size_t cells = editor->getCellCount();
+            LayoutItem *removed = nullptr;
+            if ((op == 0) || (cells < 2))
+            {
+                editor->insertCell(rng() % (cells + 1), createCell(rng, id++));
+            }
+            else if (op == 1)
+            {
+                removed = editor->removeCell(rng() % cells);
+            }
+            else
+            {
+                editor->swapCells(rng() % cells, rng() % cells);
+            }
+
+            auto moved = editor->update();
+            editor->commit();
+            delete removed;
+
+            // every cell whose position changed must be
+            // reported, and no other cells.
+            std::set<LayoutItem*> movedSet(moved.begin(), moved.end());
+            std::set<LayoutItem*> expectedSet;
+            for(size_t i=0; i<editor->getCellCount(); i++)
+            {
+                LayoutItem *cell = editor->getCell(i);
+                bool found = false;
+                for(auto p : positions)
+                {
+                    if (p.first == cell)
+                    {
+                        found = true;
+                        if (std::fabs(p.second - getPos(cell, dir)) > 1e-9)
+                        {
+                            expectedSet.insert(cell);
+                        }
+                    }
+                }
+                if (!found)
+                {
+                    expectedSet.insert(cell);
+                }
+            }
+
+            if (movedSet != expectedSet)
+            {
+                printf("Run %d step %d: reported %d moved cells, expected %d\n", 
+                    run, step, (int)movedSet.size(), (int)expectedSet.size());
+                failed++;
+            }
+
+            if (!check(*layout, dir))
+            {
+                printf("Run %d step %d: layout differs from full layout\n", run, step);
+                failed++;
+            }
+        }
+
+        delete editor;
+        delete layout;
+    }
+
+    printf("Failed checks: %d\n", failed);
+    return (failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+#!/usr/bin/python3
+
+# Round-trip check for the OASIS writer: reads back an OASIS file
+# and a flat GDS2 file written for the same padring and checks
+# that both contain the same cell placements.
+#
+# usage: oasis_check.py <file.oas> <file.gds>
+
+import struct
+import sys
+
+def readUnsigned(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        b = data[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if (b & 0x80) == 0:
+            return value, pos
+
+def readSigned(data, pos):
+    value, pos = readUnsigned(data, pos)
+    if value & 1:
+        return -(value >> 1), pos
+    return value >> 1, pos
+
+def readString(data, pos):
+    length, pos = readUnsigned(data, pos)
+    return data[pos:pos+length].decode(), pos + length
+
+def readOASIS(filename):
+    data = open(filename, 'rb').read()
+    magic = b'%SEMI-OASIS\r\n'
+    if not data.startswith(magic):
+        raise ValueError("missing OASIS magic")
+    pos = len(magic)
+    if data[pos] != 1:
+        raise ValueError("missing START record")
+    version, pos = readString(data, pos + 1)
+    realType, pos = readUnsigned(data, pos)
+    unit, pos = readUnsigned(data, pos)
+    offsetFlag, pos = readUnsigned(data, pos)
+    if (realType != 0) or (unit != 1000) or (offsetFlag != 0):
+        raise ValueError("unexpected START record")
+    for i in range(12):
+        dummy, pos = readUnsigned(data, pos)
+
+    names = []
+    placements = []
+    cell = None
+    x = y = 0
+    repetition = None
+    while True:
+        record = data[pos]
+        pos += 1
+        if record == 2:                         # END
+            if len(data) - pos != 255:
+                raise ValueError("END record is not 256 bytes")
+            return placements
+        elif record == 3:                       # CELLNAME, implicit reference
+            name, pos = readString(data, pos)
+            names.append(name)
+        elif record == 13:                      # CELL by reference
+            ref, pos = readUnsigned(data, pos)
+            cell = None
+            x = y = 0
+            repetition = None
+        elif record == 16:                      # XYRELATIVE
+            pass
+        elif record == 17:                      # PLACEMENT
+            info = data[pos]
+            pos += 1
+            if info & 0x80:
+                if not (info & 0x40):
+                    raise ValueError("only cell references are supported")
+                ref, pos = readUnsigned(data, pos)
+                cell = names[ref]
+            if info & 0x20:
+                dx, pos = readSigned(data, pos)
+                x += dx
+            if info & 0x10:
+                dy, pos = readSigned(data, pos)
+                y += dy
+            points = [(x, y)]
+            if info & 0x08:
+                repType, pos = readUnsigned(data, pos)
+                if repType != 0:
+                    count, pos = readUnsigned(data, pos)
+                    space, pos = readUnsigned(data, pos)
+                    repetition = (repType, count + 2, space)
+                repType, count, space = repetition
+                if repType == 2:
+                    points = [(x + k*space, y) for k in range(count)]
+                elif repType == 3:
+                    points = [(x, y + k*space) for k in range(count)]
+                else:
+                    raise ValueError("unsupported repetition type %d" % repType)
+            rot = ((info >> 1) & 3) * 90
+            flip = bool(info & 0x01)
+            for (px, py) in points:
+                placements.append((cell, rot, flip, px, py))
+        else:
+            raise ValueError("unsupported record %d" % record)
+
+def readGDS2(filename):
+    data = open(filename, 'rb').read()
+    pos = 0
+    placements = []
+    element = None
+    while pos < len(data):
+        length, rectype = struct.unpack('>HH', data[pos:pos+4])
+        body = data[pos+4:pos+length]
+        pos += length
+        if rectype in (0x0A00, 0x0B00):         # SREF / AREF
+            element = {'rot': 0, 'flip': False, 'cols': 1}
+        elif rectype == 0x1206:                 # SNAME
+            element['name'] = body.rstrip(b'\0').decode()
+        elif rectype == 0x1A01:                 # STRANS
+            element['flip'] = bool(body[0] & 0x80)
+        elif rectype == 0x1C05:                 # ANGLE
+            exponent = body[0] - 64
+            mantissa = int.from_bytes(body[1:], 'big')
+            element['rot'] = round(mantissa / (2**56) * 16**exponent) % 360
+        elif rectype == 0x1302:                 # COLROW
+            element['cols'] = struct.unpack('>hh', body)[0]
+        elif rectype == 0x1003:                 # XY
+            element['xy'] = struct.unpack('>%di' % (len(body)//4), body)
+        elif rectype == 0x1100:                 # ENDEL
+            if element is not None:
+                xy = element['xy']
+                cols = element['cols']
+                for k in range(cols):
+                    px = xy[0] + (xy[2] - xy[0]) * k // cols if cols > 1 else xy[0]
+                    py = xy[1] + (xy[3] - xy[1]) * k // cols if cols > 1 else xy[1]
+                    placements.append((element['name'], element['rot'], element['flip'], px, py))
+            element = None
+    return placements
+
+oasis = sorted(readOASIS(sys.argv[1]))
+gds2 = sorted(readGDS2(sys.argv[2]))
+if oasis != gds2:
+    print("OASIS and GDS2 placements differ (%d vs %d)" % (len(oasis), len(gds2)))
+    sys.exit(1)
+
+sys.exit(0)
@@ -0,0 +1,95 @@
+#!/usr/bin/python3
+
+# Small client for the padring server (padring --serve). Sends a
+# configuration file with output options, writes the files that
+# come back and prints the log and the request latency.
+#
+# usage: padring_client.py --socket <path> [--dir <dir>] [--repeat <n>]
+#                          <file.config> [options]
+#        padring_client.py --socket <path> --shutdown
+#
+# The options are those of a batch manifest line, e.g.
+# --def chip.def --svg chip.svg --fit
+
+import socket
+import sys
+import time
+
+class Client:
+    def __init__(self, reader, writer):
+        self.reader = reader
+        self.writer = writer
+
+    @staticmethod
+    def connect(path):
+        sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+        sock.connect(path)
+        return Client(sock.makefile("rb"), sock.makefile("wb"))
+
+    def readResult(self):
+        header = self.reader.readline().split()
+        if len(header) != 4 or header[0] != b"RESULT":
+            raise IOError("malformed answer: %r" % header)
+        status = header[1].decode()
+        log = self.reader.read(int(header[3])).decode()
+        files = {}
+        for i in range(int(header[2])):
+            name, length = self.reader.readline().split()[1:3]
+            files[name.decode()] = self.reader.read(int(length))
+        return status, log, files
+
+    def request(self, line, data=b""):
+        self.writer.write(line.encode() + b"\n" + data)
+        self.writer.flush()
+        return self.readResult()
+
+    def layout(self, config, options):
+        return self.request("LAYOUT %d %s" % (len(config), " ".join(options)), config)
+
+    def ping(self):
+        return self.request("PING")[0] == "ok"
+
+    def shutdown(self):
+        return self.request("SHUTDOWN")[0] == "ok"
+
+if __name__ == "__main__":
+    args = sys.argv[1:]
+    socketName = None
+    directory = "."
+    repeat = 1
+    shutdown = False
+    while args and args[0] in ("--socket", "--dir", "--repeat", "--shutdown"):
+        option = args.pop(0)
+        if option == "--shutdown":
+            shutdown = True
+        elif option == "--socket":
+            socketName = args.pop(0)
+        elif option == "--dir":
+            directory = args.pop(0)
+        else:
+            repeat = int(args.pop(0))
+
+    if socketName is None or (not shutdown and not args):
+        print("usage: padring_client.py --socket <path> [--dir <dir>] [--repeat <n>] <file.config> [options]")
+        sys.exit(1)
+
+    client = Client.connect(socketName)
+    if shutdown:
+        sys.exit(0 if client.shutdown() else 1)
+
+    config = open(args[0], "rb").read()
+    latencies = []
+    for i in range(repeat):
+        start = time.perf_counter()
+        status, log, files = client.layout(config, args[1:])
+        latencies.append((time.perf_counter() - start) * 1000.0)
+
+    sys.stderr.write(log)
+    for name, data in files.items():
+        with open(directory + "/" + name, "wb") as f:
+            f.write(data)
+
+    latencies.sort()
+    print("%s: %d files, latency min %.2f ms, median %.2f ms" %
+        (status, len(files), latencies[0], latencies[len(latencies)//2]))
+    sys.exit(0 if status == "ok" else 1)
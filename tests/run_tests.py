@@ -2,14 +2,38 @@
 
 import os
 import subprocess
+import gzip
+import base64
+import re
+import struct
+import zlib
+import json
+import csv
+import filecmp
+import time
+import signal
+import shutil
+import hashlib
+from padring_client import Client
+import xml.etree.ElementTree
 
-# define all tests, the LEF library used and expected return value (1 = fail)
+# define all tests, the LEF library used, expected return value (1 = fail)
+# and optional extra command line arguments
 tests = [["noarea.config", "iocells.lef", 1],
          ["syntax.config", "iocells.lef", 1],
          ["threecorners.config", "iocells.lef", 0],
          ["fillerexit.config", "iocells_nofiller1.lef", 1],
          ["nonsquarecorners.config", "nonsquarecorners.lef", 0],
-         ["dummy.config", "foreign.lef", 0]
+         ["dummy.config", "foreign.lef", 0],
+         ["fit.config", "iocells.lef", 0, ["--fit"]],
+         ["fit.config", "iocells_nofiller1.lef", 1, ["--fit"]],
+         ["fit.config", "iocells.lef", 1, ["--sweep", "fit.sweep", "--sweep-out", "sweep.csv"]],
+         ["fit.config", "iocells.lef", 0, ["--sweep", "fit_ok.sweep", "--sweep-out", "sweep.csv"]],
+         ["optimize.config", "iocells.lef", 0, ["--optimize", "padring_opt.config", "--opt-moves", "100000"]],
+         ["hierarchy.config", "iocells.lef", 0, ["--gds-hierarchy"]],
+         ["hierarchy.config", "iocells.lef", 0, ["--verify"]],
+         ["hierarchy.config", "iocells.lef", 0, ["--gds-hierarchy", "--verify"]],
+         ["threecorners.config", "iocells.lef", 0, ["--no-aref", "--verify"]]
 ]
 
 
@@ -17,7 +41,8 @@ FNULL = open(os.devnull, 'w')
 
 failed = 0
 for test in tests:
-    retval = subprocess.call(["../build/padring", "--svg", "padring.svg", "--def", "padring.def", "--lef", test[1], "-o","padring.gds", test[0]], stdout=FNULL)
+    extra = test[3] if len(test) > 3 else []
+    retval = subprocess.call(["../build/padring", "--svg", "padring.svg", "--def", "padring.def", "--lef", test[1], "-o","padring.gds"] + extra + [test[0]], stdout=FNULL)
     if (retval == test[2]):
         spaces = 30 - len(test[0])
         print(test[0] + (' '*spaces) + "OK!")
@@ -25,5 +50,320 @@ for test in tests:
         failed = failed + 1
         print(test[0] + (' '*spaces) + "*** FAIL ***")
 
+# write the same padring as GDS2 and OASIS and check
+# that both files contain the same placements
+test = "oasis_check.py"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "-o", "padring.gds", "--oasis", "padring.oas", "hierarchy.config"], stdout=FNULL)
+if (retval == 0):
+    retval = subprocess.call(["python3", test, "padring.oas", "padring.gds"])
+if (retval == 0):
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# stream the DEF file to stdout and check that it
+# is the same as the DEF file written to disk
+test = "def_stdout"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--def", "padring.def", "hierarchy.config"], stdout=FNULL)
+piped = subprocess.run(["../build/padring", "--lef", "iocells.lef", "--def", "-", "hierarchy.config"], stdout=subprocess.PIPE, stderr=FNULL)
+if (retval == 0) and (piped.returncode == 0) and (piped.stdout == open("padring.def", "rb").read()):
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+test = "gzip_outputs"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "-o", "padring.gds", "--def", "padring.def", "--svg", "padring.svg", "hierarchy.config"], stdout=FNULL)
+retgz = subprocess.call(["../build/padring", "--lef", "iocells.lef", "-o", "padring.gds.gz", "--def", "padring.def.gz", "--svg", "padring.svg.gz", "hierarchy.config"], stdout=FNULL)
+same = (retval == 0) and (retgz == 0)
+for name in ["padring.gds", "padring.def", "padring.svg"]:
+    if same and (gzip.decompress(open(name + ".gz", "rb").read()) != open(name, "rb").read()):
+        same = False
+if same:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# the SVG file must be valid XML, with one symbol per cell master
+test = "svg_symbols"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--svg", "padring.svg", "hierarchy.config"], stdout=FNULL)
+ok = False
+if retval == 0:
+    svg = xml.etree.ElementTree.parse("padring.svg").getroot()
+    symbols = [e.get("id") for e in svg.iter("{http://www.w3.org/2000/svg}symbol")]
+    uses = list(svg.iter("{http://www.w3.org/2000/svg}use"))
+    ok = (len(symbols) > 0) and (len(symbols) == len(set(symbols))) and (len(uses) >= len(symbols))
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# the HTML viewer must hold every DEF component,
+# and every item must be in the grid index
+test = "html_viewer"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--def", "padring.def", "--html", "padring.html", "hierarchy.config"], stdout=FNULL)
+ok = False
+if retval == 0:
+    html = open("padring.html").read()
+    def blob(name):
+        return base64.b64decode(re.search(name + r': "([^"]*)"', html).group(1))
+    components = int(re.search(r"COMPONENTS (\d+) ;", open("padring.def").read()).group(1))
+    items = set(int.from_bytes(blob("index")[i:i+4], "little") for i in range(0, len(blob("index")), 4))
+    ok = (len(blob("rects")) == components * 16) and (len(blob("kinds")) == components) and (items == set(range(components)))
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# the PNG thumbnail must be a valid image with
+# fillers, pads and corners in it
+test = "png_thumbnail"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--png", "padring.png", "--png-size", "512", "hierarchy.config"], stdout=FNULL)
+ok = False
+if retval == 0:
+    data = open("padring.png", "rb").read()
+    chunks = {}
+    pos = 8
+    while pos < len(data):
+        length, = struct.unpack(">I", data[pos:pos+4])
+        body = data[pos+4:pos+8+length]
+        crc, = struct.unpack(">I", data[pos+8+length:pos+12+length])
+        chunks[body[:4]] = body[4:] if zlib.crc32(body) == crc else None
+        pos += 12 + length
+    width, height = struct.unpack(">II", chunks[b"IHDR"][:8])
+    pixels = zlib.decompress(chunks[b"IDAT"])
+    ok = data.startswith(b"\x89PNG\r\n\x1a\n") and (max(width, height) == 512) and \
+        (len(pixels) == (width + 1) * height) and (set(pixels) >= {0, 2, 3, 4})
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# the placement report must agree with the DEF file
+test = "placement_report"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--def", "padring.def", "--report", "padring_report.json", "hierarchy.config"], stdout=FNULL)
+retcsv = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--report", "padring_report.csv", "hierarchy.config"], stdout=FNULL)
+ok = False
+if (retval == 0) and (retcsv == 0):
+    report = json.load(open("padring_report.json"))
+    placed = {}
+    fillers = 0
+    name = None
+    for line in open("padring.def"):
+        fields = line.split()
+        if line.startswith("  - "):
+            name = fields[1]
+            fillers += name.startswith("FILLER_")
+        elif "PLACED" in fields:
+            placed[name] = (int(fields[3]), int(fields[4]), fields[6])
+    ok = all(placed.get(c["instance"]) == (c["x"], c["y"], c["orientation"]) for c in report["cells"])
+    ok = ok and (sum(e["fillers"] for e in report["edges"].values()) == fillers)
+    ok = ok and (len(placed) == len(report["cells"]) + fillers)
+    rows = list(csv.DictReader(line for line in open("padring_report.csv") if not line.startswith("#")))
+    ok = ok and ([r["instance"] for r in rows] == [c["instance"] for c in report["cells"]])
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# a batch must give the same files as separate runs
+# and report the jobs that failed
+test = "batch_manifest"
+spaces = 30 - len(test)
+with open("padring_batch.txt", "w") as manifest:
+    manifest.write("# name config options\n")
+    manifest.write("hier hierarchy.config --def padring_batch_hier.def -o padring_batch_hier.gds\n")
+    manifest.write("fit  fit.config --fit --def padring_batch_fit.def\n")
+    manifest.write("bad  noarea.config --def padring_batch_bad.def\n")
+batch = subprocess.run(["../build/padring", "--lef", "iocells.lef", "--batch", "padring_batch.txt", "--threads", "2"], stdout=subprocess.PIPE, stderr=subprocess.PIPE, universal_newlines=True)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--def", "padring.def", "-o", "padring.gds", "hierarchy.config"], stdout=FNULL)
+retfit = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--fit", "--def", "padring_fit.def", "fit.config"], stdout=FNULL)
+ok = (batch.returncode == 1) and (retval == 0) and (retfit == 0)
+ok = ok and filecmp.cmp("padring.def", "padring_batch_hier.def", shallow=False)
+ok = ok and filecmp.cmp("padring.gds", "padring_batch_hier.gds", shallow=False)
+ok = ok and filecmp.cmp("padring_fit.def", "padring_batch_fit.def", shallow=False)
+status = dict(line.split()[1:3] for line in batch.stdout.splitlines() if line.split()[1:2] in (["hier"], ["fit"], ["bad"]))
+ok = ok and (status == {"hier": "ok", "fit": "ok", "bad": "no_area"}) and ("bad: Die area" in batch.stderr)
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# a resident server must answer with the same files
+# as a normal run, on a socket and on stdin/stdout
+test = "server"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--def", "padring.def", "-o", "padring.gds", "hierarchy.config"], stdout=FNULL)
+config = open("hierarchy.config", "rb").read()
+server = subprocess.Popen(["../build/padring", "--lef", "iocells.lef", "--serve", "padring.sock"], stdout=FNULL)
+client = None
+for i in range(100):
+    try:
+        client = Client.connect("padring.sock")
+        break
+    except OSError:
+        time.sleep(0.05)
+ok = (retval == 0) and (client is not None)
+if ok:
+    status, log, files = client.layout(config, ["--def", "served.def", "-o", "served.gds"])
+    ok = (status == "ok") and (files["served.def"] == open("padring.def", "rb").read())
+    ok = ok and (files["served.gds"] == open("padring.gds", "rb").read())
+    status, log, files = client.layout(config, ["--def", "../served.def"])
+    ok = ok and (status == "option_error") and (files == {})
+    ok = ok and Client.connect("padring.sock").shutdown()
+ok = (server.wait(timeout=10) == 0) and ok and not os.path.exists("padring.sock")
+piped = subprocess.Popen(["../build/padring", "--lef", "iocells.lef", "--serve", "-"], stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=FNULL)
+client = Client(piped.stdout, piped.stdin)
+status, log, files = client.layout(config, ["--def", "served.def"])
+ok = ok and client.ping() and (status == "ok") and (files["served.def"] == open("padring.def", "rb").read())
+piped.stdin.close()
+ok = ok and (piped.wait(timeout=10) == 0)
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# the watcher must update the outputs after a change
+# of the configuration, laying out only the changed edge
+test = "watch"
+spaces = 30 - len(test)
+def waitForOutputs(names):
+    for i in range(200):
+        if all(os.path.exists(watched) and filecmp.cmp(watched, ref, shallow=False) for watched, ref in names):
+            return True
+        time.sleep(0.05)
+    return False
+config = open("hierarchy.config").read()
+open("padring_watch.config", "w").write(config)
+for name in ("padring_watch.def", "padring_watch.gds"):
+    if os.path.exists(name):
+        os.remove(name)
+watcher = subprocess.Popen(["../build/padring", "--lef", "iocells.lef", "--watch", "--def", "padring_watch.def", "-o", "padring_watch.gds", "padring_watch.config"], stdout=subprocess.PIPE, universal_newlines=True)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--def", "padring.def", "-o", "padring.gds", "hierarchy.config"], stdout=FNULL)
+ok = (retval == 0) and waitForOutputs([("padring_watch.def", "padring.def"), ("padring_watch.gds", "padring.gds")])
+open("padring_watch.config", "w").write(config.replace("PAD S2 S PWRPAD", "PAD S2 S FLIP PWRPAD"))
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--def", "padring.def", "-o", "padring.gds", "padring_watch.config"], stdout=FNULL)
+ok = ok and (retval == 0) and waitForOutputs([("padring_watch.def", "padring.def"), ("padring_watch.gds", "padring.gds")])
+watcher.send_signal(signal.SIGINT)
+log = watcher.communicate(timeout=10)[0]
+ok = ok and (watcher.returncode == 0) and ("Laid out 1 of 4 edges, reused the placements of 3 edges" in log)
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# the second run with the same inputs must restore the
+# outputs from the cache, and the manifest must hold their digests
+test = "output_cache"
+spaces = 30 - len(test)
+if os.path.exists("padring_cache"):
+    shutil.rmtree("padring_cache")
+args = ["../build/padring", "--lef", "iocells.lef", "--cache", "padring_cache", "--def", "padring_cached.def", "-o", "padring_cached.gds", "hierarchy.config"]
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--def", "padring.def", "-o", "padring.gds", "hierarchy.config"], stdout=FNULL)
+ok = (retval == 0)
+logs = []
+for i in range(2):
+    run = subprocess.run(args, stdout=subprocess.PIPE, universal_newlines=True)
+    logs.append(run.stdout)
+    ok = ok and (run.returncode == 0) and filecmp.cmp("padring_cached.def", "padring.def", shallow=False)
+    ok = ok and filecmp.cmp("padring_cached.gds", "padring.gds", shallow=False)
+ok = ok and ("Output cache miss" in logs[0]) and ("Output cache hit" in logs[1])
+entries = os.listdir("padring_cache")
+ok = ok and (len(entries) == 1)
+if ok:
+    for line in open("padring_cache/" + entries[0] + "/outputs"):
+        kind, digest, size = line.split()
+        data = open({"def": "padring.def", "gds2": "padring.gds"}[kind], "rb").read()
+        ok = ok and (hashlib.sha256(data).hexdigest() == digest) and (len(data) == int(size))
+retval = subprocess.call(args + ["--fit"], stdout=FNULL)
+ok = ok and (retval == 0) and (len(os.listdir("padring_cache")) == 2)
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# outputs written from a snapshot must be equal to
+# the outputs of the run that saved it
+test = "snapshot"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--save-snapshot", "padring.snap", "--def", "padring.def", "-o", "padring.gds", "hierarchy.config"], stdout=FNULL)
+ok = (retval == 0)
+retval = subprocess.call(["../build/padring", "--load-snapshot", "padring.snap", "--def", "padring_snap.def", "-o", "padring_snap.gds"], stdout=FNULL)
+ok = ok and (retval == 0) and filecmp.cmp("padring_snap.def", "padring.def", shallow=False)
+ok = ok and filecmp.cmp("padring_snap.gds", "padring.gds", shallow=False)
+data = open("padring.snap", "rb").read()
+open("padring_truncated.snap", "wb").write(data[:len(data)//2])
+retval = subprocess.call(["../build/padring", "--load-snapshot", "padring_truncated.snap", "--def", "padring_snap.def"], stdout=FNULL, stderr=FNULL)
+ok = ok and (retval == 1)
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# the diff with an edited configuration must list the
+# changed pads, and no changes for the same layout
+test = "diff"
+spaces = 30 - len(test)
+config = open("hierarchy.config").read()
+open("padring_diff.config", "w").write(config.replace("PAD S2 S PWRPAD", "PAD S2 S FLIP PWRPAD"))
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--save-snapshot", "padring.snap", "hierarchy.config"], stdout=FNULL)
+ok = (retval == 0)
+retval = subprocess.call(["../build/padring", "--lef", "iocells.lef", "--diff", "padring.snap", "--diff-out", "padring_diff.json", "--diff-def", "padring_diff.def", "padring_diff.config"], stdout=FNULL)
+ok = ok and (retval == 0)
+if ok:
+    diff = json.load(open("padring_diff.json"))
+    ok = (diff["summary"] == {"added": 0, "removed": 0, "moved": 1, "gaps": 0})
+    ok = ok and (diff["components"][0]["instance"] == "S2") and (diff["components"][0]["new"]["orientation"] == "FN")
+    ok = ok and ("COMPONENTS 1 ;" in open("padring_diff.def").read())
+run = subprocess.run(["../build/padring", "-q", "--lef", "iocells.lef", "--diff", "hierarchy.config", "hierarchy.config"], stdout=subprocess.PIPE, universal_newlines=True)
+rows = list(csv.reader(line for line in run.stdout.splitlines() if not line.startswith("#")))
+ok = ok and (run.returncode == 0) and (len(rows) == 1)
+if ok:
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# the filler widths only fit on sparse die widths,
+# the smallest one is 498 microns.
+test = "fitsparse.config"
+spaces = 30 - len(test)
+retval = subprocess.call(["../build/padring", "--lef", "iocells_filler10.lef", "--fit", "--def", "padring.def", test], stdout=FNULL, stderr=FNULL)
+if (retval == 0) and ("CORNER_1 CORNER\n    + PLACED ( 348000 " in open("padring.def").read()):
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
+# a padring that cannot be filled must not
+# leave incomplete output files behind
+test = "incomplete_outputs"
+spaces = 30 - len(test)
+outputs = ["padring_fail.gds", "padring_fail.def", "padring_fail.svg.gz"]
+retval = subprocess.call(["../build/padring", "--lef", "iocells_nofiller1.lef", "-o", outputs[0], "--def", outputs[1], "--svg", outputs[2], "fillerexit.config"], stdout=FNULL, stderr=FNULL)
+if (retval == 1) and not any(os.path.exists(name) for name in outputs):
+    print(test + (' '*spaces) + "OK!")
+else:
+    failed = failed + 1
+    print(test + (' '*spaces) + "*** FAIL ***")
+
 print("\nFailed tests: " + str(failed))
 
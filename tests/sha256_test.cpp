@@ -0,0 +1,74 @@
+/*
+    PADRING -- a padring generator for ASICs.
+
+    Copyright (c) 2019, Niels Moseley <niels@symbioticeda.com>
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose with or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+    MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+*/
+
+/*
+    Checks SHA256 against the FIPS 180-4 example
+    digests, also when the data is added in pieces.
+*/
+
+#include <stdio.h>
+#include <string>
+
+#include "../src/sha256.h"
+
+int main()
+{
+    uint32_t failed = 0;
+
+    struct Vector
+    {
+        std::string m_message;
+        const char *m_digest;
+    };
+
+    const Vector vectors[] = 
+    {
+        {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 
+            "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+        {std::string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"}
+    };
+
+    for(auto const &vector : vectors)
+    {
+        SHA256 whole;
+        whole.update(vector.m_message);
+        if (whole.hexDigest() != vector.m_digest)
+        {
+            printf("SHA256: digest of %zu bytes is wrong\n", vector.m_message.size());
+            failed++;
+        }
+
+        // pieces that do not line up with the blocks
+        SHA256 pieces;
+        for(size_t pos=0; pos<vector.m_message.size(); pos+=37)
+        {
+            pieces.update(vector.m_message.substr(pos, 37));
+        }
+        if (pieces.hexDigest() != vector.m_digest)
+        {
+            printf("SHA256: digest of %zu bytes in pieces is wrong\n", vector.m_message.size());
+            failed++;
+        }
+    }
+
+    printf("Failed checks: %d\n", failed);
+    return (failed == 0) ? 0 : 1;
+}